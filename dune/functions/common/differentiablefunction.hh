@@ -4,6 +4,7 @@
 #define DUNE_FUNCTIONS_COMMON_DIFFERENTIABLE_FUNCTION_HH
 
 #include <type_traits>
+#include <vector>
 
 #include <dune/common/typeutilities.hh>
 
@@ -81,11 +82,12 @@ template<class Range, class Domain, template<class> class DerivativeTraits, size
 class DifferentiableFunction< Range(Domain), DerivativeTraits, bufferSize> :
   public TypeErasureBase<
     typename Imp::DifferentiableFunctionTraits<Range(Domain), DerivativeTraits, bufferSize>::Concept,
-    Imp::DifferentiableFunctionTraits<Range(Domain), DerivativeTraits, bufferSize>::template Model>
+    Imp::DifferentiableFunctionTraits<Range(Domain), DerivativeTraits, bufferSize>::template Model,
+    bufferSize>
 {
   using Traits = Imp::DifferentiableFunctionTraits<Range(Domain), DerivativeTraits, bufferSize>;
 
-  using Base = TypeErasureBase<typename Traits::Concept, Traits::template Model>;
+  using Base = TypeErasureBase<typename Traits::Concept, Traits::template Model, bufferSize>;
 
   using DerivativeInterface = typename Traits::DerivativeInterface;
 
@@ -120,6 +122,18 @@ public:
     return this->asInterface().operator()(x);
   }
 
+  /**
+   * \brief Evaluation of wrapped function in several points
+   *
+   * The values in the points `x[k]` are stored in `y[k]`.
+   * In contrast to the evaluation in single points this
+   * only needs a single virtual function call.
+   */
+  void evaluate(const std::vector<std::decay_t<Domain>>& x, std::vector<std::decay_t<Range>>& y) const
+  {
+    this->asInterface().evaluate(x, y);
+  }
+
   /**
    * \brief Get derivative of wrapped function
    *
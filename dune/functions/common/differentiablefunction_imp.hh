@@ -3,6 +3,10 @@
 #ifndef DUNE_FUNCTIONS_COMMON_DIFFERENTIABLE_FUNCTION_IMP_HH
 #define DUNE_FUNCTIONS_COMMON_DIFFERENTIABLE_FUNCTION_IMP_HH
 
+#include <cstddef>
+#include <utility>
+#include <vector>
+
 #include <dune/common/exceptions.hh>
 #include <dune/common/concept.hh>
 
@@ -26,6 +30,20 @@ struct HasFreeDerivative
 
 
 
+/**
+ * A concept describing types that have a batched evaluate(x, y) method
+ */
+template<class Range, class Domain>
+struct HasBatchedEvaluate
+{
+  template<class F>
+  auto require(F&& f) -> decltype(
+    f.evaluate(std::declval<const std::vector<std::decay_t<Domain>>&>(), std::declval<std::vector<std::decay_t<Range>>&>())
+  );
+};
+
+
+
 template<class Dummy, class F,
   std::enable_if_t<
     models< HasFreeDerivative, F>() , int> = 0>
@@ -60,6 +78,8 @@ class DifferentiableFunctionWrapperInterface<Range(Domain), DerivativeInterface>
 public:
   virtual Range operator() (const Domain& x) const = 0;
 
+  virtual void evaluate(const std::vector<std::decay_t<Domain>>& x, std::vector<std::decay_t<Range>>& y) const = 0;
+
   virtual DerivativeInterface derivative() const = 0;
 };
 
@@ -84,6 +104,21 @@ public:
     return this->get()(x);
   }
 
+  // Forward to the batched evaluation of the wrapped function
+  // if it provides one and loop over the points otherwise.
+  virtual void evaluate(const std::vector<std::decay_t<Domain>>& x, std::vector<std::decay_t<Range>>& y) const
+  {
+    if constexpr (models<HasBatchedEvaluate<Range, Domain>, const Wrapped&>())
+      this->get().evaluate(x, y);
+    else
+    {
+      y.clear();
+      y.reserve(x.size());
+      for (std::size_t k = 0; k < x.size(); ++k)
+        y.push_back(this->get()(x[k]));
+    }
+  }
+
   virtual DerivativeInterface derivative() const
   {
     return derivativeIfImplemented<DerivativeInterface, Wrapped>(this->get());
@@ -4,6 +4,7 @@
 #define DUNE_FUNCTIONS_COMMON_LOCAL_FUNCTION_HH
 
 #include <type_traits>
+#include <vector>
 
 #include <dune/common/typeutilities.hh>
 
@@ -87,11 +88,12 @@ template<class Range, class Domain, class LocalContext, template<class> class De
 class LocalFunction< Range(Domain), LocalContext, DerivativeTraits, bufferSize> :
   public TypeErasureBase<
     typename Imp::LocalFunctionTraits<Range(Domain), LocalContext, DerivativeTraits, bufferSize>::Concept,
-    Imp::LocalFunctionTraits<Range(Domain), LocalContext, DerivativeTraits, bufferSize>::template Model>
+    Imp::LocalFunctionTraits<Range(Domain), LocalContext, DerivativeTraits, bufferSize>::template Model,
+    bufferSize>
 {
   using Traits = Imp::LocalFunctionTraits<Range(Domain), LocalContext, DerivativeTraits, bufferSize>;
 
-  using Base = TypeErasureBase<typename Traits::Concept, Traits::template Model>;
+  using Base = TypeErasureBase<typename Traits::Concept, Traits::template Model, bufferSize>;
 
   using DerivativeInterface = typename Traits::DerivativeInterface;
 
@@ -125,6 +127,18 @@ public:
     return this->asInterface().operator()(x);
   }
 
+  /**
+   * \brief Evaluation of wrapped function in several points
+   *
+   * The values in the local coordinates `x[k]` are stored in `y[k]`.
+   * In contrast to the evaluation in single points this
+   * only needs a single virtual function call.
+   */
+  void evaluate(const std::vector<std::decay_t<Domain>>& x, std::vector<std::decay_t<Range>>& y) const
+  {
+    this->asInterface().evaluate(x, y);
+  }
+
   /**
    * \brief Get derivative of wrapped function
    *
@@ -0,0 +1,76 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_COMMON_PARALLELFOR_HH
+#define DUNE_FUNCTIONS_COMMON_PARALLELFOR_HH
+
+#include <algorithm>
+#include <cstddef>
+#include <exception>
+#include <thread>
+#include <vector>
+
+namespace Dune {
+namespace Functions {
+
+
+
+namespace Impl {
+
+  // The number of ranges, and hence of threads, used by parallelForRanges
+  inline std::size_t parallelRangeCount(std::size_t size, std::size_t threads)
+  {
+    return std::max<std::size_t>(1, std::min(threads, size));
+  }
+
+  // Split [0,size) into parallelRangeCount(size,threads) contiguous ranges and
+  // call f(thread,begin,end) for the range with index thread in its own thread.
+  // Exceptions cannot leave a std::thread, hence we store them and rethrow the
+  // first one after joining.
+  template<class F>
+  void parallelForThreadRanges(std::size_t size, std::size_t threads, F&& f)
+  {
+    threads = parallelRangeCount(size, threads);
+    if (threads == 1)
+    {
+      f(std::size_t(0), std::size_t(0), size);
+      return;
+    }
+    std::vector<std::thread> workers;
+    std::vector<std::exception_ptr> errors(threads);
+    workers.reserve(threads);
+    for (std::size_t t = 0; t < threads; ++t)
+    {
+      std::size_t begin = (t*size)/threads;
+      std::size_t end = ((t+1)*size)/threads;
+      workers.emplace_back([&, t, begin, end]() {
+        try {
+          f(t, begin, end);
+        } catch (...) {
+          errors[t] = std::current_exception();
+        }
+      });
+    }
+    for (auto& worker : workers)
+      worker.join();
+    for (auto& error : errors)
+      if (error)
+        std::rethrow_exception(error);
+  }
+
+  // Split [0,size) into contiguous ranges and call f(begin,end) for each of them in its own thread
+  template<class F>
+  void parallelForRanges(std::size_t size, std::size_t threads, F&& f)
+  {
+    parallelForThreadRanges(size, threads, [&](std::size_t, std::size_t begin, std::size_t end) {
+      f(begin, end);
+    });
+  }
+
+} // end namespace Impl
+
+
+
+} // end namespace Functions
+} // end namespace Dune
+
+#endif // DUNE_FUNCTIONS_COMMON_PARALLELFOR_HH
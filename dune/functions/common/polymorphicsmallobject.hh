@@ -3,7 +3,12 @@
 #ifndef DUNE_FUNCTIONS_COMMON_POLYMORPHICSMALLOBJECT_HH
 #define DUNE_FUNCTIONS_COMMON_POLYMORPHICSMALLOBJECT_HH
 
+#include <atomic>
 #include <cstddef>
+#include <map>
+#include <mutex>
+#include <typeindex>
+#include <typeinfo>
 #include <utility>
 #include <type_traits>
 #include <algorithm>
@@ -12,6 +17,85 @@ namespace Dune {
 namespace Functions {
 
 
+
+/**
+ * \brief Statistics on heap allocations of PolymorphicSmallObject
+ *
+ * \ingroup Utility
+ * \ingroup TypeErasure
+ *
+ * If a PolymorphicSmallObject stores an object that does not fit into
+ * its buffer, the object is allocated dynamically. This happens
+ * silently, e.g., for type-erased functions wrapping large objects.
+ * To find such objects, counting these heap allocations per dynamic
+ * type of the stored objects can be enabled at run-time using
+ * `PolymorphicSmallObjectStatistics::enable()`. Counting is
+ * thread-safe and disabled by default.
+ */
+class PolymorphicSmallObjectStatistics
+{
+public:
+
+  //! Map from the dynamic type of the stored objects to the number of heap allocations
+  using Counters = std::map<std::type_index, std::size_t>;
+
+  //! Enable or disable counting of heap allocations
+  static void enable(bool value = true)
+  {
+    enabledFlag() = value;
+  }
+
+  //! Check if counting of heap allocations is enabled
+  static bool enabled()
+  {
+    return enabledFlag();
+  }
+
+  //! Return the number of heap allocations for each stored type
+  static Counters heapAllocations()
+  {
+    std::lock_guard<std::mutex> lock(mutex());
+    return counters();
+  }
+
+  //! Reset all counters
+  static void reset()
+  {
+    std::lock_guard<std::mutex> lock(mutex());
+    counters().clear();
+  }
+
+  //! Count a heap allocation of an object of the given dynamic type
+  static void countHeapAllocation(const std::type_info& type)
+  {
+    if (not enabled())
+      return;
+    std::lock_guard<std::mutex> lock(mutex());
+    ++counters()[std::type_index(type)];
+  }
+
+private:
+
+  static std::atomic<bool>& enabledFlag()
+  {
+    static std::atomic<bool> flag(false);
+    return flag;
+  }
+
+  static std::mutex& mutex()
+  {
+    static std::mutex m;
+    return m;
+  }
+
+  static Counters& counters()
+  {
+    static Counters c;
+    return c;
+  }
+};
+
+
 /**
  * \brief A wrapper providing small object optimization with polymorphic types
  *
@@ -27,6 +111,9 @@ namespace Functions {
  *
  * If the size of the derived type fits into the static buffer, then the
  * wrapped object is stored there, otherwise it is allocated dynamically.
+ * This can be checked at compile time using `fitsIntoBuffer<Derived>()`.
+ * The dynamic allocations can be counted at run-time using
+ * `PolymorphicSmallObjectStatistics`.
  *
  * Notice that this class does implement use type erasure for destructors,
  * copy/move constructors and copy/move assignment. Hence it requires
@@ -54,6 +141,13 @@ class PolymorphicSmallObject
 
 public:
 
+  //! Check if an object of type `Derived` is stored in the internal stack buffer
+  template<class Derived>
+  static constexpr bool fitsIntoBuffer()
+  {
+    return (sizeof(Derived) <= bufferSize) && (bufferAlignment % alignof(Derived) == 0);
+  }
+
   //! Default constructor
   PolymorphicSmallObject() :
     p_(nullptr)
@@ -70,12 +164,10 @@ public:
           std::remove_reference_t<Derived>>>, int> = 0>
   PolymorphicSmallObject(Derived&& derived)
   {
-    constexpr bool useBuffer = (sizeof(Derived) <= bufferSize)
-        && (bufferAlignment % alignof(Derived) == 0);
-
-    if constexpr (useBuffer) {
+    if constexpr (fitsIntoBuffer<Derived>()) {
       p_ = new (&buffer_) Derived(std::forward<Derived>(derived));
     } else {
+      PolymorphicSmallObjectStatistics::countHeapAllocation(typeid(Derived));
       p_ = new Derived(std::forward<Derived>(derived));
     }
   }
@@ -178,7 +270,10 @@ private:
     if (other.bufferUsed())
       p_ = other.p_->clone(&buffer_);
     else
+    {
+      PolymorphicSmallObjectStatistics::countHeapAllocation(typeid(*other.p_));
       p_ = other.p_->clone();
+    }
   }
 
   alignas(bufferAlignment) std::byte buffer_[actualBufferSize];
@@ -5,6 +5,8 @@
 #include <iostream>
 #include <memory>
 #include <functional>
+#include <algorithm>
+#include <vector>
 
 #include <dune/common/exceptions.hh>
 #include <dune/common/parallel/mpihelper.hh>
@@ -96,6 +98,14 @@ struct DifferentiableFunctionImplementableTest
       passed = checkTrue(isFunction(dddfiii, SignatureTag<double(double)>()), "Wrapped function dddfiii does not satisfy Function concept");
       std::cout << "Third derivative at x=5: " << dddfiii(5) << std::endl;
 
+      // Test whether I can evaluate the wrapped function in several points at once
+      std::vector<double> xs = {1, 2, 5};
+      std::vector<double> ys;
+      fiii.evaluate(xs, ys);
+      passed = checkTrue(ys.size() == xs.size(), "Batched evaluation of wrapped function fiii returns wrong number of values");
+      for (std::size_t k = 0; k < std::min(xs.size(), ys.size()); ++k)
+        passed = checkTrue(ys[k] == fiii(xs[k]), "Batched evaluation of wrapped function fiii returns wrong value");
+
       // Wrap as non-differentiable function
       auto g = [=] (const double& x) {return f(x);};
       passed = checkTrue(isFunction(g, SignatureTag<double(double)>()), "Lambda function g does not satisfy Function concept");
@@ -134,9 +144,38 @@ struct DifferentiableFunctionImplementableTest
     auto F = makeDifferentiableFunctionFromCallables(Dune::Functions::SignatureTag<double(double)>(), f, df, ddf, dddf);
     passed = passed and checkWithFunction(F);
 
+    passed = passed and checkBufferSize();
+
     return passed;
   }
 
+  // Check if the buffer size of the wrapper is respected
+  static bool checkBufferSize()
+  {
+    using Dune::Functions::DefaultDerivativeTraits;
+    using Dune::Functions::PolymorphicSmallObjectStatistics;
+    using P = Dune::Functions::Polynomial<double>;
+    using SmallWrapper = Dune::Functions::DifferentiableFunction<double(double), DefaultDerivativeTraits, 8>;
+    using LargeWrapper = Dune::Functions::DifferentiableFunction<double(double), DefaultDerivativeTraits, SmallWrapper::requiredBufferSize<P>()>;
+
+    static_assert(not SmallWrapper::fitsIntoBuffer<P>());
+    static_assert(LargeWrapper::fitsIntoBuffer<P>());
+
+    PolymorphicSmallObjectStatistics::reset();
+    PolymorphicSmallObjectStatistics::enable();
+    {
+      SmallWrapper small = P({1, 2, 3});
+      LargeWrapper large = P({1, 2, 3});
+    }
+    PolymorphicSmallObjectStatistics::enable(false);
+
+    std::size_t heapAllocations = 0;
+    for (auto&& counter : PolymorphicSmallObjectStatistics::heapAllocations())
+      heapAllocations += counter.second;
+    PolymorphicSmallObjectStatistics::reset();
+    return checkTrue(heapAllocations == 1, "Wrapped function does not respect buffer size");
+  }
+
 
 };
 
@@ -9,6 +9,7 @@
 #include <array>
 #include <iostream>
 #include <string>
+#include <typeinfo>
 #include <utility>
 
 class Base
@@ -79,6 +80,37 @@ bool test()
   return success;
 }
 
+bool testStatistics()
+{
+  using Statistics = Dune::Functions::PolymorphicSmallObjectStatistics;
+  using Obj = Dune::Functions::PolymorphicSmallObject<Base, 0>;
+  using BufferObj = Dune::Functions::PolymorphicSmallObject<Base, sizeof(Derived)>;
+  bool success = true;
+
+  Statistics::reset();
+  Statistics::enable();
+  {
+    Obj obj(Derived{1});
+    Obj objCopy(obj);
+    Obj objMove(std::move(objCopy));
+    BufferObj bufferObj(Derived{1});
+    BufferObj bufferObjCopy(bufferObj);
+  }
+  Statistics::enable(false);
+  {
+    Obj obj(Derived{1});
+  }
+
+  auto counters = Statistics::heapAllocations();
+  success &= checkTrue(counters.size() == 1, "Heap allocations counted for wrong types!");
+  success &= checkTrue(counters[typeid(Derived)] == 2, "Wrong number of heap allocations counted!");
+
+  Statistics::reset();
+  success &= checkTrue(Statistics::heapAllocations().empty(), "Heap allocation counters not reset!");
+
+  return success;
+}
+
 int main ( int argc, char **argv )
 try
 {
@@ -92,6 +124,12 @@ try
   constexpr std::size_t OBJSIZE = sizeof(Derived);
   passed &= test<Dune::Functions::PolymorphicSmallObject<Base, OBJSIZE>>();
 
+  static_assert(not Dune::Functions::PolymorphicSmallObject<Base, 0>::fitsIntoBuffer<Derived>());
+  static_assert(Dune::Functions::PolymorphicSmallObject<Base, OBJSIZE>::fitsIntoBuffer<Derived>());
+
+  std::cout << "Testing heap allocation statistics" << std::endl;
+  passed &= testStatistics();
+
   if (passed)
     std::cout << "All tests passed" << std::endl;
 
@@ -163,12 +163,37 @@ public:
 template<class Interface, template<class> class Implementation, size_t bufferSize = 56>
 class TypeErasureBase
 {
+  template<class T>
+  using Wrapper = Imp::TypeErasureWrapperImplementation<Interface, Implementation, std::decay_t<T>>;
+
+  using Storage = PolymorphicSmallObject<Imp::TypeErasureWrapperInterface<Interface>, bufferSize>;
+
 public:
 
+  /**
+   * \brief Buffer size needed to store an object of type T without dynamic allocation
+   *
+   * This can be used to select the `bufferSize` of a type-erased
+   * interface wrapper for a given type, e.g.,
+   * `GridFunction<Signature, EntitySet, DefaultDerivativeTraits, GridFunction<Signature, EntitySet>::requiredBufferSize<F>()>`.
+   */
+  template<class T>
+  static constexpr std::size_t requiredBufferSize()
+  {
+    return sizeof(Wrapper<T>);
+  }
+
+  //! Check if an object of type T is stored without dynamic allocation
+  template<class T>
+  static constexpr bool fitsIntoBuffer()
+  {
+    return Storage::template fitsIntoBuffer<Wrapper<T>>();
+  }
+
   //! Construct wrapper from object
   template<class T, disableCopyMove<TypeErasureBase, T> = 0 >
   TypeErasureBase(T&& t) :
-    wrapped_(Imp::TypeErasureWrapperImplementation<Interface, Implementation, std::decay_t<T>>(std::forward<T>(t)))
+    wrapped_(Wrapper<T>(std::forward<T>(t)))
   {}
 
   //! Default constructor
@@ -193,7 +218,7 @@ public:
   }
 
 protected:
-  PolymorphicSmallObject<Imp::TypeErasureWrapperInterface<Interface>, bufferSize > wrapped_;
+  Storage wrapped_;
 };
 
 
@@ -0,0 +1,332 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_BASISINDEXMAP_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_BASISINDEXMAP_HH
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <map>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <dune/common/hash.hh>
+
+#include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/typeindex.hh>
+
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <dune/typetree/traversal.hh>
+
+#include <dune/functions/functionspacebases/lagrangebasis.hh>
+
+namespace Dune {
+namespace Functions {
+
+
+
+/**
+ * \brief Map between the global DOF indices of a basis before and after grid adaptation
+ *
+ * \ingroup FunctionSpaceBasesUtilities
+ *
+ * Updating a global basis after grid adaptation renumbers all DOFs,
+ * although most of them are still attached to the same grid entities.
+ * This class identifies each DOF by the persistent id of its entity in the
+ * `LocalIdSet` of the grid, the index within the entity, and the number of
+ * the leaf node. If an edge or face carries several DOFs of a scalar leaf
+ * node, their element-local order depends on the orientation of the element.
+ * Hence their index within the entity is computed from the position of the
+ * Lagrange node, ordered by the persistent ids of the vertices of the entity.
+ * If the nodes on an entity are not equidistant, e.g. for non-nodal bases,
+ * the index of the local key is used instead. It records these keys for the current state of the basis,
+ * and after the basis has been updated, `update()` computes the maps between
+ * old and new indices by a hash lookup. DOFs of new entities are mapped
+ * to `invalidIndex`.
+ *
+ * A typical adaptation step looks like
+ * \code
+ * BasisIndexMap indexMap(basis);
+ * grid.preAdapt(); grid.adapt(); grid.postAdapt();
+ * basis.update(grid.leafGridView());
+ * indexMap.update(basis);
+ * indexMap.transfer(oldCoefficients, newCoefficients);
+ * \endcode
+ * followed by an interpolation of the new DOFs, that are marked by
+ * `isNew()`, on the changed elements only. The same object can be used
+ * for subsequent adaptation steps.
+ *
+ * The coefficient of a DOF is only carried over unchanged if the global
+ * basis function associated to it only depends on its entity. This holds
+ * for `LagrangeBasis` and `LagrangeDGBasis`, but not for bases where the
+ * orientation of the shape functions is derived from the numbering of the
+ * grid entities, like `RaviartThomasBasis`, `NedelecBasis`, or
+ * `HierarchicalLagrangeBasis` for order larger than two.
+ *
+ * This class does not make updating the basis cheaper, it adds cost:
+ * The global basis itself still recomputes all indices in `update()`,
+ * and each call to `update()` of this class binds a local view to every
+ * element once more, looks up the ids of all DOF entities, and fills a hash
+ * map with the keys of all old DOFs. What it saves is the interpolation of
+ * the kept DOFs, which is replaced by a permutation of their coefficients.
+ *
+ * \tparam B Type of the global basis, it must have flat multi-indices
+ */
+template<class B>
+class BasisIndexMap
+{
+  using Basis = B;
+  using GridView = typename Basis::GridView;
+  using IdType = typename GridView::Grid::LocalIdSet::IdType;
+
+  static constexpr int dim = GridView::dimension;
+
+public:
+
+  using size_type = std::size_t;
+
+  //! Index marking DOFs that have no counterpart in the other basis
+  static constexpr size_type invalidIndex = std::numeric_limits<size_type>::max();
+
+  //! Record the DOF keys of the current state of the basis
+  explicit BasisIndexMap(const B& basis)
+  {
+    computeKeys(basis, keys_);
+  }
+
+  /**
+   * \brief Compute the index maps from the recorded state to the updated basis
+   *
+   * Afterwards the keys of the updated basis are recorded,
+   * such that the next call refers to this state.
+   */
+  void update(const B& basis)
+  {
+    std::unordered_map<Key, size_type, KeyHash> oldIndices;
+    oldIndices.reserve(keys_.size());
+    for (size_type i = 0; i < keys_.size(); ++i)
+      oldIndices.emplace(keys_[i], i);
+
+    std::vector<Key> newKeys;
+    computeKeys(basis, newKeys);
+
+    oldToNew_.assign(keys_.size(), invalidIndex);
+    newToOld_.assign(newKeys.size(), invalidIndex);
+    for (size_type i = 0; i < newKeys.size(); ++i)
+    {
+      auto it = oldIndices.find(newKeys[i]);
+      if (it == oldIndices.end())
+        continue;
+      newToOld_[i] = it->second;
+      oldToNew_[it->second] = i;
+    }
+    keys_ = std::move(newKeys);
+  }
+
+  //! New index of the given old DOF or invalidIndex if it has been removed
+  size_type oldToNew(size_type oldIndex) const
+  {
+    return oldToNew_[oldIndex];
+  }
+
+  //! Old index of the given new DOF or invalidIndex if it is new
+  size_type newToOld(size_type newIndex) const
+  {
+    return newToOld_[newIndex];
+  }
+
+  //! Check if the given DOF of the updated basis has no counterpart in the old basis
+  bool isNew(size_type newIndex) const
+  {
+    return newToOld_[newIndex] == invalidIndex;
+  }
+
+  //! Vector of new indices for all old DOFs
+  const std::vector<size_type>& oldToNewMap() const
+  {
+    return oldToNew_;
+  }
+
+  //! Vector of old indices for all new DOFs
+  const std::vector<size_type>& newToOldMap() const
+  {
+    return newToOld_;
+  }
+
+  /**
+   * \brief Copy the coefficients of all DOFs that are kept
+   *
+   * \param oldCoefficients Coefficient vector of the old basis
+   * \param newCoefficients Coefficient vector of the updated basis, which must already
+   *                        have the right size. Entries of new DOFs are not modified.
+   */
+  template<class OldVector, class NewVector>
+  void transfer(const OldVector& oldCoefficients, NewVector& newCoefficients) const
+  {
+    for (size_type i = 0; i < newToOld_.size(); ++i)
+      if (newToOld_[i] != invalidIndex)
+        newCoefficients[i] = oldCoefficients[newToOld_[i]];
+  }
+
+private:
+
+  struct Key
+  {
+    IdType id;
+    unsigned int codim;
+    unsigned int index;
+    size_type leaf;
+
+    bool operator==(const Key& other) const
+    {
+      return id == other.id and codim == other.codim and index == other.index and leaf == other.leaf;
+    }
+  };
+
+  struct KeyHash
+  {
+    std::size_t operator()(const Key& key) const
+    {
+      std::size_t seed = std::hash<IdType>()(key.id);
+      hash_combine(seed, key.codim);
+      hash_combine(seed, key.index);
+      hash_combine(seed, key.leaf);
+      return seed;
+    }
+  };
+
+  // The lattice coordinates of the Lagrange nodes of a finite element on edges and faces
+  // with several DOFs, see Impl::lagrangeCanonicalSubEntityIndex(). For all other DOFs,
+  // and for all DOFs of a sub-entity with a node off the lattice, the first coordinate
+  // is negative.
+  struct Lattice
+  {
+    int order;
+    std::vector<std::array<int,4>> coordinates;
+  };
+
+  template<class FiniteElement>
+  static Lattice computeLattice(const FiniteElement& finiteElement, const GeometryType& type)
+  {
+    const auto& localCoefficients = finiteElement.localCoefficients();
+    const auto refElement = referenceElement<double,dim>(type);
+    Lattice lattice{int(finiteElement.localBasis().order()), std::vector<std::array<int,4>>(finiteElement.size(), {{-1, 0, 0, 0}})};
+
+    std::array<std::vector<unsigned int>,dim+1> counts;
+    std::array<std::vector<bool>,dim+1> onLattice;
+    for (int codim = 0; codim <= dim; ++codim)
+    {
+      counts[codim].assign(refElement.size(codim), 0);
+      onLattice[codim].assign(refElement.size(codim), true);
+    }
+    for (size_type i = 0; i < finiteElement.size(); ++i)
+      ++counts[localCoefficients.localKey(i).codim()][localCoefficients.localKey(i).subEntity()];
+
+    std::vector<FieldVector<double,dim>> positions;
+    for (size_type i = 0; i < finiteElement.size(); ++i)
+    {
+      const auto& localKey = localCoefficients.localKey(i);
+      const int codim = localKey.codim();
+      if (codim == 0 or codim == dim or counts[codim][localKey.subEntity()] < 2)
+        continue;
+      if (positions.empty())
+        positions = Impl::lagrangeNodePositions<dim>(finiteElement);
+
+      std::size_t n = refElement.size(localKey.subEntity(), codim, dim);
+      std::array<int,4> vertices;
+      for (std::size_t m = 0; m < n; ++m)
+        vertices[m] = refElement.subEntity(localKey.subEntity(), codim, m, dim);
+      auto local = Impl::lagrangeSubEntityCoordinates(refElement, vertices, n, positions[i]);
+      std::array<int,2> l;
+      for (std::size_t j = 0; j < 2; ++j)
+      {
+        l[j] = std::lround(local[j]*lattice.order);
+        if (std::abs(local[j]*lattice.order - l[j]) > 1e-8)
+          onLattice[codim][localKey.subEntity()] = false;
+      }
+      if (n == 4)
+        lattice.coordinates[i] = {{ l[0], l[1], 0, 0 }};
+      else
+        lattice.coordinates[i] = {{ lattice.order - l[0] - l[1], l[0], l[1], 0 }};
+    }
+
+    for (size_type i = 0; i < finiteElement.size(); ++i)
+      if (not onLattice[localCoefficients.localKey(i).codim()][localCoefficients.localKey(i).subEntity()])
+        lattice.coordinates[i][0] = -1;
+    return lattice;
+  }
+
+  static void computeKeys(const B& basis, std::vector<Key>& keys)
+  {
+    const auto& idSet = basis.gridView().grid().localIdSet();
+    keys.resize(basis.dimension());
+    auto localView = basis.localView();
+    std::map<std::pair<size_type,std::size_t>, Lattice> lattices;
+    for (const auto& element : elements(basis.gridView()))
+    {
+      localView.bind(element);
+      const auto refElement = referenceElement(element);
+      size_type leaf = 0;
+      TypeTree::forEachLeafNode(localView.tree(), [&](const auto& node, auto&&) {
+        const auto& finiteElement = node.finiteElement();
+        const auto& localCoefficients = finiteElement.localCoefficients();
+        using LocalBasis = std::decay_t<decltype(finiteElement.localBasis())>;
+
+        const Lattice* lattice = nullptr;
+        if constexpr (LocalBasis::Traits::dimRange == 1)
+        {
+          auto it = lattices.find({leaf, LocalGeometryTypeIndex::index(element.type())});
+          if (it == lattices.end())
+            it = lattices.emplace(std::make_pair(leaf, LocalGeometryTypeIndex::index(element.type())), computeLattice(finiteElement, element.type())).first;
+          lattice = &it->second;
+        }
+
+        for (size_type i = 0; i < node.size(); ++i)
+        {
+          const auto& localKey = localCoefficients.localKey(i);
+          const auto& multiIndex = localView.index(node.localIndex(i));
+          assert(multiIndex.size() == 1);
+          unsigned int index = localKey.index();
+
+          // Number the DOFs of an edge or face by the ranks of the ids of its vertices
+          if (lattice and lattice->coordinates[i][0] >= 0)
+          {
+            std::size_t n = refElement.size(localKey.subEntity(), localKey.codim(), dim);
+            std::array<IdType,4> vertexIds;
+            for (std::size_t m = 0; m < n; ++m)
+              vertexIds[m] = idSet.subId(element, refElement.subEntity(localKey.subEntity(), localKey.codim(), m, dim), dim);
+            std::array<std::size_t,4> ranks;
+            for (std::size_t m = 0; m < n; ++m)
+            {
+              ranks[m] = 0;
+              for (std::size_t j = 0; j < n; ++j)
+                ranks[m] += (vertexIds[j] < vertexIds[m]);
+            }
+            index = Impl::lagrangeCanonicalSubEntityIndex(ranks, lattice->coordinates[i], n, lattice->order);
+          }
+
+          keys[multiIndex[0]] = Key{idSet.subId(element, localKey.subEntity(), localKey.codim()),
+            localKey.codim(), index, leaf};
+        }
+        ++leaf;
+      });
+    }
+  }
+
+  std::vector<Key> keys_;
+  std::vector<size_type> oldToNew_;
+  std::vector<size_type> newToOld_;
+};
+
+
+
+} // end namespace Functions
+} // end namespace Dune
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_BASISINDEXMAP_HH
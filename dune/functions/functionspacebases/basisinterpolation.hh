@@ -0,0 +1,273 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_BASISINTERPOLATION_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_BASISINTERPOLATION_HH
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+
+#include <dune/geometry/typeindex.hh>
+
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <dune/typetree/childextraction.hh>
+#include <dune/typetree/traversal.hh>
+
+#include <dune/functions/backends/concepts.hh>
+#include <dune/functions/backends/istlvectorbackend.hh>
+
+namespace Dune {
+namespace Functions {
+
+template<typename GV, int k, typename R>
+class HierarchicalLagrangeNode;
+
+template<typename GV, int k>
+class RaviartThomasNode;
+
+template<typename GV, int k>
+class BrezziDouglasMariniNode;
+
+template<typename GV, typename Range, std::size_t kind, int order>
+class NedelecNode;
+
+
+
+namespace Impl {
+
+  // Leaf nodes whose local finite element does not only depend on the geometry
+  // type, but on the orientation of the element or of its sub-entities
+  template<class Node>
+  struct HasOrientedFiniteElement : std::false_type {};
+
+  // The hierarchical shape functions of order k<=2 do not depend on the orientation
+  template<class GV, int k, class R>
+  struct HasOrientedFiniteElement<HierarchicalLagrangeNode<GV,k,R>> : std::bool_constant<(k > 2)> {};
+
+  template<class GV, int k>
+  struct HasOrientedFiniteElement<RaviartThomasNode<GV,k>> : std::true_type {};
+
+  template<class GV, int k>
+  struct HasOrientedFiniteElement<BrezziDouglasMariniNode<GV,k>> : std::true_type {};
+
+  template<class GV, class Range, std::size_t kind, int order>
+  struct HasOrientedFiniteElement<NedelecNode<GV,Range,kind,order>> : std::true_type {};
+
+  // Compute the matrix mapping the coefficients of the source finite element
+  // to the coefficients of the interpolant in the target finite element.
+  // Column j contains the interpolation of the j-th source shape function.
+  // The target coordinates are mapped to the source element by toSource,
+  // e.g. for a source element that is an ancestor of the target element.
+  template<class SourceFiniteElement, class TargetFiniteElement, class Field, class CoordinateMap>
+  void localTransferMatrix(const SourceFiniteElement& source, const TargetFiniteElement& target, DynamicMatrix<Field>& matrix, const CoordinateMap& toSource)
+  {
+    using LocalBasis = typename SourceFiniteElement::Traits::LocalBasisType;
+    using Domain = typename LocalBasis::Traits::DomainType;
+    using Range = typename LocalBasis::Traits::RangeType;
+
+    std::vector<Range> values;
+    std::vector<Field> coefficients;
+    matrix.resize(target.size(), source.size());
+    for (std::size_t j = 0; j < source.size(); ++j)
+    {
+      target.localInterpolation().interpolate([&](const Domain& x) {
+        source.localBasis().evaluateFunction(toSource(x), values);
+        return values[j];
+      }, coefficients);
+      for (std::size_t i = 0; i < target.size(); ++i)
+        matrix[i][j] = coefficients[i];
+    }
+  }
+
+  // Compute the local transfer matrix for source and target finite elements on the same element
+  template<class SourceFiniteElement, class TargetFiniteElement, class Field>
+  void localTransferMatrix(const SourceFiniteElement& source, const TargetFiniteElement& target, DynamicMatrix<Field>& matrix)
+  {
+    localTransferMatrix(source, target, matrix, [](const auto& x) { return x; });
+  }
+
+} // end namespace Impl
+
+
+
+/**
+ * \brief Interpolation of discrete functions between two bases on the same grid view
+ *
+ * \ingroup FunctionSpaceBasesUtilities
+ *
+ * This computes the same coefficients as `interpolate(targetBasis, y, f)`
+ * with the discrete function f of the source basis and the coefficients x,
+ * e.g., to project a second order velocity to a first order one for output
+ * or to a discontinuous basis for limiting. Instead of evaluating f in the
+ * interpolation points of each element, the interpolation is represented by
+ * a local matrix per leaf node and geometry type. These matrices are computed
+ * once in the constructor, and the interpolation on each element reduces to
+ * gathering the source coefficients, a dense matrix-vector product, and
+ * scattering the result.
+ *
+ * The trees of both bases must have the same structure, and the leaf nodes
+ * must have the same range dimension. As for `interpolate()`, target DOFs
+ * shared by several elements are overwritten by the last element.
+ *
+ * For leaf nodes whose local finite elements depend on the orientation of the
+ * element or its sub-entities, like those of `HierarchicalLagrangeBasis`,
+ * `RaviartThomasBasis`, `BrezziDouglasMariniBasis`, or `NedelecBasis`, the
+ * local matrix is computed on each element instead.
+ *
+ * \warning Apart from these, the local finite elements of both bases must only
+ * depend on the geometry type of the element. This excludes bases on non-affine
+ * elements where the interpolation depends on the geometry.
+ *
+ * \tparam SB Type of the source global basis
+ * \tparam TB Type of the target global basis
+ * \tparam F Field type of the local interpolation matrices
+ */
+template<class SB, class TB, class F = double>
+class BasisInterpolator
+{
+  using SourceBasis = SB;
+  using TargetBasis = TB;
+  using Field = F;
+  using GridView = typename SourceBasis::GridView;
+
+  static constexpr int dim = GridView::dimension;
+
+public:
+
+  //! Precompute the local interpolation matrices of all leaf nodes and geometry types
+  BasisInterpolator(const SB& sourceBasis, const TB& targetBasis) :
+    sourceBasis_(&sourceBasis),
+    targetBasis_(&targetBasis),
+    localMatrices_(LocalGeometryTypeIndex::size(dim))
+  {
+    const auto& gridView = sourceBasis.gridView();
+    auto sourceLocalView = sourceBasis.localView();
+    auto targetLocalView = targetBasis.localView();
+    std::size_t missingTypes = gridView.indexSet().types(0).size();
+    for (const auto& element : elements(gridView))
+    {
+      auto& localMatrices = localMatrices_[LocalGeometryTypeIndex::index(element.type())];
+      if (not localMatrices.empty())
+        continue;
+      sourceLocalView.bind(element);
+      targetLocalView.bind(element);
+      forEachLeafNodePair(sourceLocalView, targetLocalView, [&](const auto& sourceNode, const auto& targetNode) {
+        localMatrices.emplace_back();
+        if constexpr (not isOriented<decltype(sourceNode), decltype(targetNode)>)
+          Impl::localTransferMatrix(sourceNode.finiteElement(), targetNode.finiteElement(), localMatrices.back());
+      });
+      if (--missingTypes == 0)
+        break;
+    }
+  }
+
+  /**
+   * \brief Interpolate the discrete function of the source basis into the target basis
+   *
+   * \param source Coefficient vector of the source basis
+   * \param target Coefficient vector of the target basis, it is resized to fit the target basis
+   */
+  template<class SourceVector, class TargetVector>
+  void operator()(const SourceVector& source, TargetVector&& target) const
+  {
+    auto toVectorBackend = [&](auto& v) -> decltype(auto) {
+      if constexpr (models<Concept::VectorBackend<TB>, decltype(v)>()) {
+        return v;
+      } else {
+        return istlVectorBackend(v);
+      }
+    };
+
+    auto toConstVectorBackend = [&](auto& v) -> decltype(auto) {
+      if constexpr (models<Concept::ConstVectorBackend<SB>, decltype(v)>()) {
+        return v;
+      } else {
+        return istlVectorBackend(v);
+      }
+    };
+
+    auto&& sourceVector = toConstVectorBackend(source);
+    auto&& targetVector = toVectorBackend(target);
+    targetVector.resize(*targetBasis_);
+
+    auto sourceLocalView = sourceBasis_->localView();
+    auto targetLocalView = targetBasis_->localView();
+    DynamicVector<Field> localSource, localTarget;
+    DynamicMatrix<Field> elementMatrix;
+    for (const auto& element : elements(sourceBasis_->gridView()))
+    {
+      sourceLocalView.bind(element);
+      targetLocalView.bind(element);
+      const auto& localMatrices = localMatrices_[LocalGeometryTypeIndex::index(element.type())];
+      std::size_t leafIndex = 0;
+      forEachLeafNodePair(sourceLocalView, targetLocalView, [&](const auto& sourceNode, const auto& targetNode) {
+        const auto* localMatrix = &localMatrices[leafIndex++];
+        if constexpr (isOriented<decltype(sourceNode), decltype(targetNode)>)
+        {
+          Impl::localTransferMatrix(sourceNode.finiteElement(), targetNode.finiteElement(), elementMatrix);
+          localMatrix = &elementMatrix;
+        }
+        localSource.resize(sourceNode.size());
+        localTarget.resize(targetNode.size());
+        for (std::size_t j = 0; j < sourceNode.size(); ++j)
+          localSource[j] = sourceVector[sourceLocalView.index(sourceNode.localIndex(j))];
+        localMatrix->mv(localSource, localTarget);
+        for (std::size_t i = 0; i < targetNode.size(); ++i)
+          targetVector[targetLocalView.index(targetNode.localIndex(i))] = localTarget[i];
+      });
+    }
+  }
+
+private:
+
+  // Whether the local matrix of a pair of leaf nodes has to be computed per element
+  template<class SourceNode, class TargetNode>
+  static constexpr bool isOriented = Impl::HasOrientedFiniteElement<std::decay_t<SourceNode>>::value
+    or Impl::HasOrientedFiniteElement<std::decay_t<TargetNode>>::value;
+
+  // Call f(sourceNode, targetNode) for all pairs of leaf nodes with the same tree path
+  template<class SourceLocalView, class TargetLocalView, class Callback>
+  static void forEachLeafNodePair(const SourceLocalView& sourceLocalView, const TargetLocalView& targetLocalView, Callback&& f)
+  {
+    TypeTree::forEachLeafNode(sourceLocalView.tree(), [&](const auto& sourceNode, auto&& treePath) {
+      f(sourceNode, TypeTree::child(targetLocalView.tree(), treePath));
+    });
+  }
+
+  const SourceBasis* sourceBasis_;
+  const TargetBasis* targetBasis_;
+  std::vector<std::vector<DynamicMatrix<Field>>> localMatrices_;
+};
+
+
+
+/**
+ * \brief Interpolate a discrete function of the source basis into the target basis
+ *
+ * \ingroup FunctionSpaceBasesUtilities
+ *
+ * This is a shortcut for a single application of `BasisInterpolator`. If the
+ * interpolation is repeated, e.g., in each time step, the `BasisInterpolator`
+ * should be kept to avoid recomputing the local matrices.
+ *
+ * \param sourceBasis Global basis of the source function
+ * \param source Coefficient vector of the source function
+ * \param targetBasis Global basis of the target function space
+ * \param target Coefficient vector of the interpolant
+ */
+template<class SB, class SV, class TB, class TV>
+void interpolateBasisFunction(const SB& sourceBasis, const SV& source, const TB& targetBasis, TV&& target)
+{
+  BasisInterpolator<SB,TB>(sourceBasis, targetBasis)(source, target);
+}
+
+
+
+} // end namespace Functions
+} // end namespace Dune
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_BASISINTERPOLATION_HH
@@ -86,7 +86,6 @@ namespace Impl {
     using FiniteElement = LocalFiniteElementVirtualInterface<T>;
 
     BDMLocalFiniteElementMap(const GV& gv)
-      : is_(&(gv.indexSet())), orient_(gv.size(0))
     {
       cubeVariant_.resize(BDMCubeLocalInfo<dim, D, R, k>::Variants);
       simplexVariant_.resize(BDMSimplexLocalInfo<dim, D, R, k>::Variants);
@@ -98,6 +97,15 @@ namespace Impl {
       for (size_t i = 0; i < simplexVariant_.size(); i++)
         simplexVariant_[i] = std::make_shared<LocalFiniteElementVirtualImp<SimplexFiniteElement> >(SimplexFiniteElement(i));
 
+      update(gv);
+    }
+
+    //! Recompute the orientations of all elements, to be called if the grid has changed
+    void update(const GV& gv)
+    {
+      is_ = &(gv.indexSet());
+      orient_.resize(gv.size(0));
+
       // compute orientation for all elements
       // loop once over the grid
       for(const auto& cell : elements(gv))
@@ -192,6 +200,7 @@ public:
   void update (const GridView& gv)
   {
     gridView_ = gv;
+    finiteElementMap_.update(gv);
   }
 
   /**
@@ -0,0 +1,165 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_BROKENBASIS_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_BROKENBASIS_HH
+
+#include <cstddef>
+#include <numeric>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <dune/functions/functionspacebases/defaultglobalbasis.hh>
+#include <dune/functions/functionspacebases/leafprebasismixin.hh>
+
+namespace Dune {
+namespace Functions {
+
+
+
+/**
+ * \brief A pre-basis decoupling the DOFs of a leaf pre-basis across elements
+ *
+ * \ingroup FunctionSpaceBasesImplementations
+ *
+ * This pre-basis wraps another leaf pre-basis and uses the same tree nodes
+ * and local finite elements. However, each element gets its own DOFs, which
+ * are numbered consecutively per element in the order of the element index.
+ * Hence the resulting space is the broken (discontinuous) counterpart of the
+ * wrapped space, e.g. `broken(raviartThomas<k>())` is the broken Raviart-Thomas
+ * space used in hybridized mixed methods.
+ *
+ * The local keys of the wrapped finite elements are not modified.
+ * Since the number of DOFs per element is determined by binding a node
+ * to each element, initializeIndices() has linear complexity in the
+ * number of elements.
+ *
+ * \tparam RPB The raw pre-basis to be wrapped, it must have a leaf node
+ */
+template<class RPB>
+class BrokenPreBasis :
+  public LeafPreBasisMixin< BrokenPreBasis<RPB> >
+{
+public:
+
+  using RawPreBasis = RPB;
+
+  //! The grid view that the FE basis is defined on
+  using GridView = typename RawPreBasis::GridView;
+
+  //! Type used for indices and size information
+  using size_type = std::size_t;
+
+  //! Template mapping root tree path to type of created tree node
+  using Node = typename RawPreBasis::Node;
+
+  static_assert(Node::isLeaf, "BrokenPreBasis can only wrap pre-bases with a leaf node");
+
+  //! Constructor for a given raw pre-basis, which is stored as a copy
+  BrokenPreBasis(const RawPreBasis& rawPreBasis) :
+    rawPreBasis_(rawPreBasis)
+  {}
+
+  //! Constructor for a given raw pre-basis, which is moved into this object
+  BrokenPreBasis(RawPreBasis&& rawPreBasis) :
+    rawPreBasis_(std::move(rawPreBasis))
+  {}
+
+  //! Initialize the global indices
+  void initializeIndices()
+  {
+    rawPreBasis_.initializeIndices();
+
+    const auto& gridView = rawPreBasis_.gridView();
+    const auto& indexSet = gridView.indexSet();
+    elementOffsets_.assign(gridView.size(0)+1, 0);
+    auto node = rawPreBasis_.makeNode();
+    for (const auto& element : elements(gridView))
+    {
+      node.bind(element);
+      elementOffsets_[indexSet.index(element)+1] = node.size();
+    }
+    std::partial_sum(elementOffsets_.begin(), elementOffsets_.end(), elementOffsets_.begin());
+  }
+
+  //! Obtain the grid view that the basis is defined on
+  const GridView& gridView() const
+  {
+    return rawPreBasis_.gridView();
+  }
+
+  //! Update the stored grid view, to be called if the grid has changed
+  void update(const GridView& gv)
+  {
+    rawPreBasis_.update(gv);
+  }
+
+  //! Create tree node
+  Node makeNode() const
+  {
+    return rawPreBasis_.makeNode();
+  }
+
+  //! Get the total dimension of the space spanned by this basis
+  size_type dimension() const
+  {
+    return elementOffsets_.empty() ? 0 : elementOffsets_.back();
+  }
+
+  //! Get the maximal number of DOFs associated to node for any element
+  size_type maxNodeSize() const
+  {
+    return rawPreBasis_.maxNodeSize();
+  }
+
+  //! Access the wrapped pre-basis
+  const RawPreBasis& rawPreBasis() const
+  {
+    return rawPreBasis_;
+  }
+
+  //! Fill cache with global indices of DOFs associated to the given bound node
+  template<typename It>
+  It indices(const Node& node, It it) const
+  {
+    size_type offset = elementOffsets_[gridView().indexSet().index(node.element())];
+    for (size_type i = 0; i < node.size(); ++i, ++it)
+      *it = {{ offset + i }};
+    return it;
+  }
+
+protected:
+  RawPreBasis rawPreBasis_;
+  std::vector<size_type> elementOffsets_;
+};
+
+
+
+namespace BasisFactory {
+
+/**
+ * \brief Create a pre-basis factory that can create a broken pre-basis
+ *
+ * \ingroup FunctionSpaceBasesImplementations
+ *
+ * \param rawPreBasisFactory A pre-basis factory creating a leaf pre-basis
+ */
+template<class RawPreBasisFactory>
+auto broken(RawPreBasisFactory&& rawPreBasisFactory)
+{
+  return [rawPreBasisFactory=std::forward<RawPreBasisFactory>(rawPreBasisFactory)](const auto& gridView) {
+    auto rawPreBasis = rawPreBasisFactory(gridView);
+    return BrokenPreBasis<decltype(rawPreBasis)>(std::move(rawPreBasis));
+  };
+}
+
+} // end namespace BasisFactory
+
+
+
+} // end namespace Functions
+} // end namespace Dune
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_BROKENBASIS_HH
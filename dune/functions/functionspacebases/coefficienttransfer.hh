@@ -0,0 +1,303 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_COEFFICIENTTRANSFER_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_COEFFICIENTTRANSFER_HH
+
+#include <array>
+#include <cstddef>
+#include <functional>
+#include <limits>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/referenceelements.hh>
+
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <dune/typetree/traversal.hh>
+
+#include <dune/functions/backends/concepts.hh>
+#include <dune/functions/backends/istlvectorbackend.hh>
+#include <dune/functions/common/parallelfor.hh>
+
+namespace Dune {
+namespace Functions {
+
+
+
+/**
+ * \brief Transfer of a coefficient vector across grid adaptation
+ *
+ * \ingroup FunctionSpaceBasesUtilities
+ *
+ * Before adaptation, `store()` saves the local coefficients of each leaf
+ * element in a flat array, together with their offset keyed by the persistent
+ * id of the element in the `LocalIdSet` of the grid. Elements that might vanish
+ * are additionally combined into their father, whose local coefficients are
+ * obtained by interpolating the function given on the children.
+ * After adaptation and `basis.update()`, `restore()` copies the saved local
+ * coefficients of all elements that still exist, using one hash lookup per
+ * element. Only on new elements the local interpolation is evaluated, using
+ * the saved function on the nearest ancestor that existed before adaptation.
+ * The element loop of `restore()` can be run in parallel. Each DOF is
+ * then written by the first element containing its sub-entity only.
+ *
+ * A typical adaptation step looks like
+ * \code
+ * grid.preAdapt();
+ * CoefficientTransfer transfer(basis);
+ * transfer.store(coefficients);
+ * grid.adapt();
+ * basis.update(grid.leafGridView());
+ * transfer.restore(coefficients, threads);
+ * grid.postAdapt();
+ * \endcode
+ * `store()` must be called after `grid.preAdapt()`, because it relies on
+ * `mightVanish()` to detect coarsening.
+ * The children of the father of a vanishing element must all be leaf elements.
+ *
+ * The interpolation on new elements is exact if the function space on the
+ * old grid is contained in the one on the new grid, i.e., for refinement of
+ * conforming Lagrange spaces.
+ *
+ * \warning The local finite elements must only depend on the geometry type
+ * of the element, and refinement must preserve the geometry type. This
+ * excludes bases whose elements depend on the orientation of the element
+ * or on the global vertex indices, like `RaviartThomasBasis`, `NedelecBasis`,
+ * or `HierarchicalLagrangeBasis`.
+ *
+ * \tparam B Type of the global basis
+ * \tparam F Field type of the stored coefficients
+ */
+template<class B, class F = double>
+class CoefficientTransfer
+{
+  using Basis = B;
+  using Field = F;
+  using GridView = typename Basis::GridView;
+  using Element = typename GridView::template Codim<0>::Entity;
+  using IdType = typename GridView::Grid::LocalIdSet::IdType;
+  using size_type = std::size_t;
+
+  static constexpr int dim = GridView::dimension;
+  static constexpr size_type invalidIndex = std::numeric_limits<size_type>::max();
+
+public:
+
+  //! Create a transfer object for the given basis, which is updated after adaptation
+  CoefficientTransfer(const B& basis) :
+    basis_(&basis)
+  {}
+
+  /**
+   * \brief Save the coefficients of the current grid
+   *
+   * \param coefficients Coefficient vector of the basis before adaptation
+   */
+  template<class Vector>
+  void store(const Vector& coefficients)
+  {
+    auto&& vector = toConstVectorBackend(coefficients);
+    const auto& gridView = basis_->gridView();
+    const auto& idSet = gridView.grid().localIdSet();
+
+    offsets_.clear();
+    offsets_.reserve(gridView.size(0));
+    values_.clear();
+    auto localView = basis_->localView();
+    for (const auto& element : elements(gridView))
+    {
+      localView.bind(element);
+      offsets_.emplace(idSet.id(element), values_.size());
+      for (size_type i = 0; i < localView.size(); ++i)
+        values_.push_back(vector[localView.index(i)]);
+    }
+
+    // Interpolate the function on the children into the fathers of elements that might vanish.
+    // This includes irregular elements of the red-green closure, which are replaced on refinement.
+    std::vector<Field> fatherCoefficients, nodeCoefficients;
+    for (const auto& element : elements(gridView))
+    {
+      if (not element.hasFather() or (element.isRegular() and not element.mightVanish()))
+        continue;
+      const auto father = element.father();
+      const auto fatherId = idSet.id(father);
+      if (offsets_.count(fatherId) != 0)
+        continue;
+
+      localView.bind(element);
+      fatherCoefficients.resize(localView.size());
+      TypeTree::forEachLeafNode(localView.tree(), [&](const auto& node, auto&&) {
+        using LocalBasis = std::decay_t<decltype(node.finiteElement().localBasis())>;
+        using Domain = typename LocalBasis::Traits::DomainType;
+        std::vector<typename LocalBasis::Traits::RangeType> shapeValues;
+        node.finiteElement().localInterpolation().interpolate([&](const Domain& x) {
+          for (const auto& child : descendantElements(father, father.level()+1))
+          {
+            auto xChild = child.geometryInFather().local(x);
+            if (referenceElement(child).checkInside(xChild))
+              return evaluate(node, storedCoefficients(idSet.id(child)), xChild, shapeValues);
+          }
+          DUNE_THROW(Dune::Exception, "CoefficientTransfer: No child contains the interpolation point");
+        }, nodeCoefficients);
+        for (size_type i = 0; i < node.size(); ++i)
+          fatherCoefficients[node.localIndex(i)] = nodeCoefficients[i];
+      });
+      offsets_.emplace(fatherId, values_.size());
+      values_.insert(values_.end(), fatherCoefficients.begin(), fatherCoefficients.end());
+    }
+  }
+
+  /**
+   * \brief Restore the saved coefficients on the adapted grid
+   *
+   * \param coefficients Coefficient vector of the updated basis, it is resized to fit the basis
+   * \param threads Number of threads used for the element loop
+   */
+  template<class Vector>
+  void restore(Vector&& coefficients, std::size_t threads = 1) const
+  {
+    auto&& vector = toVectorBackend(coefficients);
+    vector.resize(*basis_);
+    const auto& gridView = basis_->gridView();
+    const auto& indexSet = gridView.indexSet();
+    const auto& idSet = gridView.grid().localIdSet();
+
+    // For each element, find the offset of the saved coefficients of the element itself or
+    // its nearest saved ancestor, and the number of generations between them. The first
+    // element containing a sub-entity owns its DOFs.
+    std::vector<Element> elementList;
+    std::vector<std::pair<size_type,int>> sources;
+    std::array<std::vector<size_type>,dim+1> owners;
+    elementList.reserve(gridView.size(0));
+    sources.reserve(gridView.size(0));
+    for (int codim = 1; codim <= dim; ++codim)
+      owners[codim].assign(indexSet.size(codim), invalidIndex);
+    for (const auto& element : elements(gridView))
+    {
+      const size_type e = elementList.size();
+      elementList.push_back(element);
+
+      auto ancestor = element;
+      int generations = 0;
+      auto it = offsets_.find(idSet.id(ancestor));
+      while (it == offsets_.end() and ancestor.hasFather())
+      {
+        ancestor = ancestor.father();
+        ++generations;
+        it = offsets_.find(idSet.id(ancestor));
+      }
+      if (it == offsets_.end())
+        DUNE_THROW(Dune::Exception, "CoefficientTransfer: No saved coefficients for an element, was store() called before adaptation?");
+      sources.emplace_back(it->second, generations);
+
+      const auto refElement = referenceElement(element);
+      for (int codim = 1; codim <= dim; ++codim)
+        for (int s = 0; s < refElement.size(codim); ++s)
+        {
+          auto& owner = owners[codim][indexSet.subIndex(element, s, codim)];
+          if (owner == invalidIndex)
+            owner = e;
+        }
+    }
+
+    Impl::parallelForRanges(elementList.size(), threads, [&](size_type begin, size_type end) {
+      auto localView = basis_->localView();
+      std::vector<Field> nodeCoefficients;
+      for (size_type e = begin; e < end; ++e)
+      {
+        const auto& element = elementList[e];
+        const Field* saved = values_.data() + sources[e].first;
+        const int generations = sources[e].second;
+        localView.bind(element);
+
+        auto isOwner = [&](const auto& localKey) {
+          return localKey.codim() == 0
+            or owners[localKey.codim()][indexSet.subIndex(element, localKey.subEntity(), localKey.codim())] == e;
+        };
+
+        TypeTree::forEachLeafNode(localView.tree(), [&](const auto& node, auto&&) {
+          const auto& localCoefficients = node.finiteElement().localCoefficients();
+          if (generations == 0)
+          {
+            for (size_type i = 0; i < node.size(); ++i)
+              if (isOwner(localCoefficients.localKey(i)))
+                vector[localView.index(node.localIndex(i))] = saved[node.localIndex(i)];
+            return;
+          }
+
+          using LocalBasis = std::decay_t<decltype(node.finiteElement().localBasis())>;
+          using Domain = typename LocalBasis::Traits::DomainType;
+          std::vector<typename LocalBasis::Traits::RangeType> shapeValues;
+          node.finiteElement().localInterpolation().interpolate([&](const Domain& x) {
+            auto xAncestor = x;
+            auto descendant = element;
+            for (int g = 0; g < generations; ++g, descendant = descendant.father())
+              xAncestor = descendant.geometryInFather().global(xAncestor);
+            return evaluate(node, saved, xAncestor, shapeValues);
+          }, nodeCoefficients);
+          for (size_type i = 0; i < node.size(); ++i)
+            if (isOwner(localCoefficients.localKey(i)))
+              vector[localView.index(node.localIndex(i))] = nodeCoefficients[i];
+        });
+      }
+    });
+  }
+
+private:
+
+  template<class V>
+  static decltype(auto) toVectorBackend(V& v)
+  {
+    if constexpr (models<Concept::VectorBackend<B>, V>())
+      return v;
+    else
+      return istlVectorBackend(v);
+  }
+
+  template<class V>
+  static decltype(auto) toConstVectorBackend(const V& v)
+  {
+    if constexpr (models<Concept::ConstVectorBackend<B>, V>())
+      return v;
+    else
+      return istlVectorBackend(v);
+  }
+
+  const Field* storedCoefficients(const IdType& id) const
+  {
+    auto it = offsets_.find(id);
+    if (it == offsets_.end())
+      DUNE_THROW(Dune::Exception, "CoefficientTransfer: No saved coefficients for an element, was store() called before adaptation?");
+    return values_.data() + it->second;
+  }
+
+  // Evaluate the function given by the local coefficients of an element on the given node
+  template<class Node, class LocalCoordinate, class Range>
+  static Range evaluate(const Node& node, const Field* localCoefficients, const LocalCoordinate& x, std::vector<Range>& shapeValues)
+  {
+    node.finiteElement().localBasis().evaluateFunction(x, shapeValues);
+    Range y(0);
+    for (size_type i = 0; i < node.size(); ++i)
+      y.axpy(localCoefficients[node.localIndex(i)], shapeValues[i]);
+    return y;
+  }
+
+  const Basis* basis_;
+
+  // The local coefficients of all saved elements, stored consecutively
+  // starting at the offset given for the id of the element
+  std::vector<Field> values_;
+  std::unordered_map<IdType, size_type> offsets_;
+};
+
+
+
+} // end namespace Functions
+} // end namespace Dune
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_COEFFICIENTTRANSFER_HH
@@ -0,0 +1,329 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_DGINVERSEMASSOPERATOR_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_DGINVERSEMASSOPERATOR_HH
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/typeindex.hh>
+
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <dune/functions/backends/istlvectorbackend.hh>
+
+namespace Dune {
+namespace Functions {
+
+
+
+/**
+ * \brief Application of the inverse mass matrix of a discontinuous scalar basis
+ *
+ * \ingroup FunctionSpaceBasesUtilities
+ *
+ * For bases without inter-element coupling, like `LagrangeDGBasis`, the mass matrix
+ * is block-diagonal with one block per element. This operator precomputes the
+ * inverses of these blocks and applies them to coefficient vectors.
+ *
+ * For an element with affine geometry the element mass matrix is the mass matrix of
+ * the reference element scaled by the constant integration element. Hence only a
+ * single inverse reference mass matrix per geometry type is stored for all affine
+ * elements, together with one scaling factor per element. These elements are processed
+ * in batches: The coefficients of several elements are gathered into a dense block,
+ * multiplied by the shared inverse, and scattered back. If the reference mass matrix
+ * is diagonal, e.g. for the orthonormal shape functions of `ModalDGBasis`, the
+ * inverse reduces to a scaling of each coefficient. Elements with non-affine
+ * geometry store their own inverse mass matrix.
+ *
+ * If the DOFs of each element have the two-level indices (e,i) with i=0,...,n-1,
+ * like for the `BlockedLexicographic` layout of `LagrangeDGBasis`, the operator
+ * stores the block index e per element and accesses the vector once per element to
+ * obtain its block. Otherwise it stores the global indices of all DOFs. Hence it can
+ * be applied to any vector type supported by `istlVectorBackend()`. It has to be
+ * recreated if the basis changes.
+ *
+ * \tparam B Type of a global basis with a leaf tree and scalar shape functions
+ * \tparam F Field type of the stored matrices
+ */
+template<class B, class F = double>
+class DGInverseMassOperator
+{
+  using Basis = B;
+  using Field = F;
+  using GridView = typename Basis::GridView;
+  using MultiIndex = typename Basis::MultiIndex;
+  using size_type = std::size_t;
+
+  static constexpr int dim = GridView::dimension;
+
+  // An element whose DOFs start at position first in dofIndices_,
+  // or whose DOFs form the vector block with index first if blocked_
+  struct Block
+  {
+    size_type first;
+    Field scale;
+  };
+
+  // An element with its own inverse mass matrix
+  struct NonAffineBlock
+  {
+    size_type first;
+    DynamicMatrix<Field> inverse;
+  };
+
+public:
+
+  /**
+   * \brief Precompute the inverse element mass matrices
+   *
+   * \param basis A global basis without inter-element coupling
+   * \param batchSize Number of affine elements processed at once in apply()
+   */
+  DGInverseMassOperator(const B& basis, std::size_t batchSize = 16) :
+    batchSize_(std::max<size_type>(batchSize, 1)),
+    referenceInverses_(LocalGeometryTypeIndex::size(dim)),
+    diagonal_(LocalGeometryTypeIndex::size(dim), false),
+    affineBlocks_(LocalGeometryTypeIndex::size(dim))
+  {
+    static_assert(Basis::LocalView::Tree::isLeaf, "DGInverseMassOperator requires a basis with a leaf tree");
+
+    auto localView = basis.localView();
+    dofIndices_.reserve(basis.dimension());
+    blocked_ = (Basis::PreBasis::maxMultiIndexSize == 2);
+    for (const auto& element : elements(basis.gridView()))
+    {
+      localView.bind(element);
+      const auto& node = localView.tree();
+      const auto& geometry = element.geometry();
+
+      size_type firstDOF = dofIndices_.size();
+      for (size_type i = 0; i < node.size(); ++i)
+      {
+        const auto& index = localView.index(node.localIndex(i));
+        dofIndices_.push_back(index);
+        blocked_ = blocked_ and (index.size() == 2) and (index[0] == dofIndices_[firstDOF][0]) and (index[1] == i);
+      }
+
+      if (geometry.affine())
+      {
+        auto typeIndex = LocalGeometryTypeIndex::index(element.type());
+        auto& referenceInverse = referenceInverses_[typeIndex];
+        if (referenceInverse.N() == 0)
+        {
+          // The mass matrix of the reference element
+          referenceInverse = massMatrix(node.finiteElement().localBasis(), element.type(), 0, [](const auto&) { return 1; });
+          diagonal_[typeIndex] = isDiagonal(referenceInverse);
+          referenceInverse.invert();
+        }
+        affineBlocks_[typeIndex].push_back({firstDOF, Field(1)/geometry.integrationElement(referenceElement(geometry).position(0,0))});
+      }
+      else
+      {
+        auto inverse = massMatrix(node.finiteElement().localBasis(), element.type(), dim, [&](const auto& x) {
+          return geometry.integrationElement(x);
+        });
+        inverse.invert();
+        nonAffineBlocks_.push_back({firstDOF, std::move(inverse)});
+      }
+    }
+
+    // Replace the DOF positions by the block indices
+    if (blocked_)
+    {
+      for (auto& blocks : affineBlocks_)
+        for (auto& block : blocks)
+          block.first = dofIndices_[block.first][0];
+      for (auto& block : nonAffineBlocks_)
+        block.first = dofIndices_[block.first][0];
+      dofIndices_.clear();
+      dofIndices_.shrink_to_fit();
+    }
+  }
+
+  /**
+   * \brief Compute y = M^{-1} x with the mass matrix M
+   *
+   * \param x Coefficient vector
+   * \param y Result vector, which must already have the size of the basis
+   */
+  template<class VectorIn, class VectorOut>
+  void apply(const VectorIn& x, VectorOut& y) const
+  {
+    if constexpr (Basis::PreBasis::maxMultiIndexSize == 2)
+    {
+      if (blocked_)
+      {
+        // Resolve the block of an element once and access its entries directly
+        auto blockAccess = [](auto& v) {
+          return [&v](size_type block) {
+            auto* entries = &v[block];
+            return [entries](size_type i) -> decltype(auto) {
+              return Dune::Functions::istlVectorBackend(*entries)[std::array<size_type,1>{{i}}];
+            };
+          };
+        };
+        applyBlocks(blockAccess(x), blockAccess(y));
+        return;
+      }
+    }
+
+    auto xBackend = Dune::Functions::istlVectorBackend(x);
+    auto yBackend = Dune::Functions::istlVectorBackend(y);
+    auto indexAccess = [&](auto& backend) {
+      return [&](size_type firstDOF) {
+        return [&backend, indices = dofIndices_.data() + firstDOF](size_type i) -> decltype(auto) {
+          return backend[indices[i]];
+        };
+      };
+    };
+    applyBlocks(indexAccess(xBackend), indexAccess(yBackend));
+  }
+
+  //! Number of elements sharing the inverse reference mass matrix of their geometry type
+  size_type affineElements() const
+  {
+    size_type count = 0;
+    for (const auto& blocks : affineBlocks_)
+      count += blocks.size();
+    return count;
+  }
+
+  //! Number of elements with their own inverse mass matrix
+  size_type nonAffineElements() const
+  {
+    return nonAffineBlocks_.size();
+  }
+
+private:
+
+  // Apply the inverse mass matrix. For the first entry of a block,
+  // xAccess and yAccess return functions accessing the i-th DOF of
+  // the element.
+  template<class XAccess, class YAccess>
+  void applyBlocks(const XAccess& xAccess, const YAccess& yAccess) const
+  {
+    // Gather the coefficients of a batch of elements into the columns of
+    // a dense matrix, multiply it by the shared inverse, and scatter the
+    // scaled result. The inner loops run over the elements of the batch.
+    std::vector<Field> xBatch, yBatch;
+    for (size_type typeIndex = 0; typeIndex < affineBlocks_.size(); ++typeIndex)
+    {
+      const auto& blocks = affineBlocks_[typeIndex];
+      const auto& inverse = referenceInverses_[typeIndex];
+      const size_type n = inverse.N();
+      if (diagonal_[typeIndex])
+      {
+        for (const auto& block : blocks)
+        {
+          auto xLocal = xAccess(block.first);
+          auto yLocal = yAccess(block.first);
+          for (size_type i = 0; i < n; ++i)
+            yLocal(i) = block.scale * inverse[i][i] * xLocal(i);
+        }
+        continue;
+      }
+      for (size_type begin = 0; begin < blocks.size(); begin += batchSize_)
+      {
+        const size_type batch = std::min(batchSize_, blocks.size() - begin);
+        xBatch.resize(n*batch);
+        yBatch.assign(n*batch, Field(0));
+        for (size_type b = 0; b < batch; ++b)
+        {
+          auto xLocal = xAccess(blocks[begin+b].first);
+          for (size_type j = 0; j < n; ++j)
+            xBatch[j*batch + b] = xLocal(j);
+        }
+        for (size_type i = 0; i < n; ++i)
+          for (size_type j = 0; j < n; ++j)
+          {
+            const Field a = inverse[i][j];
+            for (size_type b = 0; b < batch; ++b)
+              yBatch[i*batch + b] += a * xBatch[j*batch + b];
+          }
+        for (size_type b = 0; b < batch; ++b)
+        {
+          auto yLocal = yAccess(blocks[begin+b].first);
+          for (size_type i = 0; i < n; ++i)
+            yLocal(i) = blocks[begin+b].scale * yBatch[i*batch + b];
+        }
+      }
+    }
+
+    std::vector<Field> xValues;
+    for (const auto& block : nonAffineBlocks_)
+    {
+      const size_type n = block.inverse.N();
+      auto xLocal = xAccess(block.first);
+      auto yLocal = yAccess(block.first);
+      xValues.resize(n);
+      for (size_type j = 0; j < n; ++j)
+        xValues[j] = xLocal(j);
+      for (size_type i = 0; i < n; ++i)
+      {
+        Field yi = 0;
+        for (size_type j = 0; j < n; ++j)
+          yi += block.inverse[i][j] * xValues[j];
+        yLocal(i) = yi;
+      }
+    }
+  }
+
+  // Compute the local mass matrix with respect to the given weight function. The
+  // additional quadrature order accounts for the polynomial degree of the weight.
+  template<class LocalBasis, class Weight>
+  static DynamicMatrix<Field> massMatrix(const LocalBasis& localBasis, const GeometryType& type, int weightOrder, Weight&& weight)
+  {
+    using Range = typename LocalBasis::Traits::RangeType;
+    const size_type n = localBasis.size();
+    DynamicMatrix<Field> matrix(n, n, Field(0));
+    std::vector<Range> values;
+    const auto& quadRule = QuadratureRules<typename GridView::ctype, dim>::rule(type, 2*localBasis.order() + weightOrder);
+    for (const auto& quadPoint : quadRule)
+    {
+      localBasis.evaluateFunction(quadPoint.position(), values);
+      auto factor = quadPoint.weight() * weight(quadPoint.position());
+      for (size_type i = 0; i < n; ++i)
+        for (size_type j = 0; j < n; ++j)
+          matrix[i][j] += values[i][0] * values[j][0] * factor;
+    }
+    return matrix;
+  }
+
+  // Check if the off-diagonal entries vanish up to rounding errors
+  static bool isDiagonal(const DynamicMatrix<Field>& matrix)
+  {
+    using std::abs;
+    Field maxDiagonal = 0;
+    for (size_type i = 0; i < matrix.N(); ++i)
+      maxDiagonal = std::max<Field>(maxDiagonal, abs(matrix[i][i]));
+    for (size_type i = 0; i < matrix.N(); ++i)
+      for (size_type j = 0; j < matrix.M(); ++j)
+        if (i != j and abs(matrix[i][j]) > 1e-12*maxDiagonal)
+          return false;
+    return true;
+  }
+
+  size_type batchSize_;
+  bool blocked_;
+  std::vector<MultiIndex> dofIndices_;
+  std::vector<DynamicMatrix<Field>> referenceInverses_;
+  std::vector<bool> diagonal_;
+  std::vector<std::vector<Block>> affineBlocks_;
+  std::vector<NonAffineBlock> nonAffineBlocks_;
+};
+
+
+
+} // end namespace Functions
+} // end namespace Dune
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_DGINVERSEMASSOPERATOR_HH
@@ -0,0 +1,214 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_ELEMENTELIMINATION_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_ELEMENTELIMINATION_HH
+
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+
+#include <dune/functions/backends/istlvectorbackend.hh>
+
+namespace Dune {
+namespace Functions {
+namespace Impl {
+
+  /**
+   * \brief Element-by-element elimination of DOFs from a linear system
+   *
+   * This implements the common part of `StaticCondensation` and `Hybridization`.
+   * On each element the DOFs are split into the eliminated ones E and the kept
+   * ones K. The kept DOFs are numbered by the indices of the condensed system,
+   * the eliminated ones by the global indices of a basis. For the element system
+   * \f[
+   *   \begin{pmatrix} A_{EE} & A_{EK} \\ A_{KE} & A_{KK} \end{pmatrix}
+   *   \begin{pmatrix} u_E \\ u_K \end{pmatrix}
+   *   = \begin{pmatrix} b_E \\ b_K \end{pmatrix}
+   * \f]
+   * each element contributes the Schur complement
+   * \f$ S = A_{KK} - A_{KE} A_{EE}^{-1} A_{EK} \f$ and the vector
+   * \f$ g = b_K - A_{KE} A_{EE}^{-1} b_E \f$ to the condensed system. The eliminated
+   * DOFs are recovered by \f$ u_E = A_{EE}^{-1} b_E - A_{EE}^{-1} A_{EK} u_K \f$.
+   *
+   * \tparam MI Type of the global indices of the eliminated DOFs
+   * \tparam F Field type of the element matrices
+   */
+  template<class MI, class F>
+  class ElementElimination
+  {
+    using MultiIndex = MI;
+    using Field = F;
+    using size_type = std::size_t;
+
+    // The DOFs of an element are stored at [firstKept, firstKept+keptSize) in keptIndices_
+    // and [firstEliminated, firstEliminated+eliminatedSize) in eliminatedIndices_.
+    struct ElementData
+    {
+      size_type firstKept;
+      size_type keptSize;
+      size_type firstEliminated;
+      size_type eliminatedSize;
+      DynamicMatrix<Field> schurComplement;   // A_KK - A_KE A_EE^{-1} A_EK
+      DynamicVector<Field> schurRhs;          // b_K - A_KE A_EE^{-1} b_E
+      DynamicMatrix<Field> recoveryOperator;  // A_EE^{-1} A_EK
+      DynamicVector<Field> recoveryRhs;       // A_EE^{-1} b_E
+    };
+
+  public:
+
+    //! Add the index of a kept DOF of the current element in the condensed system
+    void addKept(size_type index)
+    {
+      keptIndices_.push_back(index);
+    }
+
+    //! Add the global index of an eliminated DOF of the current element
+    void addEliminated(const MultiIndex& index)
+    {
+      eliminatedIndices_.push_back(index);
+    }
+
+    //! Finish the current element. Its DOFs are those added since the last call.
+    void finishElement()
+    {
+      size_type firstKept = elementData_.empty() ? 0 : elementData_.back().firstKept + elementData_.back().keptSize;
+      size_type firstEliminated = elementData_.empty() ? 0 : elementData_.back().firstEliminated + elementData_.back().eliminatedSize;
+      elementData_.push_back({firstKept, keptIndices_.size() - firstKept, firstEliminated, eliminatedIndices_.size() - firstEliminated, {}, {}, {}, {}});
+    }
+
+    //! Number of elements
+    size_type size() const
+    {
+      return elementData_.size();
+    }
+
+    //! Number of eliminated DOFs of all elements
+    size_type eliminatedSize() const
+    {
+      return eliminatedIndices_.size();
+    }
+
+    //! Position of the first kept DOF of element e among the kept DOFs of all elements
+    size_type firstKept(size_type e) const
+    {
+      return elementData_[e].firstKept;
+    }
+
+    //! Position of the first eliminated DOF of element e among the eliminated DOFs of all elements
+    size_type firstEliminated(size_type e) const
+    {
+      return elementData_[e].firstEliminated;
+    }
+
+    /**
+     * \brief Compute the contributions of element e to the condensed system
+     *
+     * The blocks of the element system are given by callbacks taking the local
+     * positions of the DOFs among the eliminated and kept DOFs of the element, i.e.,
+     * `aEE(i,j)` is the entry of \f$ A_{EE} \f$ for the i-th and j-th eliminated DOF.
+     * Elements only write their own data. Hence different elements can be
+     * condensed concurrently.
+     */
+    template<class AEE, class AEK, class AKE, class AKK, class BE, class BK>
+    void condenseElement(size_type e, const AEE& aEE, const AEK& aEK, const AKE& aKE, const AKK& aKK, const BE& bE, const BK& bK)
+    {
+      auto& data = elementData_[e];
+      const size_type nK = data.keptSize;
+      const size_type nE = data.eliminatedSize;
+
+      data.schurComplement.resize(nK, nK);
+      data.schurRhs.resize(nK);
+      for (size_type i = 0; i < nK; ++i)
+      {
+        data.schurRhs[i] = bK(i);
+        for (size_type j = 0; j < nK; ++j)
+          data.schurComplement[i][j] = aKK(i, j);
+      }
+
+      data.recoveryOperator.resize(nE, nK);
+      data.recoveryRhs.resize(nE);
+      if (nE == 0)
+        return;
+
+      DynamicMatrix<Field> inverse(nE, nE);
+      for (size_type i = 0; i < nE; ++i)
+        for (size_type j = 0; j < nE; ++j)
+          inverse[i][j] = aEE(i, j);
+      inverse.invert();
+
+      for (size_type i = 0; i < nE; ++i)
+      {
+        data.recoveryRhs[i] = 0;
+        for (size_type l = 0; l < nE; ++l)
+          data.recoveryRhs[i] += inverse[i][l] * bE(l);
+        for (size_type j = 0; j < nK; ++j)
+        {
+          data.recoveryOperator[i][j] = 0;
+          for (size_type l = 0; l < nE; ++l)
+            data.recoveryOperator[i][j] += inverse[i][l] * aEK(l, j);
+        }
+      }
+
+      for (size_type i = 0; i < nK; ++i)
+        for (size_type l = 0; l < nE; ++l)
+        {
+          const Field a = aKE(i, l);
+          data.schurRhs[i] -= a * data.recoveryRhs[l];
+          for (size_type j = 0; j < nK; ++j)
+            data.schurComplement[i][j] -= a * data.recoveryOperator[l][j];
+        }
+    }
+
+    //! Fill the sparsity pattern of the condensed system of given size
+    template<class Pattern>
+    void pattern(Pattern& pattern, size_type size) const
+    {
+      pattern.resize(size, size);
+      for (const auto& data : elementData_)
+        for (size_type i = 0; i < data.keptSize; ++i)
+          for (size_type j = 0; j < data.keptSize; ++j)
+            pattern.add(keptIndices_[data.firstKept + i], keptIndices_[data.firstKept + j]);
+    }
+
+    //! Add the element contributions to the condensed system
+    template<class Matrix, class Vector>
+    void assemble(Matrix& matrix, Vector& rhs) const
+    {
+      for (const auto& data : elementData_)
+        for (size_type i = 0; i < data.keptSize; ++i)
+        {
+          auto row = keptIndices_[data.firstKept + i];
+          rhs[row] += data.schurRhs[i];
+          for (size_type j = 0; j < data.keptSize; ++j)
+            matrix[row][keptIndices_[data.firstKept + j]] += data.schurComplement[i][j];
+        }
+    }
+
+    //! Compute the eliminated DOFs from the solution of the condensed system
+    template<class KeptVector, class Vector>
+    void recover(const KeptVector& keptSolution, Vector& x) const
+    {
+      auto xBackend = Dune::Functions::istlVectorBackend(x);
+      for (const auto& data : elementData_)
+        for (size_type i = 0; i < data.eliminatedSize; ++i)
+        {
+          Field xi = data.recoveryRhs[i];
+          for (size_type j = 0; j < data.keptSize; ++j)
+            xi -= data.recoveryOperator[i][j] * keptSolution[keptIndices_[data.firstKept + j]];
+          xBackend[eliminatedIndices_[data.firstEliminated + i]] = xi;
+        }
+    }
+
+  private:
+    std::vector<ElementData> elementData_;
+    std::vector<size_type> keptIndices_;
+    std::vector<MultiIndex> eliminatedIndices_;
+  };
+
+} // end namespace Impl
+} // end namespace Functions
+} // end namespace Dune
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_ELEMENTELIMINATION_HH
@@ -0,0 +1,189 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_ELEMENTTRANSFEROPERATOR_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_ELEMENTTRANSFEROPERATOR_HH
+
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <dune/common/dynmatrix.hh>
+
+#include <dune/istl/matrixindexset.hh>
+
+#include <dune/functions/common/parallelfor.hh>
+
+namespace Dune {
+namespace Functions {
+namespace Impl {
+
+
+
+  /**
+   * \brief Prolongation P from a coarse to a fine basis assembled from local matrices
+   *
+   * For each fine element, the local matrix maps the coarse coefficients of
+   * the associated coarse element to the fine coefficients of the element.
+   * The local matrices are stored once and referred to by an index, such that
+   * elements with the same local matrix share it.
+   * Each fine DOF is written by a single element only, its owner, such that
+   * the element loops can be run in parallel. The restriction is \f$ P^T \f$.
+   *
+   * All indices are flat and vectors must provide `x[i]` access.
+   */
+  template<class F>
+  class ElementTransferOperator
+  {
+    using Field = F;
+    using size_type = std::size_t;
+
+    // The DOFs of an element are stored at firstCoarse in coarseIndices_
+    // and at firstFine in fineIndices_ and isOwner_.
+    struct ElementData
+    {
+      size_type matrixIndex;
+      size_type firstCoarse;
+      size_type firstFine;
+    };
+
+  public:
+
+    ElementTransferOperator(size_type coarseSize, size_type fineSize) :
+      coarseSize_(coarseSize),
+      fineSize_(fineSize),
+      visited_(fineSize, false)
+    {}
+
+    //! Store a new local matrix and return its index
+    size_type addLocalMatrix(DynamicMatrix<Field>&& localMatrix)
+    {
+      localMatrices_.push_back(std::move(localMatrix));
+      return localMatrices_.size() - 1;
+    }
+
+    const DynamicMatrix<Field>& localMatrix(size_type matrixIndex) const
+    {
+      return localMatrices_[matrixIndex];
+    }
+
+    //! Add a fine element with the flat indices of its coarse and fine DOFs
+    template<class CoarseIndices, class FineIndices>
+    void addElement(size_type matrixIndex, const CoarseIndices& coarseIndices, const FineIndices& fineIndices)
+    {
+      elementData_.push_back({matrixIndex, coarseIndices_.size(), fineIndices_.size()});
+      for (auto index : coarseIndices)
+        coarseIndices_.push_back(index);
+      for (auto index : fineIndices)
+      {
+        fineIndices_.push_back(index);
+        isOwner_.push_back(not visited_[index]);
+        visited_[index] = true;
+      }
+    }
+
+    template<class CoarseVector, class FineVector>
+    void applyProlongation(const CoarseVector& coarse, FineVector& fine, std::size_t threads) const
+    {
+      Impl::parallelForRanges(elementData_.size(), threads, [&](size_type begin, size_type end) {
+        std::vector<Field> localCoarse;
+        for (size_type e = begin; e < end; ++e)
+        {
+          const auto& data = elementData_[e];
+          const auto& localMatrix = localMatrices_[data.matrixIndex];
+          localCoarse.resize(localMatrix.M());
+          for (size_type j = 0; j < localMatrix.M(); ++j)
+            localCoarse[j] = coarse[coarseIndices_[data.firstCoarse + j]];
+          for (size_type i = 0; i < localMatrix.N(); ++i)
+          {
+            if (not isOwner_[data.firstFine + i])
+              continue;
+            Field value = 0;
+            for (size_type j = 0; j < localMatrix.M(); ++j)
+              value += localMatrix[i][j] * localCoarse[j];
+            fine[fineIndices_[data.firstFine + i]] = value;
+          }
+        }
+      });
+    }
+
+    // Each thread accumulates into its own buffer of the size of
+    // the coarse basis. The buffers are summed up afterwards.
+    template<class FineVector, class CoarseVector>
+    void applyRestriction(const FineVector& fine, CoarseVector& coarse, std::size_t threads) const
+    {
+      threads = Impl::parallelRangeCount(elementData_.size(), threads);
+      std::vector<std::vector<Field>> buffers(threads, std::vector<Field>(coarseSize_, Field(0)));
+      Impl::parallelForThreadRanges(elementData_.size(), threads, [&](size_type thread, size_type begin, size_type end) {
+        auto& buffer = buffers[thread];
+        for (size_type e = begin; e < end; ++e)
+        {
+          const auto& data = elementData_[e];
+          const auto& localMatrix = localMatrices_[data.matrixIndex];
+          for (size_type i = 0; i < localMatrix.N(); ++i)
+          {
+            if (not isOwner_[data.firstFine + i])
+              continue;
+            const Field value = fine[fineIndices_[data.firstFine + i]];
+            for (size_type j = 0; j < localMatrix.M(); ++j)
+              buffer[coarseIndices_[data.firstCoarse + j]] += localMatrix[i][j] * value;
+          }
+        }
+      });
+      for (size_type j = 0; j < coarseSize_; ++j)
+      {
+        coarse[j] = buffers[0][j];
+        for (size_type t = 1; t < threads; ++t)
+          coarse[j] += buffers[t][j];
+      }
+    }
+
+    template<class Matrix>
+    void assembleProlongationMatrix(Matrix& matrix, Field tolerance) const
+    {
+      using std::abs;
+      MatrixIndexSet pattern(fineSize_, coarseSize_);
+      forEachEntry([&](size_type row, size_type col, const Field& value) {
+        if (abs(value) > tolerance)
+          pattern.add(row, col);
+      });
+      pattern.exportIdx(matrix);
+      matrix = 0;
+      forEachEntry([&](size_type row, size_type col, const Field& value) {
+        if (abs(value) > tolerance)
+          matrix[row][col] = value;
+      });
+    }
+
+  private:
+
+    template<class Callback>
+    void forEachEntry(Callback&& callback) const
+    {
+      for (const auto& data : elementData_)
+      {
+        const auto& localMatrix = localMatrices_[data.matrixIndex];
+        for (size_type i = 0; i < localMatrix.N(); ++i)
+          if (isOwner_[data.firstFine + i])
+            for (size_type j = 0; j < localMatrix.M(); ++j)
+              callback(fineIndices_[data.firstFine + i], coarseIndices_[data.firstCoarse + j], localMatrix[i][j]);
+      }
+    }
+
+    size_type coarseSize_;
+    size_type fineSize_;
+    std::vector<DynamicMatrix<Field>> localMatrices_;
+    std::vector<ElementData> elementData_;
+    std::vector<size_type> coarseIndices_;
+    std::vector<size_type> fineIndices_;
+    std::vector<bool> isOwner_;
+    std::vector<bool> visited_;
+  };
+
+
+
+} // end namespace Impl
+} // end namespace Functions
+} // end namespace Dune
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_ELEMENTTRANSFEROPERATOR_HH
@@ -0,0 +1,305 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_FACETLAGRANGEBASIS_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_FACETLAGRANGEBASIS_HH
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/math.hh>
+
+#include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/type.hh>
+#include <dune/geometry/typeindex.hh>
+
+#include <dune/localfunctions/common/localkey.hh>
+#include <dune/localfunctions/lagrange/lagrangelfecache.hh>
+
+#include <dune/functions/functionspacebases/nodes.hh>
+#include <dune/functions/functionspacebases/defaultglobalbasis.hh>
+#include <dune/functions/functionspacebases/leafprebasismappermixin.hh>
+
+namespace Dune {
+namespace Functions {
+
+namespace Impl {
+
+  /**
+   * \brief The facet finite elements of all facets of an element
+   *
+   * This is not a local finite element in the sense of dune-localfunctions,
+   * because the shape functions only live on the facets. Instead it provides
+   * the (dim-1)-dimensional Lagrange finite element of each facet together
+   * with the offset of its shape functions. The local coefficients associate
+   * the shape functions of facet f with the sub-entity (f,1).
+   */
+  template<class D, class R, int dim, int k>
+  class FacetLagrangeFiniteElement
+  {
+    using FacetFiniteElementCache = LagrangeLocalFiniteElementCache<D,R,dim-1,k>;
+
+  public:
+
+    using FacetFiniteElement = typename FacetFiniteElementCache::FiniteElementType;
+    using size_type = std::size_t;
+
+    class LocalCoefficients
+    {
+    public:
+      std::size_t size() const
+      {
+        return localKeys_.size();
+      }
+
+      const LocalKey& localKey(std::size_t i) const
+      {
+        return localKeys_[i];
+      }
+
+    private:
+      friend class FacetLagrangeFiniteElement;
+      std::vector<LocalKey> localKeys_;
+    };
+
+    FacetLagrangeFiniteElement() = default;
+
+    FacetLagrangeFiniteElement(GeometryType type) :
+      type_(type)
+    {
+      FacetFiniteElementCache cache;
+      auto refElement = referenceElement<D,dim>(type);
+      facetOffsets_.push_back(0);
+      for (int f = 0; f < refElement.size(1); ++f)
+      {
+        facetFiniteElements_.push_back(cache.get(refElement.type(f, 1)));
+        const auto& facetFiniteElement = facetFiniteElements_.back();
+        for (std::size_t i = 0; i < facetFiniteElement.size(); ++i)
+          localCoefficients_.localKeys_.emplace_back(f, 1, i);
+        facetOffsets_.push_back(facetOffsets_.back() + facetFiniteElement.size());
+      }
+    }
+
+    //! The finite element on the given facet, in the coordinates of the facet entity
+    const FacetFiniteElement& facetFiniteElement(size_type facet) const
+    {
+      return facetFiniteElements_[facet];
+    }
+
+    //! Index of the first shape function of the given facet
+    size_type facetOffset(size_type facet) const
+    {
+      return facetOffsets_[facet];
+    }
+
+    const LocalCoefficients& localCoefficients() const
+    {
+      return localCoefficients_;
+    }
+
+    size_type size() const
+    {
+      return localCoefficients_.size();
+    }
+
+    GeometryType type() const
+    {
+      return type_;
+    }
+
+  private:
+    GeometryType type_;
+    std::vector<FacetFiniteElement> facetFiniteElements_;
+    std::vector<size_type> facetOffsets_;
+    LocalCoefficients localCoefficients_;
+  };
+
+} // end namespace Impl
+
+
+
+// *****************************************************************************
+// This is the reusable part of the basis. It contains
+//
+//   FacetLagrangePreBasis
+//   FacetLagrangeNode
+//
+// The pre-basis allows to create the others and is the owner of possible shared
+// state. These components do _not_ depend on the global basis and local view
+// and can be used without a global basis.
+// *****************************************************************************
+
+template<typename GV, int k, typename R>
+class FacetLagrangeNode;
+
+/**
+ * \brief A pre-basis for piecewise polynomials on the facets of a grid
+ *
+ * \ingroup FunctionSpaceBasesImplementations
+ *
+ * The basis functions are the Lagrange basis functions of order k on each
+ * codim-1 entity. They are discontinuous across the boundaries of the facets.
+ * A typical application is the Lagrange multiplier for the normal continuity
+ * of a broken `RaviartThomasBasis` or `BrezziDouglasMariniBasis` in hybridized
+ * mixed methods.
+ *
+ * The shape functions of a facet are defined in the coordinates of
+ * the facet entity, i.e., `element.template subEntity<1>(f).geometry()`,
+ * such that they coincide for both elements sharing the facet.
+ * Since they do not live on the elements, the tree node does not
+ * provide a usual local finite element, see `Impl::FacetLagrangeFiniteElement`.
+ *
+ * \tparam GV  The grid view that the FE basis is defined on
+ * \tparam k   The polynomial order of the ansatz functions on the facets
+ * \tparam R   Range field-type used for shape function values
+ */
+template<typename GV, int k, typename R = double>
+class FacetLagrangePreBasis :
+  public LeafPreBasisMapperMixin<GV>
+{
+  using Base = LeafPreBasisMapperMixin<GV>;
+  static const int dim = GV::dimension;
+
+  static_assert(dim >= 2, "FacetLagrangePreBasis requires a grid of dimension at least two");
+
+  static std::size_t layout(GeometryType type, int gridDim)
+  {
+    if (type.dim() != gridDim-1)
+      return 0;
+    return type.isSimplex() ? Dune::binomial(k+dim-1, dim-1) : Dune::power(k+1, dim-1);
+  }
+
+public:
+
+  using GridView = GV;
+  using Node = FacetLagrangeNode<GV, k, R>;
+  using FiniteElement = typename Node::FiniteElement;
+
+  FacetLagrangePreBasis(const GridView& gv) :
+    Base(gv, layout)
+  {
+    initializeFiniteElements();
+  }
+
+  void update(const GridView& gv)
+  {
+    Base::update(gv);
+    initializeFiniteElements();
+  }
+
+  Node makeNode() const
+  {
+    return Node{&finiteElements_};
+  }
+
+private:
+
+  void initializeFiniteElements()
+  {
+    finiteElements_.resize(LocalGeometryTypeIndex::size(dim));
+    for (auto type : this->gridView_.indexSet().types(0))
+    {
+      if (not type.isSimplex() and not type.isCube())
+        DUNE_THROW(Dune::NotImplemented, "FacetLagrangePreBasis is only implemented for simplex and cube elements");
+      finiteElements_[LocalGeometryTypeIndex::index(type)] = FiniteElement(type);
+    }
+  }
+
+  std::vector<FiniteElement> finiteElements_;
+};
+
+
+
+template<typename GV, int k, typename R>
+class FacetLagrangeNode :
+  public LeafBasisNode
+{
+  static const int dim = GV::dimension;
+
+public:
+
+  using size_type = std::size_t;
+  using Element = typename GV::template Codim<0>::Entity;
+  using FiniteElement = Impl::FacetLagrangeFiniteElement<typename GV::ctype, R, dim, k>;
+
+  FacetLagrangeNode(const std::vector<FiniteElement>* finiteElements) :
+    finiteElements_(finiteElements),
+    finiteElement_(nullptr),
+    element_(nullptr)
+  {}
+
+  //! Return current element, throw if unbound
+  const Element& element() const
+  {
+    return *element_;
+  }
+
+  //! Return the facet finite elements for the element we are bound to
+  const FiniteElement& finiteElement() const
+  {
+    return *finiteElement_;
+  }
+
+  //! Bind to element.
+  void bind(const Element& e)
+  {
+    element_ = &e;
+    finiteElement_ = &(*finiteElements_)[LocalGeometryTypeIndex::index(e.type())];
+    this->setSize(finiteElement_->size());
+  }
+
+  //! Bind to the element the given node is bound to
+  void bindLike(const FacetLagrangeNode& other)
+  {
+    element_ = other.element_;
+    finiteElement_ = other.finiteElement_;
+    this->setSize(other.size());
+  }
+
+protected:
+  const std::vector<FiniteElement>* finiteElements_;
+  const FiniteElement* finiteElement_;
+  const Element* element_;
+};
+
+
+
+namespace BasisFactory {
+
+/**
+ * \brief Create a pre-basis factory that can create a FacetLagrange pre-basis
+ *
+ * \ingroup FunctionSpaceBasesImplementations
+ *
+ * \tparam k   The polynomial order of the ansatz functions on the facets
+ * \tparam R   The range type of the local basis
+ */
+template<std::size_t k, typename R=double>
+auto facetLagrange()
+{
+  return [](const auto& gridView) {
+    return FacetLagrangePreBasis<std::decay_t<decltype(gridView)>, k, R>(gridView);
+  };
+}
+
+} // end namespace BasisFactory
+
+
+
+/** \brief Basis of piecewise polynomials of order k on the facets of a grid
+ *
+ * \ingroup FunctionSpaceBasesImplementations
+ *
+ * \tparam GV The GridView that the space is defined on
+ * \tparam k The order of the basis
+ * \tparam R The range type of the local basis
+ */
+template<typename GV, int k, typename R=double>
+using FacetLagrangeBasis = DefaultGlobalBasis<FacetLagrangePreBasis<GV, k, R> >;
+
+} // end namespace Functions
+} // end namespace Dune
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_FACETLAGRANGEBASIS_HH
@@ -0,0 +1,618 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_GAUSSLOBATTOLAGRANGEBASIS_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_GAUSSLOBATTOLAGRANGEBASIS_HH
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/math.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/common/localbasis.hh>
+#include <dune/localfunctions/common/localfiniteelementtraits.hh>
+#include <dune/localfunctions/common/localkey.hh>
+
+#include <dune/functions/functionspacebases/defaultglobalbasis.hh>
+#include <dune/functions/functionspacebases/lagrangebasis.hh>
+#include <dune/functions/functionspacebases/nodes.hh>
+
+
+namespace Dune {
+namespace Functions {
+
+namespace Impl {
+
+  // Compute the Gauss-Lobatto-Legendre points of the given order on [0,1] in
+  // ascending order together with the corresponding quadrature weights. The
+  // interior points are the roots of the derivative of the Legendre polynomial
+  // of the given order, which are found by Newton's method starting from the
+  // Chebyshev-Gauss-Lobatto points.
+  template<class D>
+  void gaussLobattoPoints(int order, std::vector<D>& points, std::vector<D>& weights)
+  {
+    points.resize(order+1);
+    weights.resize(order+1);
+    std::vector<double> P(order+1);
+    for (int j = 0; j <= order; ++j)
+    {
+      using std::cos;
+      double x = -cos(MathematicalConstants<double>::pi()*j/order);
+      for (int iteration = 0; iteration < 100; ++iteration)
+      {
+        P[0] = 1;
+        P[1] = x;
+        for (int n = 2; n <= order; ++n)
+          P[n] = ((2*n-1)*x*P[n-1] - (n-1)*P[n-2])/n;
+        double dx = (x*P[order] - P[order-1])/((order+1)*P[order]);
+        x -= dx;
+        if (std::abs(dx) < 1e-15)
+          break;
+      }
+      P[1] = x;
+      for (int n = 2; n <= order; ++n)
+        P[n] = ((2*n-1)*x*P[n-1] - (n-1)*P[n-2])/n;
+      points[j] = (1+x)/2;
+      weights[j] = 1/(order*(order+1)*P[order]*P[order]);
+    }
+  }
+
+
+
+  // The tensor product of the Gauss-Lobatto rules on the reference cube. The
+  // quadrature points are the Lagrange nodes of the GaussLobattoLagrangeLocalBasis,
+  // in the same order.
+  template<class D, int dim>
+  class GaussLobattoTensorQuadratureRule :
+    public QuadratureRule<D,dim>
+  {
+  public:
+    GaussLobattoTensorQuadratureRule(int order, const std::vector<D>& points, const std::vector<D>& weights) :
+      QuadratureRule<D,dim>(GeometryTypes::cube(dim), 2*order-1)
+    {
+      const std::size_t n = points.size();
+      for (std::size_t i = 0; i < power(n, std::size_t(dim)); ++i)
+      {
+        FieldVector<D,dim> x;
+        D weight = 1;
+        std::size_t r = i;
+        for (int j = 0; j < dim; ++j, r /= n)
+        {
+          x[j] = points[r % n];
+          weight *= weights[r % n];
+        }
+        this->push_back(QuadraturePoint<D,dim>(x, weight));
+      }
+    }
+  };
+
+
+
+  /**
+   * \brief Lagrange shape functions of order k on cubes with Gauss-Lobatto-Legendre nodes
+   *
+   * The nodes are the tensor products of the Gauss-Lobatto-Legendre points
+   * in lexicographic order with the first coordinate running fastest.
+   * The one-dimensional polynomials are evaluated by the barycentric formula,
+   * which needs O(k) operations for all values and derivatives at a point.
+   */
+  template<class D, class R, int dim, int k>
+  class GaussLobattoLagrangeLocalBasis
+  {
+    static constexpr std::size_t n = k+1;
+    using Values1d = std::array<R,n>;
+
+  public:
+    using Domain = FieldVector<D,dim>;
+    using Range = FieldVector<R,1>;
+    using Jacobian = FieldMatrix<R,1,dim>;
+    using Traits = LocalBasisTraits<D,dim,Domain,R,1,Range,Jacobian>;
+    using OrderArray = std::array<unsigned int,dim>;
+
+    GaussLobattoLagrangeLocalBasis(const std::vector<D>& points)
+    {
+      assert(points.size() == n);
+      std::copy(points.begin(), points.end(), points_.begin());
+      weights_.fill(1);
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        for (std::size_t j = 0; j < n; ++j)
+          if (i != j)
+            weights_[i] *= points_[i] - points_[j];
+        weights_[i] = 1/weights_[i];
+      }
+    }
+
+    std::size_t size() const
+    {
+      return power(n, std::size_t(dim));
+    }
+
+    void evaluateFunction(const Domain& x, std::vector<Range>& out) const
+    {
+      std::array<Values1d,dim> values;
+      for (int j = 0; j < dim; ++j)
+        evaluate1d(x[j], values[j], nullptr);
+      out.resize(size());
+      for (std::size_t i = 0; i < size(); ++i)
+      {
+        out[i] = 1;
+        for (int j = 0; j < dim; ++j)
+          out[i] *= values[j][multiIndex(i,j)];
+      }
+    }
+
+    void evaluateJacobian(const Domain& x, std::vector<Jacobian>& out) const
+    {
+      std::array<Values1d,dim> values, derivatives;
+      for (int j = 0; j < dim; ++j)
+        evaluate1d(x[j], values[j], &derivatives[j]);
+      out.resize(size());
+      for (std::size_t i = 0; i < size(); ++i)
+        for (int l = 0; l < dim; ++l)
+        {
+          out[i][0][l] = 1;
+          for (int j = 0; j < dim; ++j)
+            out[i][0][l] *= (j == l) ? derivatives[j][multiIndex(i,j)] : values[j][multiIndex(i,j)];
+        }
+    }
+
+    void partial(const OrderArray& order, const Domain& x, std::vector<Range>& out) const
+    {
+      if (*std::max_element(order.begin(), order.end()) > 1)
+        DUNE_THROW(RangeError, "partial() not implemented for given order");
+      std::array<Values1d,dim> values, derivatives;
+      for (int j = 0; j < dim; ++j)
+        evaluate1d(x[j], values[j], order[j] > 0 ? &derivatives[j] : nullptr);
+      out.resize(size());
+      for (std::size_t i = 0; i < size(); ++i)
+      {
+        out[i] = 1;
+        for (int j = 0; j < dim; ++j)
+          out[i] *= (order[j] > 0) ? derivatives[j][multiIndex(i,j)] : values[j][multiIndex(i,j)];
+      }
+    }
+
+    unsigned int order() const
+    {
+      return k;
+    }
+
+  private:
+
+    // Position of the node i in direction j
+    static std::size_t multiIndex(std::size_t i, int j)
+    {
+      for (int l = 0; l < j; ++l)
+        i /= n;
+      return i % n;
+    }
+
+    // Evaluate the values and, if requested, the first derivatives of the
+    // one-dimensional Lagrange polynomials at x.
+    //
+    // With the barycentric weights w_i and the node m closest to x, the
+    // polynomials are l_i(x) = w_i p(x) (x-x_m)/(x-x_i) for i!=m and
+    // l_m(x) = w_m p(x), where p is the product of the (x-x_j) for j!=m.
+    // Differentiating yields the derivatives in terms of the sum s of the
+    // 1/(x-x_j) for j!=m. Factoring out the closest node avoids dividing
+    // by zero in the nodes and the cancellation close to them.
+    void evaluate1d(D x, Values1d& values, Values1d* derivatives) const
+    {
+      std::size_t m = 0;
+      using std::abs;
+      for (std::size_t i = 1; i < n; ++i)
+        if (abs(x - points_[i]) < abs(x - points_[m]))
+          m = i;
+
+      R p = 1;
+      R s = 0;
+      for (std::size_t j = 0; j < n; ++j)
+        if (j != m)
+        {
+          p *= x - points_[j];
+          s += 1/R(x - points_[j]);
+        }
+
+      const R dm = x - points_[m];
+      for (std::size_t i = 0; i < n; ++i)
+      {
+        if (i == m)
+        {
+          values[i] = weights_[i]*p;
+          if (derivatives)
+            (*derivatives)[i] = values[i]*s;
+          continue;
+        }
+        const R di = x - points_[i];
+        const R q = weights_[i]*p/di;
+        values[i] = q*dm;
+        if (derivatives)
+          (*derivatives)[i] = q*(dm*(s - 1/di) + 1);
+      }
+    }
+
+    std::array<D,n> points_;
+    Values1d weights_;
+  };
+
+
+
+  // Associate the Lagrange nodes with the faces of the reference cube they are located in
+  template<int dim>
+  class GaussLobattoLagrangeLocalCoefficients
+  {
+  public:
+    GaussLobattoLagrangeLocalCoefficients(std::size_t order = 1)
+    {
+      const auto& refElement = ReferenceElements<double,dim>::cube();
+      std::array<std::vector<unsigned int>,dim+1> subEntitySizes;
+      for (int codim = 0; codim <= dim; ++codim)
+        subEntitySizes[codim].resize(refElement.size(codim), 0);
+
+      for (std::size_t i = 0; i < power(order+1, std::size_t(dim)); ++i)
+      {
+        // The sub-entity containing the node has the same center coordinates
+        // in the directions in which the node is located on the boundary
+        FieldVector<double,dim> center;
+        int codim = 0;
+        std::size_t r = i;
+        for (int j = 0; j < dim; ++j, r /= (order+1))
+        {
+          std::size_t a = r % (order+1);
+          center[j] = (a == 0) ? 0.0 : ((a == order) ? 1.0 : 0.5);
+          if (a == 0 or a == order)
+            ++codim;
+        }
+        for (int subEntity = 0; subEntity < refElement.size(codim); ++subEntity)
+          if ((refElement.position(subEntity, codim) - center).two_norm() < 1e-8)
+          {
+            localKeys_.emplace_back(subEntity, codim, subEntitySizes[codim][subEntity]++);
+            break;
+          }
+      }
+      assert(localKeys_.size() == power(order+1, std::size_t(dim)));
+    }
+
+    std::size_t size() const
+    {
+      return localKeys_.size();
+    }
+
+    const LocalKey& localKey(std::size_t i) const
+    {
+      assert(i < localKeys_.size());
+      return localKeys_[i];
+    }
+
+  private:
+    std::vector<LocalKey> localKeys_;
+  };
+
+
+
+  // Nodal interpolation in the Gauss-Lobatto-Legendre nodes
+  template<class D, int dim>
+  class GaussLobattoLagrangeLocalInterpolation
+  {
+  public:
+    GaussLobattoLagrangeLocalInterpolation(const QuadratureRule<D,dim>& nodes)
+    {
+      for (const auto& node : nodes)
+        nodes_.push_back(node.position());
+    }
+
+    template<class F, class C>
+    void interpolate(const F& f, std::vector<C>& out) const
+    {
+      out.resize(nodes_.size());
+      for (std::size_t i = 0; i < nodes_.size(); ++i)
+        out[i] = f(nodes_[i]);
+    }
+
+  private:
+    std::vector<FieldVector<D,dim>> nodes_;
+  };
+
+
+
+  /**
+   * \brief Local finite element of order k on cubes with Gauss-Lobatto-Legendre nodes
+   *
+   * Besides the usual interface this provides the collocated quadrature rule,
+   * whose points are the Lagrange nodes.
+   */
+  template<class D, class R, int dim, int k>
+  class GaussLobattoLagrangeLocalFiniteElement
+  {
+    static_assert(k > 0, "Gauss-Lobatto-Legendre nodes require an order of at least 1");
+
+    using LocalBasis = GaussLobattoLagrangeLocalBasis<D,R,dim,k>;
+    using LocalCoefficients = GaussLobattoLagrangeLocalCoefficients<dim>;
+    using LocalInterpolation = GaussLobattoLagrangeLocalInterpolation<D,dim>;
+
+    static std::vector<D> computePoints(std::vector<D>& weights)
+    {
+      std::vector<D> points;
+      gaussLobattoPoints(k, points, weights);
+      return points;
+    }
+
+  public:
+    using Traits = LocalFiniteElementTraits<LocalBasis,LocalCoefficients,LocalInterpolation>;
+
+    GaussLobattoLagrangeLocalFiniteElement() :
+      points_(computePoints(weights_)),
+      quadratureRule_(k, points_, weights_),
+      localBasis_(points_),
+      localCoefficients_(k),
+      localInterpolation_(quadratureRule_)
+    {}
+
+    const LocalBasis& localBasis() const
+    {
+      return localBasis_;
+    }
+
+    const LocalCoefficients& localCoefficients() const
+    {
+      return localCoefficients_;
+    }
+
+    const LocalInterpolation& localInterpolation() const
+    {
+      return localInterpolation_;
+    }
+
+    std::size_t size() const
+    {
+      return localBasis_.size();
+    }
+
+    GeometryType type() const
+    {
+      return GeometryTypes::cube(dim);
+    }
+
+    /**
+     * \brief The quadrature rule collocated with the Lagrange nodes
+     *
+     * The i-th quadrature point is the i-th Lagrange node. Hence the shape
+     * functions evaluated at the quadrature points form the identity and the
+     * mass matrix computed with this rule is diagonal. The rule is exact
+     * for polynomials of order 2k-1.
+     */
+    const QuadratureRule<D,dim>& quadratureRule() const
+    {
+      return quadratureRule_;
+    }
+
+    //! The Gauss-Lobatto-Legendre points on [0,1] in ascending order
+    const std::vector<D>& points() const
+    {
+      return points_;
+    }
+
+  private:
+    std::vector<D> weights_;
+    std::vector<D> points_;
+    GaussLobattoTensorQuadratureRule<D,dim> quadratureRule_;
+    LocalBasis localBasis_;
+    LocalCoefficients localCoefficients_;
+    LocalInterpolation localInterpolation_;
+  };
+
+} // end namespace Impl
+
+
+
+// *****************************************************************************
+// This is the reusable part of the basis. It contains
+//
+//   GaussLobattoLagrangePreBasis
+//   GaussLobattoLagrangeNode
+//
+// The pre-basis allows to create the others and is the owner of possible shared
+// state. These components do _not_ depend on the global basis and local view
+// and can be used without a global basis.
+// *****************************************************************************
+
+/**
+ * \brief Leaf basis node of the GaussLobattoLagrangePreBasis
+ *
+ * The node stores a pointer to the local finite element of the pre-basis.
+ * Thus, the lifetime of the pre-basis must be greater than the lifetime
+ * of this node.
+ */
+template<typename GV, typename FE>
+class GaussLobattoLagrangeNode :
+  public LeafBasisNode
+{
+public:
+
+  using size_type = std::size_t;
+  using Element = typename GV::template Codim<0>::Entity;
+  using FiniteElement = FE;
+
+  //! Constructor; stores a pointer to the passed local finite element
+  explicit GaussLobattoLagrangeNode(const FiniteElement& finiteElement) :
+    finiteElement_(&finiteElement),
+    element_(nullptr)
+  {}
+
+  //! Return current element, throw if unbound
+  const Element& element() const
+  {
+    return *element_;
+  }
+
+  //! Return the LocalFiniteElement shared by all elements
+  const FiniteElement& finiteElement() const
+  {
+    return *finiteElement_;
+  }
+
+  //! Bind to element.
+  void bind(const Element& e)
+  {
+    element_ = &e;
+    this->setSize(finiteElement_->size());
+  }
+
+  //! Bind to the element the given node is bound to
+  void bindLike(const GaussLobattoLagrangeNode& other)
+  {
+    element_ = other.element_;
+    finiteElement_ = other.finiteElement_;
+    this->setSize(other.size());
+  }
+
+protected:
+  const FiniteElement* finiteElement_;
+  const Element* element_;
+};
+
+
+
+/**
+ * \brief A pre-basis for spectral element Lagrange bases with Gauss-Lobatto-Legendre nodes
+ *
+ * \ingroup FunctionSpaceBasesImplementations
+ *
+ * The basis spans the same space as `LagrangePreBasis` of order k on cube grids,
+ * but the Lagrange nodes are tensor products of the Gauss-Lobatto-Legendre points
+ * instead of equidistant points. This is much better conditioned for higher orders.
+ * The global indices are computed by the `LagrangePreBasis`, which this pre-basis
+ * is derived from.
+ *
+ * The local finite element additionally provides the collocated quadrature rule
+ * `finiteElement().quadratureRule()` using the Lagrange nodes as quadrature points.
+ * With this rule the mass matrix is diagonal, which is the usual choice for
+ * explicit time stepping with spectral elements.
+ *
+ * \note All elements of the grid view have to be cubes.
+ *
+ * \tparam GV  The grid view that the FE basis is defined on
+ * \tparam k   The polynomial order of ansatz functions, k > 0
+ * \tparam R   Range type used for shape function values
+ */
+template<typename GV, int k, typename R=double>
+class GaussLobattoLagrangePreBasis :
+  public LagrangePreBasis<GV,k,R>
+{
+  using Base = LagrangePreBasis<GV,k,R>;
+  static const int dim = GV::dimension;
+
+  static_assert(k > 0, "GaussLobattoLagrangePreBasis requires a positive compile-time order");
+
+public:
+
+  //! The grid view that the FE basis is defined on
+  using GridView = GV;
+
+  //! The local finite element shared by all elements
+  using FiniteElement = Impl::GaussLobattoLagrangeLocalFiniteElement<typename GV::ctype, R, dim, k>;
+
+  //! Template mapping root tree path to type of created tree node
+  using Node = GaussLobattoLagrangeNode<GV, FiniteElement>;
+
+  //! Constructor for a given grid view object
+  GaussLobattoLagrangePreBasis(const GridView& gv) :
+    Base(gv),
+    finiteElement_()
+  {
+    checkGeometryTypes();
+    this->latticePoints_ = std::vector<double>(finiteElement_.points().begin(), finiteElement_.points().end());
+  }
+
+  //! Initialize the global indices
+  void initializeIndices()
+  {
+    Base::initializeIndices(makeNode());
+  }
+
+  //! Update the stored grid view, to be called if the grid has changed
+  void update(const GridView& gv)
+  {
+    Base::update(gv);
+    checkGeometryTypes();
+  }
+
+  //! Create tree node
+  Node makeNode() const
+  {
+    return Node{finiteElement_};
+  }
+
+  //! Return the local finite element shared by all elements
+  const FiniteElement& finiteElement() const
+  {
+    return finiteElement_;
+  }
+
+private:
+
+  void checkGeometryTypes() const
+  {
+    for (auto type : this->gridView().indexSet().types(0))
+      if (!type.isCube())
+        DUNE_THROW(Dune::NotImplemented, "GaussLobattoLagrangePreBasis is only implemented for cube grids");
+  }
+
+  FiniteElement finiteElement_;
+};
+
+
+
+namespace BasisFactory {
+
+/**
+ * \brief Create a pre-basis factory that can create a Gauss-Lobatto-Lagrange pre-basis
+ *
+ * \ingroup FunctionSpaceBasesImplementations
+ *
+ * \tparam k   The polynomial order of the ansatz functions
+ * \tparam R   The range type of the local basis
+ */
+template<std::size_t k, typename R=double>
+auto gaussLobattoLagrange()
+{
+  return [](const auto& gridView) {
+    return GaussLobattoLagrangePreBasis<std::decay_t<decltype(gridView)>, k, R>(gridView);
+  };
+}
+
+} // end namespace BasisFactory
+
+
+
+/** \brief Nodal basis of a scalar k-th-order spectral element space with Gauss-Lobatto-Legendre nodes
+ *
+ * \ingroup FunctionSpaceBasesImplementations
+ *
+ * \tparam GV The GridView that the space is defined on
+ * \tparam k The order of the basis
+ * \tparam R The range type of the local basis
+ */
+template<typename GV, int k, typename R=double>
+using GaussLobattoLagrangeBasis = DefaultGlobalBasis<GaussLobattoLagrangePreBasis<GV, k, R> >;
+
+
+
+} // end namespace Functions
+} // end namespace Dune
+
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_GAUSSLOBATTOLAGRANGEBASIS_HH
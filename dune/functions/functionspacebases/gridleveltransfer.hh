@@ -0,0 +1,185 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_GRIDLEVELTRANSFER_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_GRIDLEVELTRANSFER_HH
+
+#include <cstddef>
+#include <map>
+#include <utility>
+#include <vector>
+
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/exceptions.hh>
+
+#include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/typeindex.hh>
+
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <dune/functions/functionspacebases/basisinterpolation.hh>
+#include <dune/functions/functionspacebases/elementtransferoperator.hh>
+
+namespace Dune {
+namespace Functions {
+
+
+
+/**
+ * \brief Transfer operators between bases on a coarse and a fine grid view of the same grid
+ *
+ * \ingroup FunctionSpaceBasesUtilities
+ *
+ * This provides the prolongation P from a basis on a coarse grid view to a
+ * basis on a fine grid view, e.g. from level l to level l+1 or to the leaf
+ * grid view, for geometric multigrid methods or to move a coefficient vector
+ * to a refined grid. Each fine element is associated to its ancestor in the
+ * coarse grid view using the father relation. The coefficients of the
+ * prolongation of a coarse function are those of its local interpolant on the
+ * fine elements, hence P is exact if the coarse space is contained in the fine
+ * space. The restriction is the transposed matrix \f$ P^T \f$.
+ *
+ * The local matrix of a fine element only depends on the geometry types and
+ * the position of the fine element within its ancestor. It is computed once
+ * for each distinct position, which for regular refinement means once per
+ * child. The operators are applied by gathering the coarse coefficients of an
+ * element, multiplying by the local matrix, and scattering the result. Each
+ * fine DOF is written by a single element only, such that the element loops
+ * can be run in parallel.
+ *
+ * Both bases must have a leaf tree, flat multi-indices, and local finite
+ * elements that only depend on the geometry type, like `LagrangeBasis`.
+ * Since the ancestors are found via `GridView::contains()`, the coarse grid
+ * view must contain an ancestor or the element itself for each fine element.
+ * The object has to be recreated if one of the bases changes.
+ *
+ * \tparam CB Type of the coarse global basis
+ * \tparam FB Type of the fine global basis
+ * \tparam F Field type of the transfer matrices
+ */
+template<class CB, class FB, class F = double>
+class GridLevelTransfer
+{
+  using CoarseBasis = CB;
+  using FineBasis = FB;
+  using Field = F;
+  using size_type = std::size_t;
+  using ctype = typename FineBasis::GridView::ctype;
+
+  static constexpr int dim = FineBasis::GridView::dimension;
+
+public:
+
+  //! Precompute the local transfer matrices and the global indices of all fine elements
+  GridLevelTransfer(const CB& coarseBasis, const FB& fineBasis) :
+    transfer_(coarseBasis.dimension(), fineBasis.dimension())
+  {
+    static_assert(CoarseBasis::LocalView::Tree::isLeaf and FineBasis::LocalView::Tree::isLeaf,
+      "GridLevelTransfer requires bases with a leaf tree");
+
+    const auto& coarseGridView = coarseBasis.gridView();
+    auto coarseLocalView = coarseBasis.localView();
+    auto fineLocalView = fineBasis.localView();
+
+    using Element = typename FineBasis::GridView::template Codim<0>::Entity;
+    std::vector<typename Element::LocalGeometry> geometriesInFather;
+    auto toCoarse = [&](auto x) {
+      for (const auto& geometryInFather : geometriesInFather)
+        x = geometryInFather.global(x);
+      return x;
+    };
+
+    // The local matrices are identified by the geometry types
+    // and the corners of the fine element in the coarse element.
+    std::map<std::vector<ctype>, size_type> matrixIndices;
+    std::vector<ctype> key;
+    std::vector<size_type> coarseIndices, fineIndices;
+    for (const auto& element : elements(fineBasis.gridView()))
+    {
+      geometriesInFather.clear();
+      Element coarseElement = element;
+      while (not coarseGridView.contains(coarseElement))
+      {
+        if (not coarseElement.hasFather())
+          DUNE_THROW(Dune::Exception, "GridLevelTransfer: Fine element has no ancestor in the coarse grid view");
+        geometriesInFather.push_back(coarseElement.geometryInFather());
+        coarseElement = coarseElement.father();
+      }
+
+      key.assign({ctype(LocalGeometryTypeIndex::index(coarseElement.type())), ctype(LocalGeometryTypeIndex::index(element.type()))});
+      const auto& refElement = referenceElement(element);
+      for (int c = 0; c < refElement.size(dim); ++c)
+      {
+        auto corner = toCoarse(refElement.position(c, dim));
+        key.insert(key.end(), corner.begin(), corner.end());
+      }
+
+      fineLocalView.bind(element);
+      coarseLocalView.bind(coarseElement);
+      auto [it, isNew] = matrixIndices.try_emplace(key, 0);
+      if (isNew)
+      {
+        DynamicMatrix<Field> localMatrix;
+        Impl::localTransferMatrix(coarseLocalView.tree().finiteElement(), fineLocalView.tree().finiteElement(), localMatrix, toCoarse);
+        it->second = transfer_.addLocalMatrix(std::move(localMatrix));
+      }
+
+      coarseIndices.resize(coarseLocalView.size());
+      for (size_type j = 0; j < coarseLocalView.size(); ++j)
+        coarseIndices[j] = coarseLocalView.index(j)[0];
+      fineIndices.resize(fineLocalView.size());
+      for (size_type i = 0; i < fineLocalView.size(); ++i)
+        fineIndices[i] = fineLocalView.index(i)[0];
+      transfer_.addElement(it->second, coarseIndices, fineIndices);
+    }
+  }
+
+  /**
+   * \brief Compute fine = P coarse
+   *
+   * \param coarse Coefficient vector of the coarse basis
+   * \param fine Coefficient vector of the fine basis, which must already have the right size
+   * \param threads Number of threads used for the element loop
+   */
+  template<class CoarseVector, class FineVector>
+  void applyProlongation(const CoarseVector& coarse, FineVector& fine, std::size_t threads = 1) const
+  {
+    transfer_.applyProlongation(coarse, fine, threads);
+  }
+
+  /**
+   * \brief Compute coarse = P^T fine
+   *
+   * \param fine Coefficient vector of the fine basis
+   * \param coarse Coefficient vector of the coarse basis, which must already have the right size
+   * \param threads Number of threads used for the element loop
+   */
+  template<class FineVector, class CoarseVector>
+  void applyRestriction(const FineVector& fine, CoarseVector& coarse, std::size_t threads = 1) const
+  {
+    transfer_.applyRestriction(fine, coarse, threads);
+  }
+
+  /**
+   * \brief Assemble the prolongation matrix
+   *
+   * Entries with absolute value below the given tolerance are omitted.
+   *
+   * \param matrix A sparse matrix like `BCRSMatrix<double>` with fine rows and coarse columns
+   * \param tolerance Threshold for omitting entries
+   */
+  template<class Matrix>
+  void assembleProlongationMatrix(Matrix& matrix, Field tolerance = 1e-12) const
+  {
+    transfer_.assembleProlongationMatrix(matrix, tolerance);
+  }
+
+private:
+  Impl::ElementTransferOperator<Field> transfer_;
+};
+
+
+
+} // end namespace Functions
+} // end namespace Dune
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_GRIDLEVELTRANSFER_HH
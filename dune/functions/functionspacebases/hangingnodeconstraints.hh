@@ -0,0 +1,423 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_HANGINGNODECONSTRAINTS_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_HANGINGNODECONSTRAINTS_HH
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <dune/istl/matrixindexset.hh>
+#include <dune/istl/operators.hh>
+#include <dune/istl/solvercategory.hh>
+
+#include <dune/functions/functionspacebases/subentitydofs.hh>
+
+namespace Dune {
+namespace Functions {
+
+
+
+/**
+ * \brief Constraints for the DOFs on hanging entities of nonconforming grids
+ *
+ * \ingroup FunctionSpaceBasesUtilities
+ *
+ * On a locally refined grid without conforming closure, a scalar Lagrange
+ * basis is not conforming: The DOFs on the fine side of a nonconforming
+ * intersection, which are not shared with the coarse neighbor, have to be
+ * constrained to the trace of the coarse element. This class detects these
+ * hanging DOFs using the intersections of the grid view, and computes the
+ * constraint
+ * \f[ x_c = \sum_j w_{cj} x_j \f]
+ * with the weights \f$ w_{cj} \f$ obtained by applying the local interpolation
+ * of the fine element to the shape functions of the coarse element. Constraints
+ * referring to other constrained DOFs, e.g. for neighbors that differ by more
+ * than one level, are resolved recursively, such that all masters are free DOFs.
+ *
+ * With the matrix \f$ P \f$ mapping the free DOFs to all DOFs, the constrained
+ * system is \f$ P^T A P x = P^T b \f$, with identity rows for the constrained DOFs.
+ * It can be set up in two ways:
+ * - During assembly, distributeLocal() adds the element contributions to the
+ *   rows and columns of the masters, and setConstrainedRows() finally inserts
+ *   the identity rows.
+ * - After assembly, `HangingNodeConstrainedOperator` applies the constrained
+ *   system matrix using the unconstrained matrix.
+ *
+ * In both cases, distribute() has to be applied to the solution afterwards
+ * to compute the values of the constrained DOFs.
+ *
+ * Hanging DOFs are only detected across intersections, i.e., in 3d the
+ * neighbors of fine elements sharing only an edge must not be coarser.
+ * The basis must have a leaf tree and flat multi-indices.
+ *
+ * \tparam B Type of the global basis
+ * \tparam F Field type of the weights
+ */
+template<class B, class F = double>
+class HangingNodeConstraints
+{
+  using Basis = B;
+  using Field = F;
+
+  static_assert(Basis::LocalView::Tree::isLeaf, "HangingNodeConstraints requires a basis with a leaf tree");
+
+public:
+
+  using size_type = std::size_t;
+
+  //! List of master DOFs and weights of a constrained DOF
+  using Constraint = std::vector<std::pair<size_type, Field>>;
+
+  /**
+   * \brief Compute the constraints of all hanging DOFs
+   *
+   * \param basis The global basis on a possibly nonconforming grid view
+   * \param tolerance Weights with absolute value below the tolerance are omitted
+   */
+  HangingNodeConstraints(const B& basis, Field tolerance = 1e-12) :
+    constraints_(basis.dimension()),
+    isConstrained_(basis.dimension(), false)
+  {
+    computeConstraints(basis, tolerance);
+    resolveConstraints(tolerance);
+  }
+
+  //! Total number of DOFs
+  size_type size() const
+  {
+    return isConstrained_.size();
+  }
+
+  //! Number of constrained DOFs
+  size_type constrainedSize() const
+  {
+    return std::count(isConstrained_.begin(), isConstrained_.end(), true);
+  }
+
+  //! Check if the given DOF is constrained
+  bool isConstrained(size_type i) const
+  {
+    return isConstrained_[i];
+  }
+
+  //! Masters and weights of the given constrained DOF
+  const Constraint& constraint(size_type i) const
+  {
+    return constraints_[i];
+  }
+
+  /**
+   * \brief Assemble the matrix P mapping the free DOFs to all DOFs
+   *
+   * The rows of free DOFs are unit vectors and the rows of constrained DOFs
+   * contain the weights. Hence x = P x holds for all vectors satisfying the
+   * constraints.
+   *
+   * \param matrix A sparse matrix like `BCRSMatrix<double>`
+   */
+  template<class Matrix>
+  void assembleConstraintMatrix(Matrix& matrix) const
+  {
+    MatrixIndexSet pattern(size(), size());
+    for (size_type i = 0; i < size(); ++i)
+      forEachMaster(i, [&](size_type j, Field) { pattern.add(i, j); });
+    pattern.exportIdx(matrix);
+    matrix = 0;
+    for (size_type i = 0; i < size(); ++i)
+      forEachMaster(i, [&](size_type j, Field w) { matrix[i][j] = w; });
+  }
+
+  /**
+   * \brief Add the entries of the constrained system coupling the DOFs of an element
+   *
+   * \param localView A local view bound to an element
+   * \param pattern A MatrixIndexSet of the size of the basis
+   */
+  template<class LocalView>
+  void addLocalPattern(const LocalView& localView, MatrixIndexSet& pattern) const
+  {
+    for (size_type i = 0; i < localView.size(); ++i)
+    {
+      auto row = localView.index(i)[0];
+      if (isConstrained_[row])
+        pattern.add(row, row);
+      forEachMaster(row, [&](size_type masterRow, Field) {
+        for (size_type j = 0; j < localView.size(); ++j)
+          forEachMaster(localView.index(j)[0], [&](size_type masterCol, Field) {
+            pattern.add(masterRow, masterCol);
+          });
+      });
+    }
+  }
+
+  /**
+   * \brief Add the element matrix and vector to the constrained system
+   *
+   * Contributions of constrained DOFs are distributed to their masters.
+   *
+   * \param localView A local view bound to an element
+   * \param elementMatrix The element matrix, e.g. a `DynamicMatrix<double>`
+   * \param elementVector The element vector, e.g. a `DynamicVector<double>`
+   * \param matrix The global matrix with the pattern obtained from addLocalPattern()
+   * \param rhs The global right hand side vector
+   */
+  template<class LocalView, class ElementMatrix, class ElementVector, class Matrix, class Vector>
+  void distributeLocal(const LocalView& localView, const ElementMatrix& elementMatrix, const ElementVector& elementVector,
+    Matrix& matrix, Vector& rhs) const
+  {
+    for (size_type i = 0; i < localView.size(); ++i)
+      forEachMaster(localView.index(i)[0], [&](size_type masterRow, Field rowWeight) {
+        rhs[masterRow] += rowWeight * elementVector[i];
+        for (size_type j = 0; j < localView.size(); ++j)
+          forEachMaster(localView.index(j)[0], [&](size_type masterCol, Field colWeight) {
+            matrix[masterRow][masterCol] += rowWeight * colWeight * elementMatrix[i][j];
+          });
+      });
+  }
+
+  /**
+   * \brief Set the rows of the constrained DOFs to identity rows with zero right hand side
+   *
+   * The entries of these rows and columns are not touched by distributeLocal(),
+   * hence only the diagonal and the right hand side are set.
+   */
+  template<class Matrix, class Vector>
+  void setConstrainedRows(Matrix& matrix, Vector& rhs) const
+  {
+    for (size_type i = 0; i < size(); ++i)
+      if (isConstrained_[i])
+      {
+        matrix[i][i] = 1;
+        rhs[i] = 0;
+      }
+  }
+
+  //! Compute the values of all constrained DOFs from their masters
+  template<class Vector>
+  void distribute(Vector& x) const
+  {
+    for (size_type i = 0; i < size(); ++i)
+      if (isConstrained_[i])
+      {
+        x[i] = 0;
+        for (const auto& [j, w] : constraints_[i])
+          x[i] += w * x[j];
+      }
+  }
+
+  //! Add the entries of constrained DOFs to their masters and set them to zero, i.e., apply P^T
+  template<class Vector>
+  void distributeTransposed(Vector& r) const
+  {
+    for (size_type i = 0; i < size(); ++i)
+      if (isConstrained_[i])
+      {
+        for (const auto& [j, w] : constraints_[i])
+          r[j] += w * r[i];
+        r[i] = 0;
+      }
+  }
+
+private:
+
+  // Call f(j, w) for the free DOFs j and weights w representing the DOF i
+  template<class Callback>
+  void forEachMaster(size_type i, Callback&& f) const
+  {
+    if (not isConstrained_[i])
+      f(i, Field(1));
+    else
+      for (const auto& [j, w] : constraints_[i])
+        f(j, w);
+  }
+
+  void computeConstraints(const B& basis, Field tolerance)
+  {
+    using std::abs;
+    const auto& gridView = basis.gridView();
+    auto localView = basis.localView();
+    auto coarseLocalView = basis.localView();
+    auto subEntityDOFs = Dune::Functions::subEntityDOFs(basis);
+
+    using LocalBasis = typename Basis::LocalView::Tree::FiniteElement::Traits::LocalBasisType;
+    using Domain = typename LocalBasis::Traits::DomainType;
+    using Range = typename LocalBasis::Traits::RangeType;
+    std::vector<Range> values;
+    std::vector<Field> coefficients;
+    std::vector<std::vector<Field>> weights;
+
+    for (const auto& element : elements(gridView))
+    {
+      bool isBound = false;
+      for (const auto& intersection : intersections(gridView, element))
+      {
+        if (intersection.conforming() or not intersection.neighbor())
+          continue;
+        const auto& coarseElement = intersection.outside();
+        if (coarseElement.level() >= element.level())
+          continue;
+
+        if (not isBound)
+        {
+          localView.bind(element);
+          isBound = true;
+        }
+        coarseLocalView.bind(coarseElement);
+        const auto& fineFiniteElement = localView.tree().finiteElement();
+        const auto& coarseFiniteElement = coarseLocalView.tree().finiteElement();
+        const auto& geometry = element.geometry();
+        const auto& coarseGeometry = coarseElement.geometry();
+
+        // Interpolate the coarse shape functions in the fine element
+        weights.resize(coarseLocalView.size());
+        for (size_type j = 0; j < coarseLocalView.size(); ++j)
+          fineFiniteElement.localInterpolation().interpolate([&](const Domain& x) {
+            coarseFiniteElement.localBasis().evaluateFunction(coarseGeometry.local(geometry.global(x)), values);
+            return values[j];
+          }, weights[j]);
+
+        for (auto i : subEntityDOFs.bind(localView, intersection))
+        {
+          auto index = localView.index(i)[0];
+          bool isShared = false;
+          for (size_type j = 0; j < coarseLocalView.size(); ++j)
+            isShared = isShared or (coarseLocalView.index(j)[0] == index);
+          if (isShared)
+            continue;
+
+          isConstrained_[index] = true;
+          constraints_[index].clear();
+          for (size_type j = 0; j < coarseLocalView.size(); ++j)
+            if (abs(weights[j][i]) > tolerance)
+              constraints_[index].emplace_back(coarseLocalView.index(j)[0], weights[j][i]);
+        }
+      }
+    }
+  }
+
+  // Replace constrained masters by their masters until all masters are free
+  void resolveConstraints(Field tolerance)
+  {
+    using std::abs;
+    const size_type maxDepth = constrainedSize() + 1;
+    for (size_type i = 0; i < size(); ++i)
+    {
+      if (not isConstrained_[i])
+        continue;
+      for (size_type depth = 0; ; ++depth)
+      {
+        if (depth == maxDepth)
+          DUNE_THROW(Dune::Exception, "HangingNodeConstraints: Cyclic constraints detected");
+        auto& constraint = constraints_[i];
+        bool hasConstrainedMaster = std::any_of(constraint.begin(), constraint.end(),
+          [&](const auto& entry) { return isConstrained_[entry.first]; });
+        if (not hasConstrainedMaster)
+          break;
+
+        Constraint resolved;
+        for (const auto& [j, w] : constraint)
+        {
+          if (not isConstrained_[j])
+            resolved.emplace_back(j, w);
+          else
+            for (const auto& [k, v] : constraints_[j])
+              resolved.emplace_back(k, w*v);
+        }
+
+        // Merge entries with the same master
+        std::sort(resolved.begin(), resolved.end(),
+          [](const auto& a, const auto& b) { return a.first < b.first; });
+        constraint.clear();
+        for (const auto& [j, w] : resolved)
+        {
+          if (not constraint.empty() and constraint.back().first == j)
+            constraint.back().second += w;
+          else
+            constraint.emplace_back(j, w);
+        }
+        constraint.erase(std::remove_if(constraint.begin(), constraint.end(),
+          [&](const auto& entry) { return abs(entry.second) <= tolerance; }), constraint.end());
+      }
+    }
+  }
+
+  std::vector<Constraint> constraints_;
+  std::vector<bool> isConstrained_;
+};
+
+
+
+/**
+ * \brief Linear operator applying the constrained system matrix
+ *
+ * \ingroup FunctionSpaceBasesUtilities
+ *
+ * This applies \f$ P^T A P \f$ on the free DOFs and the identity on the
+ * constrained DOFs, using the unconstrained matrix A. It is the same matrix
+ * as assembled using HangingNodeConstraints::distributeLocal() and
+ * HangingNodeConstraints::setConstrainedRows(), and can be passed to
+ * the iterative solvers of dune-istl. The right hand side has to be
+ * transformed by HangingNodeConstraints::distributeTransposed().
+ *
+ * \tparam M Type of the unconstrained matrix
+ * \tparam X Type of the domain vector
+ * \tparam Y Type of the range vector
+ * \tparam C Type of the HangingNodeConstraints
+ */
+template<class M, class X, class Y, class C>
+class HangingNodeConstrainedOperator :
+  public Dune::LinearOperator<X,Y>
+{
+public:
+
+  using matrix_type = M;
+  using domain_type = X;
+  using range_type = Y;
+  using field_type = typename Dune::LinearOperator<X,Y>::field_type;
+
+  HangingNodeConstrainedOperator(const M& matrix, const C& constraints) :
+    matrix_(matrix),
+    constraints_(constraints)
+  {}
+
+  void apply(const X& x, Y& y) const override
+  {
+    X z = x;
+    constraints_.distribute(z);
+    matrix_.mv(z, y);
+    constraints_.distributeTransposed(y);
+    for (std::size_t i = 0; i < constraints_.size(); ++i)
+      if (constraints_.isConstrained(i))
+        y[i] = x[i];
+  }
+
+  void applyscaleadd(field_type alpha, const X& x, Y& y) const override
+  {
+    Y z = y;
+    apply(x, z);
+    y.axpy(alpha, z);
+  }
+
+  SolverCategory::Category category() const override
+  {
+    return SolverCategory::sequential;
+  }
+
+private:
+  const M& matrix_;
+  const C& constraints_;
+};
+
+
+
+} // end namespace Functions
+} // end namespace Dune
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_HANGINGNODECONSTRAINTS_HH
@@ -3,17 +3,32 @@
 #ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_HIERARCHICALLAGRANGEBASIS_HH
 #define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_HIERARCHICALLAGRANGEBASIS_HH
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <iterator>
+#include <numeric>
 #include <type_traits>
+#include <vector>
 
+#include <dune/common/dynmatrix.hh>
 #include <dune/common/exceptions.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/math.hh>
+#include <dune/common/rangeutilities.hh>
 
-#include <dune/localfunctions/hierarchical/hierarchicalp2.hh>
+#include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/common/localbasis.hh>
+#include <dune/localfunctions/common/localfiniteelementtraits.hh>
+#include <dune/localfunctions/common/localkey.hh>
 
 #include <dune/functions/functionspacebases/nodes.hh>
 #include <dune/functions/functionspacebases/defaultglobalbasis.hh>
-#include <dune/functions/functionspacebases/lfeprebasismixin.hh>
-
-#include <dune/geometry/type.hh>
+#include <dune/functions/functionspacebases/leafprebasismappermixin.hh>
 
 namespace Dune {
   namespace Functions {
@@ -21,51 +36,750 @@ namespace Dune {
     // *****************************************************************************
     // Implementation for Hierarchical Lagrange Basis
     //
-    // - only orders k=1,2 are implemented up to now
+    // - the shape functions of order k are built from integrated Legendre polynomials
     // - order k=1 is identical to the standard Lagrange basis
     // - implementation is restricted to simplex grids
     //
     // *****************************************************************************
 
+    namespace Impl {
+
+      // Compute the n-th Legendre polynomial and its first and second derivatives at x
+      template<class R>
+      std::array<R,3> legendre(int n, R x)
+      {
+        std::array<R,3> p = {{1, 0, 0}};
+        std::array<R,3> q = {{x, 1, 0}};
+        if (n == 0)
+          return p;
+        for (int m = 1; m < n; ++m)
+        {
+          std::array<R,3> next = {{
+            ((2*m+1)*x*q[0] - m*p[0])/(m+1),
+            p[1] + (2*m+1)*q[0],
+            p[2] + (2*m+1)*q[1]
+          }};
+          p = q;
+          q = next;
+        }
+        return q;
+      }
+
+      /**
+       * \brief Static description of the hierarchical shape functions of order k on a simplex
+       *
+       * The shape functions are associated with the sub-entities of the simplex.
+       * Those of a sub-entity with vertices v_0,...,v_{m-1} in the ordering
+       * given at run-time are, written with the barycentric coordinates l_i,
+       *
+       * - m=1: the vertex function l_0
+       * - m=2: the edge functions 4 l_0 l_1 P'_{p-1}(l_1-l_0) for p=2,...,k
+       * - m=3: the face functions 27 l_0 l_1 l_2 P_i(l_1-l_0) P_j(2l_2-1) for i+j=p-3, p=3,...,k
+       * - m=4: the interior functions 256 l_0 l_1 l_2 l_3 P_i(l_1-l_0) P_j(2l_2-1) P_l(2l_3-1) for i+j+l=p-4, p=4,...,k
+       *
+       * where P_n are the Legendre polynomials. On edges these are the integrated Legendre
+       * polynomials. The shape functions are sorted by the dimension of their sub-entity,
+       * such that the interior ones come last.
+       */
+      template<int dim, int k>
+      struct HierarchicalLagrangeShapeTable
+      {
+        // A sub-entity with its vertices in the reference element numbering
+        // and the range of its shape functions
+        struct SubEntity
+        {
+          unsigned int index;
+          unsigned int codim;
+          unsigned int vertexCount;
+          std::array<int,4> vertices;
+          unsigned int firstShape;
+          unsigned int shapeCount;
+        };
+
+        struct Shape
+        {
+          unsigned int subEntity;     // Position in subEntities
+          std::array<int,3> degrees;  // Degrees of the Legendre polynomial factors
+          LocalKey localKey;
+        };
+
+        std::vector<SubEntity> subEntities;
+        std::vector<Shape> shapes;
+
+        // The equidistant Lagrange nodes in the interior of the sub-entities, one per shape
+        // function. They have barycentric coordinates (b_0,...,b_{m-1})/k with b_i>0 with
+        // respect to the vertices of the sub-entity.
+        std::vector<FieldVector<double,dim>> points;
+
+        //! The table is shared by all finite elements of the same order and dimension
+        static const HierarchicalLagrangeShapeTable& instance()
+        {
+          static const HierarchicalLagrangeShapeTable table;
+          return table;
+        }
+
+      private:
+
+        HierarchicalLagrangeShapeTable()
+        {
+          const auto& refElement = ReferenceElements<double,dim>::simplex();
+          for (int codim = dim; codim >= 0; --codim)
+            for (int s = 0; s < refElement.size(codim); ++s)
+            {
+              SubEntity subEntity{(unsigned int)s, (unsigned int)codim, (unsigned int)(dim-codim+1), {{0, 0, 0, 0}}, (unsigned int)shapes.size(), 0};
+              for (unsigned int m = 0; m < subEntity.vertexCount; ++m)
+                subEntity.vertices[m] = refElement.subEntity(s, codim, m, dim);
+              unsigned int position = subEntities.size();
+
+              unsigned int index = 0;
+              auto addShape = [&](int i, int j, int l) {
+                shapes.push_back({position, {{i, j, l}}, LocalKey(s, codim, index++)});
+              };
+              if (subEntity.vertexCount == 1)
+                addShape(0, 0, 0);
+              if (subEntity.vertexCount == 2)
+                for (int p = 2; p <= k; ++p)
+                  addShape(p-1, 0, 0);
+              if (subEntity.vertexCount == 3)
+                for (int p = 3; p <= k; ++p)
+                  for (int i = 0; i <= p-3; ++i)
+                    addShape(i, p-3-i, 0);
+              if (subEntity.vertexCount == 4)
+                for (int p = 4; p <= k; ++p)
+                  for (int i = 0; i <= p-4; ++i)
+                    for (int j = 0; j <= p-4-i; ++j)
+                      addShape(i, j, p-4-i-j);
+              subEntity.shapeCount = shapes.size() - subEntity.firstShape;
+              subEntities.push_back(subEntity);
+
+              std::array<int,4> b = {{0, 0, 0, 0}};
+              const int m = subEntity.vertexCount;
+              while (true)
+              {
+                int sum = 0;
+                for (int i = 0; i < m-1; ++i)
+                  sum += b[i]+1;
+                if ((m == 1) or (sum < k))
+                {
+                  FieldVector<double,dim> x(0);
+                  for (int i = 0; i < m; ++i)
+                  {
+                    double weight = (i < m-1) ? double(b[i]+1)/k : double(k-sum)/k;
+                    x.axpy(weight, refElement.position(subEntity.vertices[i], dim));
+                  }
+                  points.push_back(x);
+                }
+                int i = 0;
+                while (i < m-1 and b[i] == k)
+                  b[i++] = 0;
+                if (i >= m-1)
+                  break;
+                ++b[i];
+              }
+              assert(points.size() == shapes.size());
+            }
+        }
+      };
+
+
+
+      template<class D, class R, int dim, int k>
+      class HierarchicalLagrangeLocalBasis
+      {
+        using Table = HierarchicalLagrangeShapeTable<dim,k>;
+
+        // Maximal number of sub-entities of a simplex of dimension at most 3
+        static constexpr std::size_t maxSubEntities = 15;
+
+      public:
+        using Domain = FieldVector<D,dim>;
+        using Range = FieldVector<R,1>;
+        using Jacobian = FieldMatrix<R,1,dim>;
+        using Traits = LocalBasisTraits<D,dim,Domain,R,1,Range,Jacobian>;
+        using OrderArray = std::array<unsigned int,dim>;
+
+        HierarchicalLagrangeLocalBasis() :
+          table_(&Table::instance())
+        {
+          static_assert(dim <= 3, "HierarchicalLagrangeLocalBasis is only implemented for dim<=3");
+          for (std::size_t s = 0; s < table_->subEntities.size(); ++s)
+            vertices_[s] = table_->subEntities[s].vertices;
+          orientations_.fill(0);
+        }
+
+        /**
+         * \brief Order the vertices of all edges and faces by their global indices
+         *
+         * Then the shape functions of an edge or face coincide in all
+         * elements containing it. The vertices of the element itself
+         * keep the reference element ordering. For k<=2 the shape functions
+         * do not depend on the ordering and binding does nothing.
+         */
+        template<class Element, class IndexSet>
+        void bind(const Element& element, const IndexSet& indexSet)
+        {
+          if constexpr (k > 2)
+          {
+            std::array<typename IndexSet::IndexType,dim+1> keys;
+            for (int i = 0; i <= dim; ++i)
+              keys[i] = indexSet.subIndex(element, i, dim);
+            orient(keys);
+          }
+        }
+
+        //! Order the vertices of all edges and faces by the given keys of the element vertices
+        template<class Keys>
+        void orient(const Keys& keys)
+        {
+          for (std::size_t s = 0; s < table_->subEntities.size(); ++s)
+          {
+            const auto& subEntity = table_->subEntities[s];
+            vertices_[s] = subEntity.vertices;
+            orientations_[s] = 0;
+            if (subEntity.vertexCount == 1)
+              continue;
+            std::array<int,4> sorted = subEntity.vertices;
+            std::sort(sorted.begin(), sorted.begin() + subEntity.vertexCount, [&](int a, int b) {
+              return keys[a] < keys[b];
+            });
+            if (subEntity.codim > 0)
+              vertices_[s] = sorted;
+
+            // The rank of the permutation of the reference vertices in lexicographic order
+            std::array<int,4> positions;
+            for (unsigned int p = 0; p < subEntity.vertexCount; ++p)
+              positions[p] = std::distance(subEntity.vertices.begin(), std::find(subEntity.vertices.begin(), subEntity.vertices.begin()+subEntity.vertexCount, sorted[p]));
+            for (unsigned int p = 0; p < subEntity.vertexCount; ++p)
+            {
+              unsigned int smaller = 0;
+              for (unsigned int q = p+1; q < subEntity.vertexCount; ++q)
+                if (positions[q] < positions[p])
+                  ++smaller;
+              orientations_[s] = orientations_[s]*(subEntity.vertexCount-p) + smaller;
+            }
+          }
+        }
+
+        /**
+         * \brief Index of the current vertex ordering of the s-th sub-entity among all its orderings
+         *
+         * For the element itself, whose vertices keep the reference element ordering,
+         * this is the index of the ordering of its vertices by the keys. It determines
+         * the orientations of all edges and faces.
+         */
+        unsigned int orientation(std::size_t s) const
+        {
+          return orientations_[s];
+        }
+
+        std::size_t size() const
+        {
+          return table_->shapes.size();
+        }
+
+        void evaluateFunction(const Domain& x, std::vector<Range>& out) const
+        {
+          out.resize(size());
+          evaluate(x, [&](std::size_t i, R value, const auto&) {
+            out[i] = value;
+          }, false);
+        }
+
+        void evaluateJacobian(const Domain& x, std::vector<Jacobian>& out) const
+        {
+          out.resize(size());
+          evaluate(x, [&](std::size_t i, R, const auto& gradient) {
+            out[i][0] = gradient;
+          }, true);
+        }
+
+        void partial(const OrderArray& order, const Domain& x, std::vector<Range>& out) const
+        {
+          auto totalOrder = std::accumulate(order.begin(), order.end(), 0u);
+          if (totalOrder == 0)
+            return evaluateFunction(x, out);
+          if (totalOrder == 1)
+          {
+            auto l = std::distance(order.begin(), std::find(order.begin(), order.end(), 1u));
+            out.resize(size());
+            evaluate(x, [&](std::size_t i, R, const auto& gradient) {
+              out[i] = gradient[l];
+            }, true);
+            return;
+          }
+          DUNE_THROW(RangeError, "partial() not implemented for given order");
+        }
+
+        unsigned int order() const
+        {
+          return k;
+        }
+
+      private:
+
+        // Evaluate all shape functions as products of factors and compute the gradients by the product rule
+        template<class Callback>
+        void evaluate(const Domain& x, Callback&& callback, bool gradients) const
+        {
+          static constexpr std::array<R,4> scaling = {{1, 4, 27, 256}};
+
+          std::array<R,dim+1> lambda;
+          std::array<FieldVector<R,dim>,dim+1> lambdaGradient;
+          lambda[0] = 1;
+          lambdaGradient[0] = -1;
+          for (int i = 0; i < dim; ++i)
+          {
+            lambda[0] -= x[i];
+            lambda[i+1] = x[i];
+            lambdaGradient[i+1] = 0;
+            lambdaGradient[i+1][i] = 1;
+          }
+
+          std::array<R,7> factors;
+          std::array<FieldVector<R,dim>,7> factorGradients;
+          FieldVector<R,dim> gradient;
+          for (std::size_t i = 0; i < size(); ++i)
+          {
+            const auto& shape = table_->shapes[i];
+            const auto& subEntity = table_->subEntities[shape.subEntity];
+            const auto& v = vertices_[shape.subEntity];
+            const unsigned int m = subEntity.vertexCount;
+
+            // The barycentric coordinates of the vertices
+            std::size_t n = 0;
+            for (; n < m; ++n)
+            {
+              factors[n] = lambda[v[n]];
+              factorGradients[n] = lambdaGradient[v[n]];
+            }
+            factors[0] *= scaling[m-1];
+            factorGradients[0] *= scaling[m-1];
+
+            // The Legendre polynomials of l_1-l_0, 2l_2-1, and 2l_3-1.
+            // For edges the first derivative of the Legendre polynomial is used.
+            for (unsigned int f = 0; f+1 < m; ++f, ++n)
+            {
+              R argument = (f == 0) ? lambda[v[1]] - lambda[v[0]] : 2*lambda[v[f+1]] - 1;
+              auto argumentGradient = lambdaGradient[v[f+1]];
+              if (f == 0)
+                argumentGradient -= lambdaGradient[v[0]];
+              else
+                argumentGradient *= 2;
+              auto p = legendre(shape.degrees[f], argument);
+              std::size_t derivative = (m == 2) ? 1 : 0;
+              factors[n] = p[derivative];
+              factorGradients[n] = argumentGradient;
+              factorGradients[n] *= p[derivative+1];
+            }
+
+            R value = 1;
+            for (std::size_t a = 0; a < n; ++a)
+              value *= factors[a];
+            gradient = 0;
+            if (gradients)
+              for (std::size_t a = 0; a < n; ++a)
+              {
+                R product = 1;
+                for (std::size_t b = 0; b < n; ++b)
+                  if (b != a)
+                    product *= factors[b];
+                gradient.axpy(product, factorGradients[a]);
+              }
+            callback(i, value, gradient);
+          }
+        }
+
+        const Table* table_;
+        std::array<std::array<int,4>,maxSubEntities> vertices_;
+        std::array<unsigned int,maxSubEntities> orientations_;
+      };
+
+
+
+      template<int dim, int k>
+      class HierarchicalLagrangeLocalCoefficients
+      {
+        using Table = HierarchicalLagrangeShapeTable<dim,k>;
+
+      public:
+        HierarchicalLagrangeLocalCoefficients() :
+          table_(&Table::instance())
+        {}
+
+        std::size_t size() const
+        {
+          return table_->shapes.size();
+        }
+
+        const LocalKey& localKey(std::size_t i) const
+        {
+          assert(i < size());
+          return table_->shapes[i].localKey;
+        }
+
+      private:
+        const Table* table_;
+      };
+
+
+
+      /**
+       * \brief The matrices of the hierarchical interpolation for all orientations of the sub-entities
+       *
+       * For each sub-entity and each ordering of its vertices, this stores the
+       * inverse of the matrix of values of its shape functions in its Lagrange
+       * nodes, and the values of all preceding shape functions in these nodes.
+       * Since the shape functions of a sub-entity are determined by the ordering
+       * of its vertices, the matrices are computed once for all elements by
+       * running through all orderings of the element vertices. The values of
+       * the preceding shape functions in the interior nodes of the element depend
+       * on the orientations of all edges and faces. Hence the blocks of the element
+       * itself are stored for all orderings of the element vertices.
+       * For k<=2 the shape functions do not depend on the orderings.
+       */
+      template<class D, class R, int dim, int k>
+      struct HierarchicalLagrangeInterpolationTable
+      {
+        struct Block
+        {
+          DynamicMatrix<R> inverse;
+          DynamicMatrix<R> coupling;
+        };
+
+        // The blocks per sub-entity and orientation
+        std::vector<std::vector<Block>> blocks;
+
+        static const HierarchicalLagrangeInterpolationTable& instance()
+        {
+          static const HierarchicalLagrangeInterpolationTable table;
+          return table;
+        }
+
+      private:
+
+        HierarchicalLagrangeInterpolationTable()
+        {
+          const auto& table = HierarchicalLagrangeShapeTable<dim,k>::instance();
+          blocks.resize(table.subEntities.size());
+          for (std::size_t s = 0; s < table.subEntities.size(); ++s)
+          {
+            const auto& subEntity = table.subEntities[s];
+            bool oriented = (k > 2) and (subEntity.vertexCount > 1) and (subEntity.shapeCount > 0);
+            blocks[s].resize(oriented ? factorial(subEntity.vertexCount) : 1);
+          }
+
+          HierarchicalLagrangeLocalBasis<D,R,dim,k> localBasis;
+          std::vector<typename HierarchicalLagrangeLocalBasis<D,R,dim,k>::Traits::RangeType> values;
+          std::array<int,dim+1> keys;
+          std::iota(keys.begin(), keys.end(), 0);
+          do
+          {
+            localBasis.orient(keys);
+            for (std::size_t s = 0; s < table.subEntities.size(); ++s)
+            {
+              const auto& subEntity = table.subEntities[s];
+              const std::size_t first = subEntity.firstShape;
+              const std::size_t n = subEntity.shapeCount;
+              if (n == 0)
+                continue;
+              auto& block = blocks[s][localBasis.orientation(s)];
+              if (block.inverse.N() == n)
+                continue;
+              block.inverse.resize(n, n);
+              block.coupling.resize(n, first);
+              for (std::size_t q = 0; q < n; ++q)
+              {
+                localBasis.evaluateFunction(table.points[first+q], values);
+                for (std::size_t j = 0; j < first; ++j)
+                  block.coupling[q][j] = values[j][0];
+                for (std::size_t j = 0; j < n; ++j)
+                  block.inverse[q][j] = values[first+j][0];
+              }
+              block.inverse.invert();
+            }
+          }
+          while ((k > 2) and std::next_permutation(keys.begin(), keys.end()));
+        }
+      };
+
+
+
+      // The interpolation determines the coefficients sub-entity by sub-entity, starting
+      // with the vertices. The coefficients of a sub-entity are chosen such that the
+      // interpolant matches the function in the equidistant Lagrange nodes in the
+      // interior of the sub-entity. Since the shape functions of the other sub-entities
+      // of the same or higher dimension vanish there, this only requires solving a
+      // small system per sub-entity. The coefficients of an edge or face only depend
+      // on the values on its closure. Hence the interpolant is continuous. The nodes
+      // and the inverse matrices of these systems are precomputed for all orientations.
+      template<class D, class R, int dim, int k>
+      class HierarchicalLagrangeLocalInterpolation
+      {
+        using Table = HierarchicalLagrangeShapeTable<dim,k>;
+        using InterpolationTable = HierarchicalLagrangeInterpolationTable<D,R,dim,k>;
+        using LocalBasis = HierarchicalLagrangeLocalBasis<D,R,dim,k>;
+
+        static constexpr std::size_t size = binomial(k+dim, dim);
+
+      public:
+
+        template<class Element, class IndexSet>
+        void bind(const Element& element, const IndexSet& indexSet)
+        {
+          localBasis_.bind(element, indexSet);
+        }
+
+        template<class F, class C>
+        void interpolate(const F& f, std::vector<C>& out) const
+        {
+          const auto& table = Table::instance();
+          const auto& interpolationTable = InterpolationTable::instance();
+          assert(table.shapes.size() == size);
+          std::array<R,size> coefficients;
+          std::array<R,size> rhs;
+
+          for (std::size_t s = 0; s < table.subEntities.size(); ++s)
+          {
+            const auto& subEntity = table.subEntities[s];
+            const std::size_t first = subEntity.firstShape;
+            const std::size_t n = subEntity.shapeCount;
+            if (n == 0)
+              continue;
+            const auto& block = interpolationTable.blocks[s][localBasis_.orientation(s)];
+            for (std::size_t q = 0; q < n; ++q)
+            {
+              R y = f(FieldVector<D,dim>(table.points[first+q]));
+              for (std::size_t j = 0; j < first; ++j)
+                y -= block.coupling[q][j]*coefficients[j];
+              rhs[q] = y;
+            }
+            for (std::size_t j = 0; j < n; ++j)
+            {
+              coefficients[first+j] = 0;
+              for (std::size_t q = 0; q < n; ++q)
+                coefficients[first+j] += block.inverse[j][q]*rhs[q];
+            }
+          }
+
+          out.resize(size);
+          for (std::size_t i = 0; i < size; ++i)
+            out[i] = coefficients[i];
+        }
+
+      private:
+        LocalBasis localBasis_;
+      };
+
+
+
+      /**
+       * \brief Hierarchical local finite element of order k on a simplex
+       *
+       * The shape functions of edges and faces depend on the global
+       * indices of their vertices. Hence the finite element has to
+       * be bound to an element before it can be used.
+       */
+      template<class D, class R, int dim, int k>
+      class HierarchicalLagrangeLocalFiniteElement
+      {
+        using LocalBasis = HierarchicalLagrangeLocalBasis<D,R,dim,k>;
+        using LocalCoefficients = HierarchicalLagrangeLocalCoefficients<dim,k>;
+        using LocalInterpolation = HierarchicalLagrangeLocalInterpolation<D,R,dim,k>;
+
+      public:
+        using Traits = LocalFiniteElementTraits<LocalBasis,LocalCoefficients,LocalInterpolation>;
+
+        const LocalBasis& localBasis() const
+        {
+          return localBasis_;
+        }
+
+        const LocalCoefficients& localCoefficients() const
+        {
+          return localCoefficients_;
+        }
+
+        const LocalInterpolation& localInterpolation() const
+        {
+          return localInterpolation_;
+        }
+
+        std::size_t size() const
+        {
+          return localBasis_.size();
+        }
+
+        GeometryType type() const
+        {
+          return GeometryTypes::simplex(dim);
+        }
+
+        template<class Element, class IndexSet>
+        void bind(const Element& element, const IndexSet& indexSet)
+        {
+          localBasis_.bind(element, indexSet);
+          localInterpolation_.bind(element, indexSet);
+        }
+
+      private:
+        LocalBasis localBasis_;
+        LocalCoefficients localCoefficients_;
+        LocalInterpolation localInterpolation_;
+      };
+
+    } // end namespace Impl
+
+
+
+    /**
+     * \brief Leaf basis node of the HierarchicalLagrangePreBasis
+     *
+     * Besides the usual node interface, this allows to distinguish the interior
+     * shape functions, i.e., the bubbles associated to the element itself, from
+     * the interface shape functions associated to vertices, edges, and faces.
+     * The interior ones are the last ones of the node. Hence they can be eliminated
+     * element by element, e.g., by static condensation, before the global solve.
+     */
+    template<typename GV, int k, typename R>
+    class HierarchicalLagrangeNode :
+      public LeafBasisNode
+    {
+      static const int dim = GV::dimension;
+
+    public:
+
+      using size_type = std::size_t;
+      using Element = typename GV::template Codim<0>::Entity;
+      using FiniteElement = Impl::HierarchicalLagrangeLocalFiniteElement<typename GV::ctype,R,dim,k>;
+
+      HierarchicalLagrangeNode(const GV& gridView) :
+        indexSet_(&gridView.indexSet()),
+        element_(nullptr)
+      {}
+
+      //! Return current element, throw if unbound
+      const Element& element() const
+      {
+        return *element_;
+      }
+
+      //! Return the LocalFiniteElement for the element we are bound to
+      const FiniteElement& finiteElement() const
+      {
+        return finiteElement_;
+      }
+
+      //! Bind to element.
+      void bind(const Element& e)
+      {
+        element_ = &e;
+        finiteElement_.bind(*element_, *indexSet_);
+        this->setSize(finiteElement_.size());
+      }
+
+      //! Bind to the element the given node is bound to
+      void bindLike(const HierarchicalLagrangeNode& other)
+      {
+        element_ = other.element_;
+        finiteElement_ = other.finiteElement_;
+        this->setSize(other.size());
+      }
+
+      //! Number of interface shape functions, i.e., those associated to vertices, edges, and faces
+      size_type interfaceSize() const
+      {
+        return this->size() - interiorSize();
+      }
+
+      //! Number of interior shape functions, i.e., those associated to the element itself
+      static constexpr size_type interiorSize()
+      {
+        return (k > dim) ? Dune::binomial(k-1, dim) : 0;
+      }
+
+      //! Check if the shape function with given node-local index is an interior one
+      bool isInterior(size_type i) const
+      {
+        return finiteElement_.localCoefficients().localKey(i).codim() == 0;
+      }
+
+      //! Range of the node-local indices of the interior shape functions
+      auto interiorDOFs() const
+      {
+        return Dune::range(interfaceSize(), this->size());
+      }
+
+      //! Range of the node-local indices of the interface shape functions
+      auto interfaceDOFs() const
+      {
+        return Dune::range(size_type(0), interfaceSize());
+      }
+
+    protected:
+      const typename GV::IndexSet* indexSet_;
+      FiniteElement finiteElement_;
+      const Element* element_;
+    };
+
+
+
     /**
      * \brief A pre-basis for a hierarchical Lagrange basis
      *
      * \ingroup FunctionSpaceBasesImplementations
      *
+     * The shape functions are the integrated Legendre polynomials on edges and the
+     * corresponding bubbles on faces and element interiors. They are hierarchical, i.e.,
+     * the shape functions of order k contain those of order k-1, and the shape functions
+     * of edges and faces are oriented by the global indices of their vertices.
+     * See `HierarchicalLagrangeNode` for the distinction of interior and interface DOFs.
+     *
      * \tparam GV  The grid view that the FE basis is defined on
-     * \tparam k   The polynomial order of ansatz functions, (0 < k <= 2)
+     * \tparam k   The polynomial order of ansatz functions, k > 0
      * \tparam R   Range field-type used for shape function values
      */
     template<typename GV, int k, typename R = double>
-    class HierarchicalLagrangePreBasis;
-
-    template<typename GV, typename R>
-    class HierarchicalLagrangePreBasis<GV,1,R>
-        : public LFEPreBasisMixin<GV, LagrangeSimplexLocalFiniteElement<typename GV::ctype,R,GV::dimension,1>>
+    class HierarchicalLagrangePreBasis :
+      public LeafPreBasisMapperMixin<GV>
     {
-      using Base = LFEPreBasisMixin<GV, LagrangeSimplexLocalFiniteElement<typename GV::ctype,R,GV::dimension,1>>;
-    public:
-      HierarchicalLagrangePreBasis (const GV& gridView) :
-        Base(gridView, [](GeometryType gt, int) -> std::size_t { return gt.isVertex() ? 1 : 0; })
+      using Base = LeafPreBasisMapperMixin<GV>;
+      static const int dim = GV::dimension;
+
+      static_assert(k > 0, "HierarchicalLagrangePreBasis requires a positive order");
+
+      static std::size_t layout(GeometryType gt, int)
       {
-        for (auto gt : gridView.indexSet().types(0)) {
-          if (!gt.isSimplex())
-            DUNE_THROW(Dune::NotImplemented,
-              "Hierarchical Lagrange basis only implemented for simplex grids.");
-        }
+        int m = gt.dim();
+        return (gt.isSimplex() and k > m) ? Dune::binomial(k-1, m) : 0;
       }
-    };
 
-    template<typename GV, typename R>
-    class HierarchicalLagrangePreBasis<GV,2,R>
-        : public LFEPreBasisMixin<GV, HierarchicalP2LocalFiniteElement<typename GV::ctype,R,GV::dimension>>
-    {
-      using Base = LFEPreBasisMixin<GV, HierarchicalP2LocalFiniteElement<typename GV::ctype,R,GV::dimension>>;
     public:
+
+      using GridView = GV;
+      using Node = HierarchicalLagrangeNode<GV, k, R>;
+
       HierarchicalLagrangePreBasis (const GV& gridView) :
-        Base(gridView, [](GeometryType gt, int) -> std::size_t { return (gt.isVertex() || gt.isLine()) ? 1 : 0; })
+        Base(gridView, layout)
+      {
+        checkGeometryTypes();
+      }
+
+      void update(const GridView& gv)
+      {
+        Base::update(gv);
+        checkGeometryTypes();
+      }
+
+      Node makeNode() const
+      {
+        return Node{this->gridView_};
+      }
+
+    private:
+
+      void checkGeometryTypes() const
       {
-        for (auto gt : gridView.indexSet().types(0)) {
+        for (auto gt : this->gridView_.indexSet().types(0)) {
           if (!gt.isSimplex())
             DUNE_THROW(Dune::NotImplemented,
               "Hierarchical Lagrange basis only implemented for simplex grids.");
@@ -81,13 +795,13 @@ namespace Dune {
        *
        * \ingroup FunctionSpaceBasesImplementations
        *
-       * \tparam k   The polynomial order of the ansatz functions (0 < k <= 2)
+       * \tparam k   The polynomial order of the ansatz functions (0 < k)
        * \tparam R   The range field-type of the local basis
        */
       template<int k, typename R=double>
       auto hierarchicalLagrange()
       {
-        static_assert(0 < k && k <= 2);
+        static_assert(0 < k);
         return [](const auto& gridView) {
           return HierarchicalLagrangePreBasis<std::decay_t<decltype(gridView)>, k, R>(gridView);
         };
@@ -100,7 +814,7 @@ namespace Dune {
      * \ingroup FunctionSpaceBasesImplementations
      *
      * \tparam GV The GridView that the space is defined on
-     * \tparam k The order of the basis (0 < k <= 2)
+     * \tparam k The order of the basis (0 < k)
      * \tparam R The range type of the local basis
      *
      *  \note currently only supports simplex grids
@@ -0,0 +1,281 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_HYBRIDIZATION_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_HYBRIDIZATION_HH
+
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/referenceelements.hh>
+
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <dune/functions/common/parallelfor.hh>
+#include <dune/functions/functionspacebases/elementelimination.hh>
+
+namespace Dune {
+namespace Functions {
+
+
+
+/**
+ * \brief Add the coupling of the normal trace of a flux to a facet multiplier
+ *
+ * \ingroup FunctionSpaceBasesUtilities
+ *
+ * This adds the facet integrals \f$ \int_F \mu_i \tau_j \cdot n \f$ for all facets F
+ * of the element, where \f$ \tau_j \f$ are the shape functions of the flux node,
+ * \f$ \mu_i \f$ are the shape functions of the multiplier node on F, and n is the unit
+ * outer normal of the element. The entry is added to `couplingMatrix[row][col]` where
+ * row and col are the local indices of \f$ \mu_i \f$ and \f$ \tau_j \f$ within their
+ * local views.
+ *
+ * \param fluxNode A bound node with vector-valued shape functions, e.g. of `RaviartThomasBasis`
+ * \param multiplierNode A node of a `FacetLagrangeBasis` bound to the same element
+ * \param couplingMatrix A matrix providing `couplingMatrix[i][j]` access
+ */
+template<class FluxNode, class MultiplierNode, class Matrix>
+void addNormalTraceCoupling(const FluxNode& fluxNode, const MultiplierNode& multiplierNode, Matrix& couplingMatrix)
+{
+  using Element = typename FluxNode::Element;
+  using ctype = typename Element::Geometry::ctype;
+  static const int dim = Element::dimension;
+
+  const auto& element = fluxNode.element();
+  const auto& geometry = element.geometry();
+  auto refElement = referenceElement(geometry);
+  const auto& fluxLocalBasis = fluxNode.finiteElement().localBasis();
+  const auto& multiplierFiniteElement = multiplierNode.finiteElement();
+
+  using FluxRange = typename std::decay_t<decltype(fluxLocalBasis)>::Traits::RangeType;
+  using MultiplierRange = typename MultiplierNode::FiniteElement::FacetFiniteElement::Traits::LocalBasisType::Traits::RangeType;
+  std::vector<FluxRange> fluxValues;
+  std::vector<MultiplierRange> multiplierValues;
+  FieldVector<ctype,dim> normal;
+
+  for (int facet = 0; facet < refElement.size(1); ++facet)
+  {
+    const auto& facetGeometry = element.template subEntity<1>(facet).geometry();
+    const auto& facetLocalBasis = multiplierFiniteElement.facetFiniteElement(facet).localBasis();
+    const auto offset = multiplierFiniteElement.facetOffset(facet);
+    int order = fluxLocalBasis.order() + facetLocalBasis.order() + (geometry.affine() ? 0 : dim);
+    const auto& quadRule = QuadratureRules<ctype,dim-1>::rule(facetGeometry.type(), order);
+    for (const auto& quadPoint : quadRule)
+    {
+      auto x = geometry.local(facetGeometry.global(quadPoint.position()));
+      geometry.jacobianInverseTransposed(x).mv(refElement.integrationOuterNormal(facet), normal);
+      normal /= normal.two_norm();
+
+      fluxLocalBasis.evaluateFunction(x, fluxValues);
+      facetLocalBasis.evaluateFunction(quadPoint.position(), multiplierValues);
+      auto weight = quadPoint.weight() * facetGeometry.integrationElement(quadPoint.position());
+      for (std::size_t i = 0; i < multiplierValues.size(); ++i)
+      {
+        auto row = multiplierNode.localIndex(offset + i);
+        for (std::size_t j = 0; j < fluxValues.size(); ++j)
+          couplingMatrix[row][fluxNode.localIndex(j)] += multiplierValues[i][0] * (fluxValues[j] * normal) * weight;
+      }
+    }
+  }
+}
+
+
+
+/**
+ * \brief Hybridization of a discretization with element-local DOFs and a facet multiplier
+ *
+ * \ingroup FunctionSpaceBasesUtilities
+ *
+ * This implements the local elimination for hybridized methods like the hybridized
+ * mixed method with a broken Raviart-Thomas or Brezzi-Douglas-Marini flux, a
+ * discontinuous pressure, and a multiplier from a `FacetLagrangeBasis`, which
+ * enforces the normal continuity of the flux. On each element K the discrete
+ * problem has the form
+ * \f[
+ *   M_K u_K + C_K^T \lambda = F_K,
+ * \f]
+ * where \f$ u_K \f$ are the DOFs of the element-local basis and \f$ \lambda \f$ those
+ * of the multiplier. The multiplier equation is \f$ \sum_K C_K u_K = G \f$ with the
+ * prescribed normal fluxes G on Neumann facets, e.g. G=0 on interior facets.
+ * Eliminating \f$ u_K \f$ leads to the multiplier system
+ * \f[
+ *   \sum_K C_K M_K^{-1} C_K^T \lambda = \sum_K C_K M_K^{-1} F_K - G .
+ * \f]
+ * For the mixed Poisson or Darcy problem this system is symmetric and positive
+ * definite once Dirichlet values of the multiplier are prescribed.
+ * The elimination is the one of `StaticCondensation` applied to the
+ * element system with the negated multiplier equation \f$ -C_K u_K = 0 \f$.
+ *
+ * A typical usage looks like this:
+ * \code
+ * Hybridization hybridization(basis, multiplierBasis);
+ * hybridization.condense(localAssembler, threads);
+ * hybridization.multiplierPattern(pattern);
+ * // ... set up matrix from pattern, zero matrix and rhs ...
+ * hybridization.assembleMultiplierSystem(matrix, rhs);
+ * // ... subtract G, incorporate Dirichlet values, and solve ...
+ * hybridization.recoverSolution(multiplierSolution, x);
+ * \endcode
+ *
+ * The class stores the condensed element contributions. Hence `condense()`
+ * has to be called again if the system changes, and the object has to be
+ * recreated if one of the bases changes. Both bases are stored by pointer
+ * and must outlive this object.
+ *
+ * \tparam B Type of a global basis whose DOFs are element-local, e.g. using `BrokenPreBasis`
+ * \tparam MB Type of the multiplier basis with flat multi-indices
+ * \tparam F Field type of the element matrices
+ */
+template<class B, class MB, class F = double>
+class Hybridization
+{
+  using Basis = B;
+  using MultiplierBasis = MB;
+  using Field = F;
+  using GridView = typename Basis::GridView;
+  using Element = typename GridView::template Codim<0>::Entity;
+  using MultiIndex = typename Basis::MultiIndex;
+  using size_type = std::size_t;
+
+public:
+
+  /**
+   * \brief Store the global indices of the element DOFs and the multipliers
+   *
+   * \param basis The basis of the element-local DOFs, which must outlive this object
+   * \param multiplierBasis The multiplier basis, which must outlive this object
+   */
+  Hybridization(const B& basis, const MB& multiplierBasis) :
+    basis_(&basis),
+    multiplierBasis_(&multiplierBasis)
+  {
+    auto localView = basis.localView();
+    auto multiplierLocalView = multiplierBasis.localView();
+    for (const auto& element : elements(basis.gridView()))
+    {
+      localView.bind(element);
+      multiplierLocalView.bind(element);
+      for (size_type i = 0; i < localView.size(); ++i)
+        elimination_.addEliminated(localView.index(i));
+      for (size_type i = 0; i < multiplierLocalView.size(); ++i)
+      {
+        assert(multiplierLocalView.index(i).size() == 1);
+        elimination_.addKept(multiplierLocalView.index(i)[0]);
+      }
+      elimination_.finishElement();
+    }
+  }
+
+  /**
+   * \brief Compute the element contributions to the multiplier system
+   *
+   * The local assembler is called as
+   * `localAssembler(localView, multiplierLocalView, elementMatrix, couplingMatrix, elementVector)`
+   * for each element, where both local views are bound to the element. It has to add
+   * \f$ M_K \f$, \f$ C_K \f$, and \f$ F_K \f$ to the zero-initialized `DynamicMatrix` and
+   * `DynamicVector` objects, where the rows of `couplingMatrix` correspond to the
+   * local indices of `multiplierLocalView`. The coupling of a flux to the multiplier
+   * can be computed with addNormalTraceCoupling().
+   *
+   * The elements can be processed by several threads. Each thread uses
+   * its own copies of the local views and the local assembler.
+   *
+   * \param localAssembler A callback computing the element matrices and vector
+   * \param threads Number of threads used for the element loop
+   */
+  template<class LocalAssembler>
+  void condense(const LocalAssembler& localAssembler, std::size_t threads = 1)
+  {
+    std::vector<Element> elementList;
+    elementList.reserve(elimination_.size());
+    for (const auto& element : elements(basis_->gridView()))
+      elementList.push_back(element);
+    assert(elementList.size() == elimination_.size());
+
+    Impl::parallelForRanges(elementList.size(), threads, [&](size_type begin, size_type end) {
+      auto localView = basis_->localView();
+      auto multiplierLocalView = multiplierBasis_->localView();
+      auto assembler = localAssembler;
+      DynamicMatrix<Field> elementMatrix, couplingMatrix;
+      DynamicVector<Field> elementVector;
+      for (size_type e = begin; e < end; ++e)
+      {
+        localView.bind(elementList[e]);
+        multiplierLocalView.bind(elementList[e]);
+        elementMatrix.resize(localView.size(), localView.size());
+        couplingMatrix.resize(multiplierLocalView.size(), localView.size());
+        elementVector.resize(localView.size());
+        elementMatrix = 0;
+        couplingMatrix = 0;
+        elementVector = 0;
+        assembler(localView, multiplierLocalView, elementMatrix, couplingMatrix, elementVector);
+        // Eliminate u_K from M_K u_K + C_K^T lambda = F_K and -C_K u_K = 0
+        elimination_.condenseElement(e,
+          [&](size_type i, size_type j) { return elementMatrix[i][j]; },
+          [&](size_type i, size_type j) { return couplingMatrix[j][i]; },
+          [&](size_type i, size_type j) { return -couplingMatrix[i][j]; },
+          [&](size_type /*i*/, size_type /*j*/) { return Field(0); },
+          [&](size_type i) { return elementVector[i]; },
+          [&](size_type /*i*/) { return Field(0); });
+      }
+    });
+  }
+
+  /**
+   * \brief Fill the sparsity pattern of the multiplier matrix
+   *
+   * \param pattern A pattern like `Dune::MatrixIndexSet` providing `resize()` and `add()`
+   */
+  template<class Pattern>
+  void multiplierPattern(Pattern& pattern) const
+  {
+    elimination_.pattern(pattern, multiplierBasis_->dimension());
+  }
+
+  /**
+   * \brief Add the element contributions to the multiplier system
+   *
+   * Both containers are indexed by the indices of the multiplier basis
+   * and must already have the size of the multiplier basis.
+   *
+   * \param matrix A matrix providing `matrix[i][j]` access, e.g. a `BCRSMatrix` set up by multiplierPattern()
+   * \param rhs A vector providing `rhs[i]` access
+   */
+  template<class Matrix, class Vector>
+  void assembleMultiplierSystem(Matrix& matrix, Vector& rhs) const
+  {
+    elimination_.assemble(matrix, rhs);
+  }
+
+  /**
+   * \brief Compute the element-local DOFs from the multiplier
+   *
+   * \param multiplier Coefficients of the multiplier basis
+   * \param x Coefficient vector of the basis, which must already have the size of the basis
+   */
+  template<class MultiplierVector, class Vector>
+  void recoverSolution(const MultiplierVector& multiplier, Vector& x) const
+  {
+    elimination_.recover(multiplier, x);
+  }
+
+private:
+
+  const Basis* basis_;
+  const MultiplierBasis* multiplierBasis_;
+  Impl::ElementElimination<MultiIndex, Field> elimination_;
+};
+
+
+
+} // end namespace Functions
+} // end namespace Dune
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_HYBRIDIZATION_HH
@@ -3,8 +3,26 @@
 #ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_LAGRANGEBASIS_HH
 #define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_LAGRANGEBASIS_HH
 
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <memory>
+#include <optional>
+#include <string>
 #include <type_traits>
+#include <vector>
+
 #include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+
+#include <dune/geometry/type.hh>
+#include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/typeindex.hh>
+
+#include <dune/grid/common/capabilities.hh>
+#include <dune/grid/common/rangegenerators.hh>
 
 #include <dune/localfunctions/lagrange.hh>
 #include <dune/localfunctions/lagrange/equidistantpoints.hh>
@@ -37,6 +55,157 @@ class LagrangePreBasis;
 
 
 
+namespace Impl {
+
+  // Stores LocalFiniteElement implementations with run-time order as a function of GeometryType.
+  // The finite elements are created once for a given set of geometry types and stored in a flat
+  // table indexed by LocalGeometryTypeIndex. Afterwards the table is only read, such that it can
+  // be shared by all nodes of a basis, including nodes used concurrently by several threads.
+  template<typename Domain, typename Range, int dim>
+  class LagrangeRunTimeLFETable
+  {
+  public:
+    using FiniteElementType = LagrangeLocalFiniteElement<EquidistantPointSet,dim,Domain,Range>;
+
+    //! Create finite elements of the given order for all geometry types in the range `types`
+    template<class GeometryTypes>
+    LagrangeRunTimeLFETable(unsigned int order, const GeometryTypes& types) :
+      order_(order),
+      data_(LocalGeometryTypeIndex::size(dim))
+    {
+      for (const GeometryType& type : types)
+      {
+        if (type.isNone())
+          continue;
+        auto& finiteElement = data_[LocalGeometryTypeIndex::index(type)];
+        if (not finiteElement)
+          finiteElement.emplace(type, order_);
+      }
+    }
+
+    //! Create a copy of the table `other` additionally containing the finite element for `type`
+    LagrangeRunTimeLFETable(const LagrangeRunTimeLFETable& other, const GeometryType& type) :
+      LagrangeRunTimeLFETable(other)
+    {
+      auto& finiteElement = data_[LocalGeometryTypeIndex::index(type)];
+      if (not finiteElement)
+        finiteElement.emplace(type, order_);
+    }
+
+    //! Check if the table contains a finite element for the given geometry type
+    bool contains(const GeometryType& type) const
+    {
+      return (not type.isNone()) and data_[LocalGeometryTypeIndex::index(type)].has_value();
+    }
+
+    //! Return the finite element for the given geometry type, which must be contained in the table
+    const FiniteElementType& get(const GeometryType& type) const
+    {
+      assert(contains(type));
+      return *data_[LocalGeometryTypeIndex::index(type)];
+    }
+
+    unsigned int order() const
+    {
+      return order_;
+    }
+
+  private:
+
+    unsigned int order_;
+    std::vector<std::optional<FiniteElementType>> data_;
+  };
+
+  // Index of the permutation describing the relative order of the first n values.
+  // This is used to encode the orientation of a sub-entity by the global indices of its vertices.
+  template<class Values>
+  std::size_t lagrangeOrientationCode(const Values& values, std::size_t n)
+  {
+    std::size_t code = 0;
+    for (std::size_t i = 0; i < n; ++i)
+    {
+      std::size_t smaller = 0;
+      for (std::size_t j = i+1; j < n; ++j)
+        smaller += (values[j] < values[i]);
+      code = code*(n-i) + smaller;
+    }
+    return code;
+  }
+
+  // Compute the index of a Lagrange node in the interior of an edge, triangle, or quadrilateral
+  // in a numbering that only depends on the ranks of the global indices of the sub-entity
+  // vertices. For edges and triangles the lattice coordinates of the node are the barycentric
+  // coordinates multiplied by the order, for quadrilaterals they are the two local coordinates
+  // multiplied by the order.
+  template<class Ranks, class Lattice>
+  std::size_t lagrangeCanonicalSubEntityIndex(const Ranks& ranks, const Lattice& lattice, std::size_t n, int order)
+  {
+    if (n < 4)
+    {
+      // Sort the barycentric coordinates by the ranks of the vertices
+      std::array<int,3> b;
+      for (std::size_t m = 0; m < n; ++m)
+        b[ranks[m]] = lattice[m];
+      if (n == 2)
+        return b[1]-1;
+      std::size_t index = 0;
+      for (int c = 1; c < b[2]; ++c)
+        index += order-1-c;
+      return index + b[1]-1;
+    }
+
+    // Quadrilateral with vertices (0,0), (1,0), (0,1), (1,1): The vertex with the smallest
+    // rank is the origin, and its neighbor with the smaller rank determines the first axis.
+    std::size_t origin = std::min_element(ranks.begin(), ranks.begin()+4) - ranks.begin();
+    bool flipX = (origin & 1);
+    bool flipY = (origin & 2);
+    int x = flipX ? order-lattice[0] : lattice[0];
+    int y = flipY ? order-lattice[1] : lattice[1];
+    if (ranks[origin ^ 2] < ranks[origin ^ 1])
+      std::swap(x, y);
+    return (y-1)*(order-1) + (x-1);
+  }
+
+  // Positions of the Lagrange nodes in local coordinates. They are obtained
+  // by interpolating the coordinate functions.
+  template<int dim, class FiniteElement>
+  std::vector<FieldVector<double,dim>> lagrangeNodePositions(const FiniteElement& finiteElement)
+  {
+    std::vector<FieldVector<double,dim>> positions(finiteElement.size());
+    std::vector<double> coordinate;
+    for (int d = 0; d < dim; ++d)
+    {
+      finiteElement.localInterpolation().interpolate([&](const auto& x) { return x[d]; }, coordinate);
+      for (std::size_t i = 0; i < finiteElement.size(); ++i)
+        positions[i][d] = coordinate[i];
+    }
+    return positions;
+  }
+
+  // Coordinates of the point x within the edge or face of the reference element with the
+  // given n vertices, with respect to the first vertex and the edges to the second and third
+  // vertex. These edges span the sub-entity for all supported sub-entity types.
+  template<class RefElement, class Vertices, class Position>
+  std::array<double,2> lagrangeSubEntityCoordinates(const RefElement& refElement, const Vertices& vertices, std::size_t n, const Position& x)
+  {
+    constexpr int dim = RefElement::dimension;
+    const auto& p0 = refElement.position(vertices[0],dim);
+    auto e1 = refElement.position(vertices[1],dim) - p0;
+    auto y = x - p0;
+    if (n == 2)
+      return {{ (y*e1)/(e1*e1), 0 }};
+    auto e2 = refElement.position(vertices[2],dim) - p0;
+    // Solve the normal equations for y = local[0]*e1 + local[1]*e2
+    double a11 = e1*e1, a12 = e1*e2, a22 = e2*e2;
+    double b1 = y*e1, b2 = y*e2;
+    double det = a11*a22 - a12*a12;
+    return {{ (a22*b1 - a12*b2)/det, (a11*b2 - a12*b1)/det }};
+  }
+
+} // end namespace Impl
+
+
+
 /**
  * \brief A pre-basis for a PQ-lagrange bases with given order
  *
@@ -46,10 +215,9 @@ class LagrangePreBasis;
  * \tparam k   The polynomial order of ansatz functions; -1 means 'order determined at run-time'
  * \tparam R   Range type used for shape function values
  *
- * \note This only works for certain grids.  The following restrictions hold
- * - If k is no larger than 2, then the grids can have any dimension
- * - If k is larger than 3 then the grid must be two-dimensional
- * - If k is 3, then the grid can be 3d *if* it is a simplex grid
+ * \note This only works for grids of dimension at most 3. For 3d grids with prisms or pyramids
+ * and k larger than 2 the order has to be given at run-time, because the compile-time
+ * local finite elements for these geometry types are only implemented up to k=2.
  */
 template<typename GV, int k, typename R>
 class LagrangePreBasis :
@@ -57,6 +225,9 @@ class LagrangePreBasis :
 {
   static const int dim = GV::dimension;
   static const bool useDynamicOrder = (k<0);
+  static const bool isCartesian = Dune::Capabilities::isCartesian<typename GV::Grid>::v;
+
+  using FiniteElementTable = Impl::LagrangeRunTimeLFETable<typename GV::ctype, R, dim>;
 
 public:
 
@@ -88,30 +259,15 @@ public:
     }
     dofsPerPrism_ = computeDofsPerPrism();
     dofsPerPyramid_ = computeDofsPerPyramid();
+
+    if constexpr (useDynamicOrder)
+      updateFiniteElementTable();
   }
 
   //! Initialize the global indices
   void initializeIndices()
   {
-    vertexOffset_        = 0;
-    edgeOffset_            = vertexOffset_          + dofsPerCube(0) * ((size_type)gridView_.size(dim));
-
-    if (dim>=2)
-    {
-      triangleOffset_      = edgeOffset_            + dofsPerCube(1) * ((size_type) gridView_.size(dim-1));
-
-      quadrilateralOffset_ = triangleOffset_        + dofsPerSimplex(2) * ((size_type)gridView_.size(Dune::GeometryTypes::triangle));
-    }
-
-    if (dim==3) {
-      tetrahedronOffset_   = quadrilateralOffset_ + dofsPerCube(2) * ((size_type)gridView_.size(Dune::GeometryTypes::quadrilateral));
-
-      prismOffset_         = tetrahedronOffset_   +   dofsPerSimplex(3) * ((size_type)gridView_.size(Dune::GeometryTypes::tetrahedron));
-
-      hexahedronOffset_    = prismOffset_         +   dofsPerPrism() * ((size_type)gridView_.size(Dune::GeometryTypes::prism));
-
-      pyramidOffset_       = hexahedronOffset_    +   dofsPerCube(3) * ((size_type)gridView_.size(Dune::GeometryTypes::hexahedron));
-    }
+    initializeIndices(makeNode());
   }
 
   //! Obtain the grid view that the basis is defined on
@@ -124,14 +280,22 @@ public:
   void update (const GridView& gv)
   {
     gridView_ = gv;
+    if constexpr (useDynamicOrder)
+      updateFiniteElementTable();
   }
 
   /**
    * \brief Create tree node
+   *
+   * If the order is given at run-time, all nodes share the
+   * local finite elements stored in the pre-basis.
    */
   Node makeNode() const
   {
-    return Node{order_};
+    if constexpr (useDynamicOrder)
+      return Node{order_, finiteElementTable_};
+    else
+      return Node{order_};
   }
 
   //! Get the total dimension of the space spanned by this basis
@@ -172,136 +336,528 @@ public:
     return power(order()+1, (unsigned int)GV::dimension);
   }
 
-  template<typename It>
-  It indices(const Node& node, It it) const
+  template<class N, typename It>
+  It indices(const N& node, It it) const
+  {
+    // On structured grids the indices are computed in closed form from the element position
+    if constexpr (isCartesian)
+    {
+      if (not structuredLocalOffsets_.empty())
+      {
+        assert(structuredLocalOffsets_.size() == node.size());
+        const auto position = structuredElementPosition(gridView().indexSet().index(node.element()));
+        const auto* strides = structuredStrides_.data();
+        for (const auto& localOffset : structuredLocalOffsets_)
+        {
+          auto index = localOffset;
+          for (int i = 0; i < dim; ++i)
+            index += strides[i]*position[i];
+          strides += dim;
+          *it = {{ (size_type)index }};
+          ++it;
+        }
+        return it;
+      }
+    }
+    return genericIndices(node, it);
+  }
+
+  //! Polynomial order used in the local Lagrange finite-elements
+  unsigned int order() const
+  {
+    return (useDynamicOrder) ? order_ : k;
+  }
+
+protected:
+
+  // Compute the indices using the index set of the grid view
+  template<class N, typename It>
+  It genericIndices(const N& node, It it) const
+  {
+    const auto& gridIndexSet = gridView().indexSet();
+    const auto& element = node.element();
+
+    // For k==1 all DOFs are vertex DOFs and their global index is the vertex index.
+    // Handling this case at compile-time leads to measurable speed-up: see
+    //   https://gitlab.dune-project.org/staging/dune-functions/issues/30
+    if constexpr (k==1)
+    {
+      const auto& localCoefficients = node.finiteElement().localCoefficients();
+      for (size_type i = 0, end = node.size(); i < end; ++it, ++i)
+        *it = {{ (size_type)(gridIndexSet.subIndex(element,localCoefficients.localKey(i).subEntity(),dim)) }};
+      return it;
+    }
+
+    const auto& dofTable = dofTables_[LocalGeometryTypeIndex::index(element.type())];
+
+    if (not dofTable.error.empty())
+      DUNE_THROW(Dune::NotImplemented, dofTable.error);
+    if (not dofTable.initialized)
+      DUNE_THROW(Dune::Exception, "LagrangeBasis has no DOF table for elements of type " << element.type());
+    assert(dofTable.dofs.size() == node.size());
+
+    // Determine the orientation of all edges and faces carrying DOFs
+    // by the global indices of their vertices.
+    std::array<std::size_t, maxOrientedSubEntities> orientations;
+    for (std::size_t o = 0; o < dofTable.orientedSubEntities.size(); ++o)
+    {
+      const auto& subEntity = dofTable.orientedSubEntities[o];
+      std::array<size_type,4> vertexIndices;
+      for (std::size_t m = 0; m < subEntity.vertices.size(); ++m)
+        vertexIndices[m] = gridIndexSet.subIndex(element,subEntity.vertices[m],dim);
+      orientations[o] = Impl::lagrangeOrientationCode(vertexIndices, subEntity.vertices.size());
+    }
+
+    for (const auto& dof : dofTable.dofs)
+    {
+      auto entityIndex = (size_type)gridIndexSet.subIndex(element,dof.subEntity,dof.codim);
+
+      // DOFs on edges and faces are numbered according to the global orientation of the sub-entity
+      auto localIndex = dof.localIndex;
+      if (dof.orientedSubEntity >= 0)
+      {
+        const auto& subEntity = dofTable.orientedSubEntities[dof.orientedSubEntity];
+        localIndex = subEntity.permutations[orientations[dof.orientedSubEntity]*subEntity.size + dof.localIndex];
+      }
+
+      *it = {{ dof.offset + dof.stride*entityIndex + localIndex }};
+      ++it;
+    }
+    return it;
+  }
+
+  // Initialize the global indices using the local finite elements of the given node.
+  // This allows derived pre-bases with other Lagrange nodes to share the index logic.
+  template<class N>
+  void initializeIndices(N node)
   {
-    for (size_type i = 0, end = node.finiteElement().size() ; i < end ; ++it, ++i)
+    vertexOffset_        = 0;
+    edgeOffset_            = vertexOffset_          + dofsPerCube(0) * ((size_type)gridView_.size(dim));
+
+    if (dim>=2)
     {
-      Dune::LocalKey localKey = node.finiteElement().localCoefficients().localKey(i);
-      const auto& gridIndexSet = gridView().indexSet();
-      const auto& element = node.element();
+      triangleOffset_      = edgeOffset_            + dofsPerCube(1) * ((size_type) gridView_.size(dim-1));
+
+      quadrilateralOffset_ = triangleOffset_        + dofsPerSimplex(2) * ((size_type)gridView_.size(Dune::GeometryTypes::triangle));
+    }
+
+    if (dim==3) {
+      tetrahedronOffset_   = quadrilateralOffset_ + dofsPerCube(2) * ((size_type)gridView_.size(Dune::GeometryTypes::quadrilateral));
+
+      prismOffset_         = tetrahedronOffset_   +   dofsPerSimplex(3) * ((size_type)gridView_.size(Dune::GeometryTypes::tetrahedron));
+
+      hexahedronOffset_    = prismOffset_         +   dofsPerPrism() * ((size_type)gridView_.size(Dune::GeometryTypes::prism));
+
+      pyramidOffset_       = hexahedronOffset_    +   dofsPerCube(3) * ((size_type)gridView_.size(Dune::GeometryTypes::hexahedron));
+    }
+
+    initializeDOFTables(node);
+    if constexpr (isCartesian)
+      initializeStructuredIndices(node);
+  }
+
+  // Maximal number of edges and faces of an element of dimension at most 3
+  static constexpr std::size_t maxOrientedSubEntities = 18;
+
+  // Describes how the global index of a local DOF is computed from the index
+  // of the grid entity the DOF is associated to. The index is given by
+  //
+  //   offset + stride*subIndex(element,subEntity,codim) + localIndex
+  //
+  // For DOFs in the interior of edges and faces (in 3d) carrying more than one DOF,
+  // localIndex is the position of the DOF within the oriented sub-entity with index
+  // orientedSubEntity, and the actual local index is obtained from its permutation
+  // tables. Sub-entities with a single DOF are not oriented.
+  struct DOFEntry
+  {
+    size_type offset = 0;
+    size_type stride = 1;
+    size_type localIndex = 0;
+    unsigned int subEntity = 0;
+    unsigned int codim = 0;
+    int orientedSubEntity = -1;
+  };
+
+  // An edge or face whose DOFs have to be numbered according to its global orientation.
+  // The orientation is the code of the permutation given by the global indices of the
+  // vertices, see Impl::lagrangeOrientationCode(). For each orientation permutations
+  // stores the local indices of all DOFs on the sub-entity in a consistent numbering.
+  struct OrientedSubEntity
+  {
+    std::vector<unsigned int> vertices;
+    std::vector<std::array<int,4>> lattice;
+    std::size_t size = 0;    // Number of DOFs on the sub-entity expected by the global numbering
+    std::vector<size_type> permutations;
+  };
+
+  // The DOF entries for all local DOFs of an element of a given geometry type.
+  // If the geometry type is not supported, error contains the reason.
+  struct DOFTable
+  {
+    bool initialized = false;
+    std::vector<DOFEntry> dofs;
+    std::vector<OrientedSubEntity> orientedSubEntities;
+    std::string error;
+  };
+
+  // Precompute the DOF tables for all geometry types of the grid view. This uses
+  // the local finite elements of the node bound to one element of each geometry type.
+  template<class N>
+  void initializeDOFTables(N& node)
+  {
+    dofTables_.assign(LocalGeometryTypeIndex::size(dim), DOFTable{});
+    std::size_t missingTypes = 0;
+    for ([[maybe_unused]] const GeometryType& type : gridView_.indexSet().types(0))
+      ++missingTypes;
+    if (missingTypes == 0)
+      return;
+    for (const auto& element : elements(gridView_))
+    {
+      auto& dofTable = dofTables_[LocalGeometryTypeIndex::index(element.type())];
+      if (dofTable.initialized)
+        continue;
+      node.bind(element);
+      dofTable = makeDOFTable(element.type(), node.finiteElement());
+      if (--missingTypes == 0)
+        break;
+    }
+  }
+
+  // On Cartesian grids whose elements form a box of N_0 x ... x N_{dim-1} elements, the
+  // global index of the j-th local DOF of the element at position p in the box is an
+  // affine function
+  //
+  //   offset_j + sum_i stride_ji * p_i
+  //
+  // The elements must be numbered lexicographically in the box, as by YaspGrid, such
+  // that the position of an element is obtained from its index. The offsets and strides
+  // are fitted to the generic indices of the element at the origin of the box and its
+  // neighbors, and then verified on all elements. Hence the numbering is the same as
+  // the generic one. If the grid view is not such a box or the generic indices are not
+  // affine, the tables remain empty and the generic implementation is used.
+  template<class N>
+  void initializeStructuredIndices(N& node)
+  {
+    using ctype = typename GV::ctype;
+    using Element = typename GV::template Codim<0>::Entity;
+
+    structuredLocalOffsets_.clear();
+    structuredStrides_.clear();
+    if (gridView_.size(0) == 0)
+      return;
+
+    // Collect the coordinates of the lower left corners of all elements in all directions.
+    // All elements must be axis-parallel with local coordinates oriented like the global ones.
+    const auto& indexSet = gridView_.indexSet();
+    std::array<std::vector<ctype>, dim> corners;
+    ctype extent = 0;
+    std::optional<Element> origin;
+    for (const auto& element : elements(gridView_))
+    {
+      const auto geometry = element.geometry();
+      auto lower = geometry.corner(0);
+      auto upper = geometry.corner(geometry.corners()-1);
+      for (int i = 0; i < dim; ++i)
+      {
+        if (not (lower[i] < upper[i]))
+          return;
+        corners[i].push_back(lower[i]);
+        extent = std::max(extent, upper[i] - lower[i]);
+      }
+      if (indexSet.index(element) == 0)
+        origin = element;
+    }
+
+    // Remove duplicate coordinates with a tolerance relative to the element size
+    auto tolerance = 1e-8*extent;
+    size_type elementCount = 1;
+    for (int i = 0; i < dim; ++i)
+    {
+      std::sort(corners[i].begin(), corners[i].end());
+      corners[i].erase(std::unique(corners[i].begin(), corners[i].end(), [&](auto a, auto b) {
+        return b - a < tolerance;
+      }), corners[i].end());
+      structuredElementCounts_[i] = corners[i].size();
+      elementCount *= corners[i].size();
+    }
+    if ((elementCount != (size_type)gridView_.size(0)) or (not origin))
+      return;
+
+    // Check if the element at the given position is the given element
+    auto isAtPosition = [&](const Element& element, const std::array<std::ptrdiff_t, dim>& position) {
+      auto lower = element.geometry().corner(0);
+      for (int i = 0; i < dim; ++i)
+        if (std::abs(lower[i] - corners[i][position[i]]) >= tolerance)
+          return false;
+      return true;
+    };
+
+    // The neighbors of the element at the origin of the box in all directions
+    std::array<std::optional<Element>, dim> neighbors;
+    for (const auto& intersection : intersections(gridView_, *origin))
+      if (intersection.neighbor() and (intersection.indexInInside() % 2 == 1))
+        neighbors[intersection.indexInInside()/2] = intersection.outside();
+
+    node.bind(*origin);
+    if (not node.finiteElement().type().isCube())
+      return;
+    const size_type n = node.size();
+    std::vector<std::array<size_type,1>> indices(n);
+    genericIndices(node, indices.begin());
+    std::vector<std::ptrdiff_t> localOffsets(n);
+    for (size_type j = 0; j < n; ++j)
+      localOffsets[j] = indices[j][0];
+    std::vector<std::ptrdiff_t> strides(n*dim, 0);
+    for (int i = 0; i < dim; ++i)
+    {
+      if (not neighbors[i])
+        continue;
+      node.bind(*neighbors[i]);
+      genericIndices(node, indices.begin());
+      for (size_type j = 0; j < n; ++j)
+        strides[j*dim + i] = std::ptrdiff_t(indices[j][0]) - localOffsets[j];
+    }
+
+    // Check the lexicographic numbering of the elements and
+    // the affine indices against the generic ones
+    for (const auto& element : elements(gridView_))
+    {
+      const auto position = structuredElementPosition(indexSet.index(element));
+      if (not isAtPosition(element, position))
+        return;
+      node.bind(element);
+      genericIndices(node, indices.begin());
+      for (size_type j = 0; j < n; ++j)
+      {
+        auto index = localOffsets[j];
+        for (int i = 0; i < dim; ++i)
+          index += strides[j*dim + i]*position[i];
+        if (index != std::ptrdiff_t(indices[j][0]))
+          return;
+      }
+    }
+
+    structuredLocalOffsets_ = std::move(localOffsets);
+    structuredStrides_ = std::move(strides);
+  }
+
+  // Position of the element with the given index in a lexicographically numbered box of elements
+  std::array<std::ptrdiff_t, dim> structuredElementPosition(size_type elementIndex) const
+  {
+    std::array<std::ptrdiff_t, dim> position;
+    for (int i = 0; i < dim; ++i)
+    {
+      position[i] = elementIndex % structuredElementCounts_[i];
+      elementIndex /= structuredElementCounts_[i];
+    }
+    return position;
+  }
+
+  // Index of the Lagrange node with coordinate x on the reference edge [0,1],
+  // or -1 if there is no such node. If latticePoints_ is empty, the nodes
+  // are equidistant.
+  int latticeIndex(double x) const
+  {
+    if (latticePoints_.empty())
+    {
+      auto l = std::lround(x*order());
+      return (std::abs(x*order() - l) < 1e-8) ? int(l) : -1;
+    }
+    for (std::size_t l = 0; l < latticePoints_.size(); ++l)
+      if (std::abs(x - latticePoints_[l]) < 1e-8)
+        return l;
+    return -1;
+  }
+
+  template<class FiniteElement>
+  DOFTable makeDOFTable(const GeometryType& type, const FiniteElement& finiteElement) const
+  {
+    DOFTable dofTable;
+    dofTable.initialized = true;
+    dofTable.dofs.resize(finiteElement.size());
+    const auto refElement = Dune::referenceElement<double,dim>(type);
+
+    std::vector<FieldVector<double,dim>> positions;
+    if (dim > 1)
+      positions = Impl::lagrangeNodePositions<dim>(finiteElement);
+
+    // Index of the oriented sub-entity for all sub-entities of codim 1 and 2
+    std::array<std::vector<int>, dim+1> orientedSubEntityIndex;
+    for (int codim = 0; codim <= dim; ++codim)
+      orientedSubEntityIndex[codim].resize(refElement.size(codim), -1);
+
+    for (size_type i = 0; i < finiteElement.size(); ++i)
+    {
+      Dune::LocalKey localKey = finiteElement.localCoefficients().localKey(i);
+      auto& dof = dofTable.dofs[i];
+      dof.subEntity = localKey.subEntity();
+      dof.codim = localKey.codim();
 
       // The dimension of the entity that the current dof is related to
       auto dofDim = dim - localKey.codim();
 
-      // Test for a vertex dof
-      // The test for k==1 is redundant, but having it here allows the compiler to conclude
-      // at compile-time that the dofDim==0 case is the only one that will ever happen.
-      // This leads to measurable speed-up: see
-      //   https://gitlab.dune-project.org/staging/dune-functions/issues/30
-      if (k==1 || dofDim==0) {
-        *it = {{ (size_type)(gridIndexSet.subIndex(element,localKey.subEntity(),dim)) }};
+      if (dofDim==0)
+      {  // vertex dof
+        dof.offset = vertexOffset_;
         continue;
       }
 
-      if (dofDim==1)
-        {  // edge dof
-          if (dim==1)  // element dof -- any local numbering is fine
-            {
-              *it = {{ edgeOffset_
-                       + dofsPerCube(1) * ((size_type)gridIndexSet.subIndex(element,0,0))
-                       + localKey.index() }};
-              continue;
-            }
-          else
-            {
-              const auto refElement
-                = Dune::referenceElement<double,dim>(element.type());
-
-              // We have to reverse the numbering if the local element edge is
-              // not aligned with the global edge.
-              auto v0 = (size_type)gridIndexSet.subIndex(element,refElement.subEntity(localKey.subEntity(),localKey.codim(),0,dim),dim);
-              auto v1 = (size_type)gridIndexSet.subIndex(element,refElement.subEntity(localKey.subEntity(),localKey.codim(),1,dim),dim);
-              bool flip = (v0 > v1);
-              *it = {{ (flip)
-                       ? edgeOffset_
-                       + dofsPerCube(1)*((size_type)gridIndexSet.subIndex(element,localKey.subEntity(),localKey.codim()))
-                       + (dofsPerCube(1)-1)-localKey.index()
-                       : edgeOffset_
-                       + dofsPerCube(1)*((size_type)gridIndexSet.subIndex(element,localKey.subEntity(),localKey.codim()))
-                       + localKey.index() }};
-              continue;
-            }
+      if (dofDim==dim)
+      {  // element dof -- any local numbering is fine
+        dof.localIndex = localKey.index();
+        if (dim==1)
+        {
+          dof.offset = edgeOffset_;
+          dof.stride = dofsPerCube(1);
         }
-
-      if (dofDim==2)
+        else if (type.isTriangle())
         {
-          if (dim==2)   // element dof -- any local numbering is fine
-            {
-              if (element.type().isTriangle())
-                {
-                  *it = {{ triangleOffset_ + dofsPerSimplex(2)*((size_type)gridIndexSet.subIndex(element,0,0)) + localKey.index() }};
-                  continue;
-                }
-              else if (element.type().isQuadrilateral())
-                {
-                  *it = {{ quadrilateralOffset_ + dofsPerCube(2)*((size_type)gridIndexSet.subIndex(element,0,0)) + localKey.index() }};
-                  continue;
-                }
-              else
-                DUNE_THROW(Dune::NotImplemented, "2d elements have to be triangles or quadrilaterals");
-            } else
-            {
-              const auto refElement
-                = Dune::referenceElement<double,dim>(element.type());
-
-              if (order()>3)
-                DUNE_THROW(Dune::NotImplemented, "LagrangeBasis for 3D grids is only implemented if k<=3");
-
-              if (order()==3 and !refElement.type(localKey.subEntity(), localKey.codim()).isTriangle())
-                DUNE_THROW(Dune::NotImplemented, "LagrangeBasis for 3D grids with k==3 is only implemented if the grid is a simplex grid");
-
-              *it = {{ triangleOffset_ + ((size_type)gridIndexSet.subIndex(element,localKey.subEntity(),localKey.codim())) }};
-              continue;
-            }
+          dof.offset = triangleOffset_;
+          dof.stride = dofsPerSimplex(2);
         }
-
-      if (dofDim==3)
+        else if (type.isQuadrilateral())
+        {
+          dof.offset = quadrilateralOffset_;
+          dof.stride = dofsPerCube(2);
+        }
+        else if (type.isTetrahedron())
+        {
+          dof.offset = tetrahedronOffset_;
+          dof.stride = dofsPerSimplex(3);
+        }
+        else if (type.isHexahedron())
+        {
+          dof.offset = hexahedronOffset_;
+          dof.stride = dofsPerCube(3);
+        }
+        else if (type.isPrism())
+        {
+          dof.offset = prismOffset_;
+          dof.stride = dofsPerPrism();
+        }
+        else if (type.isPyramid())
+        {
+          dof.offset = pyramidOffset_;
+          dof.stride = dofsPerPyramid();
+        }
+        else
         {
-          if (dim==3)   // element dof -- any local numbering is fine
-            {
-              if (element.type().isTetrahedron())
-                {
-                  *it = {{ tetrahedronOffset_ + dofsPerSimplex(3)*((size_type)gridIndexSet.subIndex(element,0,0)) + localKey.index() }};
-                  continue;
-                }
-              else if (element.type().isHexahedron())
-                {
-                  *it = {{ hexahedronOffset_ + dofsPerCube(3)*((size_type)gridIndexSet.subIndex(element,0,0)) + localKey.index() }};
-                  continue;
-                }
-              else if (element.type().isPrism())
-                {
-                  *it = {{ prismOffset_ + dofsPerPrism()*((size_type)gridIndexSet.subIndex(element,0,0)) + localKey.index() }};
-                  continue;
-                }
-              else if (element.type().isPyramid())
-                {
-                  *it = {{ pyramidOffset_ + dofsPerPyramid()*((size_type)gridIndexSet.subIndex(element,0,0)) + localKey.index() }};
-                  continue;
-                }
-              else
-                DUNE_THROW(Dune::NotImplemented, "3d elements have to be tetrahedra, hexahedra, prisms, or pyramids");
-            } else
-            DUNE_THROW(Dune::NotImplemented, "Grids of dimension larger than 3 are no supported");
+          dofTable.error = (dim==2)
+            ? "2d elements have to be triangles or quadrilaterals"
+            : ((dim==3)
+              ? "3d elements have to be tetrahedra, hexahedra, prisms, or pyramids"
+              : "Grids of dimension larger than 3 are no supported");
+          return dofTable;
         }
-      DUNE_THROW(Dune::NotImplemented, "Grid contains elements not supported for the LagrangeBasis");
+        continue;
+      }
+
+      // DOF in the interior of an edge or a face of a 3d element
+      auto subEntityType = refElement.type(localKey.subEntity(), localKey.codim());
+      if (dofDim==1)
+      {
+        dof.offset = edgeOffset_;
+        dof.stride = dofsPerCube(1);
+      }
+      else if (subEntityType.isTriangle())
+      {
+        dof.offset = triangleOffset_;
+        dof.stride = dofsPerSimplex(2);
+      }
+      else if (subEntityType.isQuadrilateral())
+      {
+        dof.offset = quadrilateralOffset_;
+        dof.stride = dofsPerCube(2);
+      }
+      else
+      {
+        dofTable.error = "Grid contains elements not supported for the LagrangeBasis";
+        return dofTable;
+      }
+
+      // A single DOF on the sub-entity does not depend on its orientation
+      if (dof.stride == 1)
+      {
+        dof.localIndex = 0;
+        continue;
+      }
+
+      auto& orientedIndex = orientedSubEntityIndex[localKey.codim()][localKey.subEntity()];
+      if (orientedIndex < 0)
+      {
+        orientedIndex = dofTable.orientedSubEntities.size();
+        auto& subEntity = dofTable.orientedSubEntities.emplace_back();
+        subEntity.size = dof.stride;
+        for (int m = 0; m < refElement.size(localKey.subEntity(),localKey.codim(),dim); ++m)
+          subEntity.vertices.push_back(refElement.subEntity(localKey.subEntity(),localKey.codim(),m,dim));
+      }
+      auto& subEntity = dofTable.orientedSubEntities[orientedIndex];
+      dof.orientedSubEntity = orientedIndex;
+      dof.localIndex = subEntity.lattice.size();
+
+      // Compute the lattice coordinates of the node within the sub-entity, see
+      // Impl::lagrangeCanonicalSubEntityIndex().
+      auto local = Impl::lagrangeSubEntityCoordinates(refElement, subEntity.vertices, subEntity.vertices.size(), positions[i]);
+      std::array<int,2> l = {{ latticeIndex(local[0]), latticeIndex(local[1]) }};
+      if (l[0] < 0 or l[1] < 0)
+      {
+        dofTable.error = "Lagrange nodes on edges and faces do not match the lattice of the LagrangeBasis";
+        return dofTable;
+      }
+      if (subEntity.vertices.size() == 4)
+        subEntity.lattice.push_back({{ l[0], l[1], 0, 0 }});
+      else
+        subEntity.lattice.push_back({{ int(order()) - l[0] - l[1], l[0], l[1], 0 }});
     }
-    return it;
+
+    // Precompute the local numbering of the DOFs on the sub-entities for all orientations
+    assert(dofTable.orientedSubEntities.size() <= maxOrientedSubEntities);
+    for (auto& subEntity : dofTable.orientedSubEntities)
+    {
+      auto n = subEntity.vertices.size();
+      if (subEntity.lattice.size() != subEntity.size)
+      {
+        dofTable.error = "Number of DOFs on a sub-entity does not match the LagrangeBasis";
+        return dofTable;
+      }
+
+      std::size_t orientations = 1;
+      for (std::size_t m = 2; m <= n; ++m)
+        orientations *= m;
+      subEntity.permutations.resize(orientations*subEntity.size);
+      std::array<std::size_t,4> ranks = {{0, 1, 2, 3}};
+      do {
+        auto code = Impl::lagrangeOrientationCode(ranks, n);
+        for (std::size_t j = 0; j < subEntity.size; ++j)
+          subEntity.permutations[code*subEntity.size + j] = Impl::lagrangeCanonicalSubEntityIndex(ranks, subEntity.lattice[j], n, order());
+      } while (std::next_permutation(ranks.begin(), ranks.begin()+n));
+    }
+    return dofTable;
   }
 
-  //! Polynomial order used in the local Lagrange finite-elements
-  unsigned int order() const
+  // Create the shared table of local finite elements for all geometry types of the grid view,
+  // unless the existing table already contains all of them. Nodes created before keep the old table.
+  void updateFiniteElementTable()
   {
-    return (useDynamicOrder) ? order_ : k;
+    const auto& types = gridView_.indexSet().types(0);
+    bool upToDate = (finiteElementTable_ != nullptr);
+    for (const GeometryType& type : types)
+      upToDate = upToDate and finiteElementTable_->contains(type);
+    if (not upToDate)
+      finiteElementTable_ = std::make_shared<const FiniteElementTable>(order_, types);
   }
 
-protected:
   GridView gridView_;
 
   // Run-time order, only valid if k<0
   unsigned int order_;
 
+  // Local finite elements shared by all nodes, only used if k<0
+  std::shared_ptr<const FiniteElementTable> finiteElementTable_;
+
+  // Coordinates of the Lagrange nodes on the reference edge, empty for equidistant nodes
+  std::vector<double> latticePoints_;
+
   //! Number of degrees of freedom assigned to a simplex (without the ones assigned to its faces!)
   size_type dofsPerSimplex(std::size_t simplexDim) const
   {
@@ -338,12 +894,22 @@ protected:
 
   size_type computeDofsPerPrism() const
   {
-    return order() == 0 ? (dim == 3 ? 1 : 0) : (order()-1)*(order()-1)*(order()-2)/2;
+    if (order() == 0)
+      return (dim == 3 ? 1 : 0);
+    if (order() < 3)
+      return 0;
+    size_type k1 = order()-1;
+    return k1*k1*(k1-1)/2;
   }
 
   size_type computeDofsPerPyramid() const
   {
-    return order() == 0 ? (dim == 3 ? 1 : 0) : (order()-2)*(order()-1)*(2*order()-3)/6;
+    if (order() == 0)
+      return (dim == 3 ? 1 : 0);
+    if (order() < 3)
+      return 0;
+    size_type k1 = order()-1;
+    return (k1-1)*k1*(2*k1-1)/6;
   }
 
   // When the order is given at run-time, the following numbers are pre-computed:
@@ -361,6 +927,15 @@ protected:
   size_type prismOffset_;
   size_type hexahedronOffset_;
 
+  // Precomputed DOF tables indexed by LocalGeometryTypeIndex
+  std::vector<DOFTable> dofTables_;
+
+  // Number of elements in all directions, and offsets and strides of
+  // the local DOFs for the closed form indices on structured grids
+  std::array<size_type, dim> structuredElementCounts_;
+  std::vector<std::ptrdiff_t> structuredLocalOffsets_;
+  std::vector<std::ptrdiff_t> structuredStrides_;
+
 };
 
 
@@ -369,38 +944,23 @@ template<typename GV, int k, typename R>
 class LagrangeNode :
   public LeafBasisNode
 {
-  // Stores LocalFiniteElement implementations with run-time order as a function of GeometryType
-  template<typename Domain, typename Range, int dim>
-  class LagrangeRunTimeLFECache
-  {
-  public:
-    using FiniteElementType = LagrangeLocalFiniteElement<EquidistantPointSet,dim,Domain,Range>;
-
-    const FiniteElementType& get(GeometryType type)
-    {
-      auto i = data_.find(type);
-      if (i==data_.end())
-        i = data_.emplace(type,FiniteElementType(type,order_)).first;
-      return (*i).second;
-    }
-
-    std::map<GeometryType, FiniteElementType> data_;
-    unsigned int order_;
-  };
-
   static constexpr int dim = GV::dimension;
   static constexpr bool useDynamicOrder = (k<0);
 
+  using FiniteElementTable = Impl::LagrangeRunTimeLFETable<typename GV::ctype, R, dim>;
+  using StaticFiniteElementCache = LagrangeLocalFiniteElementCache<typename GV::ctype, R, dim, std::max(k,0)>;
+
+  // With run-time order the node only holds a pointer to a table shared with other nodes
   using FiniteElementCache = std::conditional_t<(useDynamicOrder),
-                                                       LagrangeRunTimeLFECache<typename GV::ctype, R, dim>,
-                                                       LagrangeLocalFiniteElementCache<typename GV::ctype, R, dim, std::max(k,0)>
+                                                       std::shared_ptr<const FiniteElementTable>,
+                                                       StaticFiniteElementCache
                                                       >;
 
 public:
 
   using size_type = std::size_t;
   using Element = typename GV::template Codim<0>::Entity;
-  using FiniteElement = typename FiniteElementCache::FiniteElementType;
+  using FiniteElement = typename std::conditional_t<(useDynamicOrder), FiniteElementTable, StaticFiniteElementCache>::FiniteElementType;
 
   //! Constructor without order (uses the compile-time value)
   LagrangeNode() :
@@ -408,15 +968,32 @@ public:
     element_(nullptr)
   {}
 
-  //! Constructor with a run-time order
+  /** \brief Constructor with a run-time order
+   *
+   * If k<0 the node creates its own table of finite elements. It is filled
+   * lazily with the finite elements for the geometry types the node is bound to.
+   */
   LagrangeNode(unsigned int order) :
     order_(order),
     finiteElement_(nullptr),
     element_(nullptr)
+  {}
+
+  /** \brief Constructor with a run-time order and a table of finite elements shared with other nodes
+   *
+   * If the table does not contain the finite element for the geometry type
+   * of an element this node is bound to, the node switches to an extended
+   * copy of the table. The shared table itself is never modified.
+   * Only valid if k<0.
+   */
+  LagrangeNode(unsigned int order, std::shared_ptr<const FiniteElementTable> table) :
+    order_(order),
+    cache_(std::move(table)),
+    finiteElement_(nullptr),
+    element_(nullptr)
   {
-    // Only the cache for the run-time-order case (i.e., k<0), has the 'order_' member
-    if constexpr (useDynamicOrder)
-      cache_.order_ = order;
+    static_assert(useDynamicOrder, "A shared table of finite elements can only be used if k<0");
+    assert((not cache_) or (cache_->order() == order));
   }
 
   //! Return current element, throw if unbound
@@ -438,10 +1015,33 @@ public:
   void bind(const Element& e)
   {
     element_ = &e;
-    finiteElement_ = &(cache_.get(element_->type()));
+    if constexpr (useDynamicOrder)
+    {
+      const GeometryType type = element_->type();
+      if (not cache_)
+        cache_ = std::make_shared<const FiniteElementTable>(order_, std::array<GeometryType,1>{{type}});
+      else if (not cache_->contains(type))
+        cache_ = std::make_shared<const FiniteElementTable>(*cache_, type);
+      finiteElement_ = &(cache_->get(type));
+    }
+    else
+      finiteElement_ = &(cache_.get(element_->type()));
     this->setSize(finiteElement_->size());
   }
 
+  /** \brief Bind to the element the given node is bound to
+   *
+   * This shares the LocalFiniteElement of `other` instead of looking it up
+   * in the own cache. It is used to bind the children of power nodes.
+   * The node `other` must outlive the binding of this node.
+   */
+  void bindLike(const LagrangeNode& other)
+  {
+    element_ = other.element_;
+    finiteElement_ = other.finiteElement_;
+    this->setSize(other.size());
+  }
+
 protected:
 
   unsigned int order() const
@@ -500,10 +1100,9 @@ auto lagrange(int order)
  *
  * \ingroup FunctionSpaceBasesImplementations
  *
- * \note This only works for certain grids.  The following restrictions hold
- * - If k is no larger than 2, then the grids can have any dimension
- * - If k is larger than 3 then the grid must be two-dimensional
- * - If k is 3, then the grid can be 3d *if* it is a simplex grid
+ * \note This only works for grids of dimension at most 3. Arbitrary orders k are
+ * supported on all geometry types, except that for 3d grids with prisms or pyramids
+ * and k larger than 2 the order has to be given at run-time (k=-1).
  *
  * All arguments passed to the constructor will be forwarded to the constructor
  * of LagrangePreBasis.
@@ -4,9 +4,17 @@
 #define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_LAGRANGEDGBASIS_HH
 
 #include <array>
+#include <cassert>
+#include <type_traits>
+#include <utility>
+
 #include <dune/common/exceptions.hh>
 #include <dune/common/math.hh>
 
+#include <dune/grid/common/capabilities.hh>
+
+#include <dune/functions/functionspacebases/basistags.hh>
+#include <dune/functions/functionspacebases/containerdescriptors.hh>
 #include <dune/functions/functionspacebases/nodes.hh>
 #include <dune/functions/functionspacebases/defaultglobalbasis.hh>
 #include <dune/functions/functionspacebases/lagrangebasis.hh>
@@ -34,11 +42,32 @@ namespace Functions {
 template<typename GV, int k>
 using LagrangeDGNode = LagrangeNode<GV, k>;
 
-template<typename GV, int k>
+/**
+ * \brief A pre-basis for discontinuous Lagrange bases of order k
+ *
+ * \ingroup FunctionSpaceBasesImplementations
+ *
+ * \tparam GV  The grid view that the FE basis is defined on
+ * \tparam k   The polynomial order of ansatz functions
+ * \tparam IMS The index layout, either BasisFactory::FlatLexicographic for flat indices
+ *             or BasisFactory::BlockedLexicographic for two-level indices (e,i), where e
+ *             is the index of the element and i the index of the DOF within the element
+ *
+ * \note The blocked layout requires that all elements have the same geometry type,
+ *   such that all element blocks have the same size.
+ */
+template<typename GV, int k, class IMS = BasisFactory::FlatLexicographic>
 class LagrangeDGPreBasis :
-  public LeafPreBasisMixin< LagrangeDGPreBasis<GV,k> >
+  public LeafPreBasisMixin< LagrangeDGPreBasis<GV,k,IMS> >
 {
+  using Base = LeafPreBasisMixin< LagrangeDGPreBasis<GV,k,IMS> >;
+
   static const int dim = GV::dimension;
+  static const bool isCartesian = Dune::Capabilities::isCartesian<typename GV::Grid>::v;
+  static const bool isBlocked = std::is_same_v<IMS, BasisFactory::BlockedLexicographic>;
+
+  static_assert(isBlocked or std::is_same_v<IMS, BasisFactory::FlatLexicographic>,
+    "LagrangeDGPreBasis only supports FlatLexicographic and BlockedLexicographic index layouts");
 
 public:
 
@@ -46,6 +75,18 @@ public:
   using GridView = GV;
   using size_type = std::size_t;
 
+  //! Strategy used to lay out the indices of the element DOFs
+  using IndexMergingStrategy = IMS;
+
+  //! Maximal length of global multi-indices
+  static constexpr size_type maxMultiIndexSize = isBlocked ? 2 : 1;
+
+  //! Minimal length of global multi-indices
+  static constexpr size_type minMultiIndexSize = isBlocked ? 2 : 1;
+
+  //! Size required temporarily when constructing global multi-indices
+  static constexpr size_type multiIndexBufferSize = isBlocked ? 2 : 1;
+
 
   // Precompute the number of dofs per entity type
   const static int dofsPerEdge        = k+1;
@@ -67,6 +108,16 @@ public:
 
   void initializeIndices()
   {
+    if constexpr (isBlocked)
+    {
+      std::size_t types = 0;
+      for ([[maybe_unused]] const auto& type : gridView_.indexSet().types(0))
+        ++types;
+      if (types > 1)
+        DUNE_THROW(Dune::NotImplemented, "The blocked LagrangeDGPreBasis requires a grid view with a single geometry type");
+      blockSize_ = (gridView_.size(0) > 0) ? dimension()/gridView_.size(0) : 0;
+    }
+
     switch (dim)
     {
       case 1:
@@ -136,14 +187,61 @@ public:
     return Dune::power(k+1, int(GV::dimension));
   }
 
+  //! Return number of possible values for next position in multi index
+  template<class SizePrefix,
+    decltype(std::declval<SizePrefix>().size(), bool{}) = true>
+  size_type size(const SizePrefix& prefix) const
+  {
+    if constexpr (isBlocked)
+    {
+      assert(prefix.size() <= 2);
+      if (prefix.size() == 0)
+        return gridView_.size(0);
+      return (prefix.size() == 1) ? blockSize_ : 0;
+    }
+    else
+      return Base::size(prefix);
+  }
+
+  //! Return number of possible values for the first position in multi indices
+  size_type size() const
+  {
+    if constexpr (isBlocked)
+      return gridView_.size(0);
+    else
+      return Base::size();
+  }
+
+  //! Return a container-descriptor, which is a uniform vector of element blocks in the blocked layout
+  auto containerDescriptor() const
+  {
+    if constexpr (isBlocked)
+      return ContainerDescriptors::makeUniformDescriptor(gridView_.size(0), ContainerDescriptors::FlatVector{blockSize_});
+    else
+      return Base::containerDescriptor();
+  }
+
   template<typename It>
   It indices(const Node& node, It it) const
   {
     const auto& gridIndexSet = gridView().indexSet();
     const auto& element = node.element();
 
+    if constexpr (isBlocked)
+    {
+      auto elementIndex = gridIndexSet.index(element);
+      for (size_type i = 0, end = node.size() ; i < end ; ++i, ++it)
+        *it = {{ (size_type)elementIndex, i }};
+      return it;
+    }
+
     size_type offset = 0;
-    if constexpr (dim==1)
+    if constexpr (isCartesian)
+    {
+      // All elements of Cartesian grids are cubes, hence all other offsets are zero
+      offset = Dune::power(k+1, dim)*gridIndexSet.index(element);
+    }
+    else if constexpr (dim==1)
       offset = dofsPerEdge*gridIndexSet.subIndex(element,0,0);
     else if constexpr (dim==2)
     {
@@ -187,6 +285,9 @@ protected:
   size_t pyramidOffset_;
   size_t prismOffset_;
   size_t hexahedronOffset_;
+
+  // Number of DOFs per element, only used for the blocked layout
+  size_type blockSize_ = 0;
 };
 
 
@@ -208,6 +309,22 @@ auto lagrangeDG()
   };
 }
 
+/**
+ * \brief Create a pre-basis factory that can create a LagrangeDG pre-basis with the given index layout
+ *
+ * \ingroup FunctionSpaceBasesImplementations
+ *
+ * \tparam k   The polynomial order of the ansatz functions
+ * \tparam IMS Either FlatLexicographic or BlockedLexicographic, see LagrangeDGPreBasis
+ */
+template<std::size_t k, class IMS>
+auto lagrangeDG(const IMS&)
+{
+  return [](const auto& gridView) {
+    return LagrangeDGPreBasis<std::decay_t<decltype(gridView)>, k, IMS>(gridView);
+  };
+}
+
 } // end namespace BasisFactory
 
 
@@ -222,9 +339,10 @@ auto lagrangeDG()
  *
  * \tparam GV The GridView that the space is defined on
  * \tparam k The order of the basis
+ * \tparam IMS The index layout, see LagrangeDGPreBasis
  */
-template<typename GV, int k>
-using LagrangeDGBasis = DefaultGlobalBasis<LagrangeDGPreBasis<GV, k> >;
+template<typename GV, int k, class IMS = BasisFactory::FlatLexicographic>
+using LagrangeDGBasis = DefaultGlobalBasis<LagrangeDGPreBasis<GV, k, IMS> >;
 
 
 
@@ -0,0 +1,156 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_LAGRANGEORDERTRANSFER_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_LAGRANGEORDERTRANSFER_HH
+
+#include <cstddef>
+#include <limits>
+#include <utility>
+#include <vector>
+
+#include <dune/common/dynmatrix.hh>
+
+#include <dune/geometry/typeindex.hh>
+
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <dune/functions/functionspacebases/basisinterpolation.hh>
+#include <dune/functions/functionspacebases/elementtransferoperator.hh>
+
+namespace Dune {
+namespace Functions {
+
+
+
+/**
+ * \brief Transfer operators between scalar Lagrange bases of different order
+ *
+ * \ingroup FunctionSpaceBasesUtilities
+ *
+ * This provides the prolongation P from a coarse basis of order p to a fine
+ * basis of order q on the same grid view, e.g. for p-multigrid methods. The
+ * coefficients of the prolongation of a coarse function are the coefficients
+ * of its interpolant in the fine basis. Hence P is exact for p<=q. The restriction
+ * is the transposed matrix \f$ P^T \f$.
+ *
+ * The local interpolation matrix only depends on the geometry type of the element.
+ * It is computed once per geometry type, and the operators are applied by gathering
+ * the coarse coefficients of an element, multiplying by the local matrix, and
+ * scattering the result. Each fine DOF is written by a single element only, its
+ * owner, such that the element loops can be run in parallel.
+ *
+ * Both bases must have a leaf tree, flat multi-indices, and local finite
+ * elements that only depend on the geometry type, like `LagrangeBasis`.
+ * The coefficient vectors must provide `x[i]` access. The object has to
+ * be recreated if one of the bases changes.
+ *
+ * \tparam CB Type of the coarse global basis
+ * \tparam FB Type of the fine global basis
+ * \tparam F Field type of the transfer matrices
+ */
+template<class CB, class FB, class F = double>
+class LagrangeOrderTransfer
+{
+  using CoarseBasis = CB;
+  using FineBasis = FB;
+  using Field = F;
+  using GridView = typename CoarseBasis::GridView;
+  using size_type = std::size_t;
+
+  static constexpr int dim = GridView::dimension;
+
+public:
+
+  //! Precompute the local transfer matrices and the global indices of all elements
+  LagrangeOrderTransfer(const CB& coarseBasis, const FB& fineBasis) :
+    transfer_(coarseBasis.dimension(), fineBasis.dimension()),
+    matrixIndices_(LocalGeometryTypeIndex::size(dim), noMatrix)
+  {
+    static_assert(CoarseBasis::LocalView::Tree::isLeaf and FineBasis::LocalView::Tree::isLeaf,
+      "LagrangeOrderTransfer requires bases with a leaf tree");
+
+    auto coarseLocalView = coarseBasis.localView();
+    auto fineLocalView = fineBasis.localView();
+    std::vector<size_type> coarseIndices, fineIndices;
+    for (const auto& element : elements(coarseBasis.gridView()))
+    {
+      coarseLocalView.bind(element);
+      fineLocalView.bind(element);
+      auto& matrixIndex = matrixIndices_[LocalGeometryTypeIndex::index(element.type())];
+      if (matrixIndex == noMatrix)
+      {
+        DynamicMatrix<Field> localMatrix;
+        Impl::localTransferMatrix(coarseLocalView.tree().finiteElement(), fineLocalView.tree().finiteElement(), localMatrix);
+        matrixIndex = transfer_.addLocalMatrix(std::move(localMatrix));
+      }
+
+      coarseIndices.resize(coarseLocalView.size());
+      for (size_type j = 0; j < coarseLocalView.size(); ++j)
+        coarseIndices[j] = coarseLocalView.index(j)[0];
+      fineIndices.resize(fineLocalView.size());
+      for (size_type i = 0; i < fineLocalView.size(); ++i)
+        fineIndices[i] = fineLocalView.index(i)[0];
+      transfer_.addElement(matrixIndex, coarseIndices, fineIndices);
+    }
+  }
+
+  /**
+   * \brief Compute fine = P coarse
+   *
+   * \param coarse Coefficient vector of the coarse basis
+   * \param fine Coefficient vector of the fine basis, which must already have the right size
+   * \param threads Number of threads used for the element loop
+   */
+  template<class CoarseVector, class FineVector>
+  void applyProlongation(const CoarseVector& coarse, FineVector& fine, std::size_t threads = 1) const
+  {
+    transfer_.applyProlongation(coarse, fine, threads);
+  }
+
+  /**
+   * \brief Compute coarse = P^T fine
+   *
+   * \param fine Coefficient vector of the fine basis
+   * \param coarse Coefficient vector of the coarse basis, which must already have the right size
+   * \param threads Number of threads used for the element loop
+   */
+  template<class FineVector, class CoarseVector>
+  void applyRestriction(const FineVector& fine, CoarseVector& coarse, std::size_t threads = 1) const
+  {
+    transfer_.applyRestriction(fine, coarse, threads);
+  }
+
+  /**
+   * \brief Assemble the prolongation matrix
+   *
+   * Entries with absolute value below the given tolerance are omitted.
+   *
+   * \param matrix A sparse matrix like `BCRSMatrix<double>` with fine rows and coarse columns
+   * \param tolerance Threshold for omitting entries
+   */
+  template<class Matrix>
+  void assembleProlongationMatrix(Matrix& matrix, Field tolerance = 1e-12) const
+  {
+    transfer_.assembleProlongationMatrix(matrix, tolerance);
+  }
+
+  //! Return the local transfer matrix for the given geometry type
+  const DynamicMatrix<Field>& localMatrix(const GeometryType& type) const
+  {
+    return transfer_.localMatrix(matrixIndices_[LocalGeometryTypeIndex::index(type)]);
+  }
+
+private:
+
+  static constexpr size_type noMatrix = std::numeric_limits<size_type>::max();
+
+  Impl::ElementTransferOperator<Field> transfer_;
+  std::vector<size_type> matrixIndices_;
+};
+
+
+
+} // end namespace Functions
+} // end namespace Dune
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_LAGRANGEORDERTRANSFER_HH
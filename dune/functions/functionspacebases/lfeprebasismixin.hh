@@ -152,6 +152,14 @@ public:
     this->setSize(lfe_->size());
   }
 
+  //! Bind to the element the given node is bound to, sharing its local finite-element.
+  void bindLike (const Node& other)
+  {
+    lfe_ = other.lfe_;
+    element_ = other.element_;
+    this->setSize(other.size());
+  }
+
 protected:
   const FiniteElement* lfe_;
   const Element* element_;
@@ -0,0 +1,499 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_MODALDGBASIS_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_MODALDGBASIS_HH
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <numeric>
+#include <type_traits>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fmatrix.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/math.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+#include <dune/geometry/type.hh>
+
+#include <dune/localfunctions/common/localbasis.hh>
+#include <dune/localfunctions/common/localfiniteelementtraits.hh>
+#include <dune/localfunctions/common/localkey.hh>
+
+#include <dune/functions/functionspacebases/defaultglobalbasis.hh>
+#include <dune/functions/functionspacebases/lfeprebasismixin.hh>
+
+
+namespace Dune {
+namespace Functions {
+
+namespace Impl {
+
+  // Evaluate the scaled Jacobi polynomials q_n(t,w) = w^n P_n^{(a,0)}(t/w) for n=0,...,k
+  // and their partial derivatives with respect to t and w. The homogenized three-term
+  // recurrence does not divide by w. Hence it is well-defined in the collapsed vertex
+  // of a simplex, where w vanishes. The arrays must have at least k+1 entries.
+  template<class R, std::size_t N>
+  void scaledJacobi(int k, R a, R t, R w, std::array<R,N>& q, std::array<R,N>& dqdt, std::array<R,N>& dqdw)
+  {
+    assert(std::size_t(k) < N);
+    q[0] = 1;
+    dqdt[0] = 0;
+    dqdw[0] = 0;
+    if (k == 0)
+      return;
+    q[1] = ((a+2)*t + a*w)/2;
+    dqdt[1] = (a+2)/2;
+    dqdw[1] = a/2;
+    for (int n = 2; n <= k; ++n)
+    {
+      R A = (2*n+a)*(2*n+a-2);
+      R B = a*a;
+      R c1 = 2*n+a-1;
+      R c2 = 2*(n+a-1)*(n-1)*(2*n+a);
+      R d = 2*n*(n+a)*(2*n+a-2);
+      R s = A*t + B*w;
+      q[n] = (c1*s*q[n-1] - c2*w*w*q[n-2])/d;
+      dqdt[n] = (c1*(A*q[n-1] + s*dqdt[n-1]) - c2*w*w*dqdt[n-2])/d;
+      dqdw[n] = (c1*(B*q[n-1] + s*dqdw[n-1]) - c2*(2*w*q[n-2] + w*w*dqdw[n-2]))/d;
+    }
+  }
+
+
+
+  /**
+   * \brief Orthonormal modal shape functions of order k on a cube or simplex
+   *
+   * On cubes these are tensor products of Legendre polynomials, on simplices
+   * the Dubiner polynomials built from Jacobi polynomials in collapsed coordinates.
+   * Both are orthonormal in L2 of the reference element. The shape functions
+   * are sorted by their degree, i.e., the maximal degree per direction on cubes
+   * and the total degree on simplices. Hence the first truncatedSize(j) shape
+   * functions span the polynomials of order j.
+   */
+  template<class D, class R, int dim, int k>
+  class ModalDGLocalBasis
+  {
+    using Degrees = std::array<int,dim>;
+
+  public:
+    using Domain = FieldVector<D,dim>;
+    using Range = FieldVector<R,1>;
+    using Jacobian = FieldMatrix<R,1,dim>;
+    using Traits = LocalBasisTraits<D,dim,Domain,R,1,Range,Jacobian>;
+    using OrderArray = std::array<unsigned int,dim>;
+
+    ModalDGLocalBasis(const GeometryType& type)
+      : simplex_(type.isSimplex())
+    {
+      if (not (type.isCube() or type.isSimplex()) or type.dim() != dim)
+        DUNE_THROW(NotImplemented, "ModalDGLocalBasis is only implemented for cubes and simplices of dimension " << dim);
+
+      // Enumerate the degrees lexicographically and sort them stably by the order
+      Degrees degrees;
+      degrees.fill(0);
+      while (true)
+      {
+        if (not simplex_ or std::accumulate(degrees.begin(), degrees.end(), 0) <= k)
+          degrees_.push_back(degrees);
+        int j = 0;
+        while (j < dim and degrees[j] == k)
+          degrees[j++] = 0;
+        if (j == dim)
+          break;
+        ++degrees[j];
+      }
+      std::stable_sort(degrees_.begin(), degrees_.end(), [&](const auto& a, const auto& b) {
+        return order(a) < order(b);
+      });
+
+      // Normalize the polynomials in L2 of the reference element
+      scale_.assign(size(), R(1));
+      std::vector<R> norms(size(), R(0));
+      std::vector<Range> values;
+      for (const auto& quadPoint : QuadratureRules<D,dim>::rule(type, 2*k))
+      {
+        evaluateFunction(quadPoint.position(), values);
+        for (std::size_t i = 0; i < size(); ++i)
+          norms[i] += values[i][0]*values[i][0]*quadPoint.weight();
+      }
+      using std::sqrt;
+      for (std::size_t i = 0; i < size(); ++i)
+        scale_[i] = 1/sqrt(norms[i]);
+    }
+
+    //! Number of shape functions
+    std::size_t size() const
+    {
+      return degrees_.size();
+    }
+
+    //! Number of leading shape functions spanning the polynomials of the given order
+    std::size_t truncatedSize(unsigned int order) const
+    {
+      return std::count_if(degrees_.begin(), degrees_.end(), [&](const auto& degrees) {
+        return this->order(degrees) <= int(order);
+      });
+    }
+
+    void evaluateFunction(const Domain& x, std::vector<Range>& out) const
+    {
+      evaluate(x, [&](std::size_t i, R value, const auto&) {
+        out[i] = scale_[i]*value;
+      }, out, false);
+    }
+
+    void evaluateJacobian(const Domain& x, std::vector<Jacobian>& out) const
+    {
+      evaluate(x, [&](std::size_t i, R, const auto& gradient) {
+        for (int l = 0; l < dim; ++l)
+          out[i][0][l] = scale_[i]*gradient[l];
+      }, out, true);
+    }
+
+    void partial(const OrderArray& order, const Domain& x, std::vector<Range>& out) const
+    {
+      auto totalOrder = std::accumulate(order.begin(), order.end(), 0u);
+      if (totalOrder == 0)
+        return evaluateFunction(x, out);
+      if (totalOrder == 1)
+      {
+        auto l = std::distance(order.begin(), std::find(order.begin(), order.end(), 1u));
+        evaluate(x, [&](std::size_t i, R, const auto& gradient) {
+          out[i] = scale_[i]*gradient[l];
+        }, out, true);
+        return;
+      }
+      DUNE_THROW(RangeError, "partial() not implemented for given order");
+    }
+
+    unsigned int order() const
+    {
+      return k;
+    }
+
+  private:
+
+    int order(const Degrees& degrees) const
+    {
+      if (simplex_)
+        return std::accumulate(degrees.begin(), degrees.end(), 0);
+      return *std::max_element(degrees.begin(), degrees.end());
+    }
+
+    // Evaluate the unscaled polynomials and pass their values and gradients to the callback.
+    //
+    // Shape function n is the product over the directions j of the scaled Jacobi polynomials
+    // q_{n_j}(t_j,w_j) with parameter a_j. On cubes t_j=2x_j-1, w_j=1, and a_j=0. On simplices
+    // t_j=2x_j-1+s_j and w_j=1-s_j with s_j=x_{j+1}+...+x_{dim-1}, and a_j=2(n_0+...+n_{j-1})+j.
+    template<class Callback, class Out>
+    void evaluate(const Domain& x, Callback&& callback, Out& out, bool gradients) const
+    {
+      out.resize(size());
+
+      // Jacobi polynomials per direction j and offset m=n_0+...+n_{j-1}. Their number
+      // is bounded by k, hence they are stored on the stack.
+      std::array<std::array<std::array<std::array<R,k+1>,3>,k+1>,dim> q;
+      std::array<std::array<FieldVector<R,dim>,2>,dim> dtw;
+      for (int j = 0; j < dim; ++j)
+      {
+        R s = 0;
+        dtw[j][0] = 0;
+        dtw[j][1] = 0;
+        if (simplex_)
+          for (int l = j+1; l < dim; ++l)
+          {
+            s += x[l];
+            dtw[j][0][l] = 1;
+            dtw[j][1][l] = -1;
+          }
+        dtw[j][0][j] = 2;
+        R t = 2*x[j] - 1 + s;
+        R w = 1 - s;
+        int offsets = (simplex_ and j > 0) ? k+1 : 1;
+        for (int m = 0; m < offsets; ++m)
+          scaledJacobi(simplex_ ? k-m : k, R(simplex_ ? 2*m+j : 0), t, w, q[j][m][0], q[j][m][1], q[j][m][2]);
+      }
+
+      std::array<R,dim> values;
+      std::array<FieldVector<R,dim>,dim> factorGradients;
+      FieldVector<R,dim> gradient;
+      for (std::size_t i = 0; i < size(); ++i)
+      {
+        const auto& degrees = degrees_[i];
+        int m = 0;
+        for (int j = 0; j < dim; ++j)
+        {
+          const auto& qj = q[j][simplex_ ? m : 0];
+          values[j] = qj[0][degrees[j]];
+          if (gradients)
+          {
+            factorGradients[j] = dtw[j][0];
+            factorGradients[j] *= qj[1][degrees[j]];
+            factorGradients[j].axpy(qj[2][degrees[j]], dtw[j][1]);
+          }
+          m += degrees[j];
+        }
+        R value = 1;
+        for (int j = 0; j < dim; ++j)
+          value *= values[j];
+        gradient = 0;
+        if (gradients)
+          for (int j = 0; j < dim; ++j)
+          {
+            R factor = 1;
+            for (int l = 0; l < dim; ++l)
+              if (l != j)
+                factor *= values[l];
+            gradient.axpy(factor, factorGradients[j]);
+          }
+        callback(i, value, gradient);
+      }
+    }
+
+    bool simplex_;
+    std::vector<Degrees> degrees_;
+    std::vector<R> scale_;
+  };
+
+
+
+  // All shape functions of a modal basis are associated to the element interior
+  class ModalDGLocalCoefficients
+  {
+  public:
+    ModalDGLocalCoefficients(std::size_t size = 0)
+    {
+      for (std::size_t i = 0; i < size; ++i)
+        localKeys_.emplace_back(0, 0, i);
+    }
+
+    std::size_t size() const
+    {
+      return localKeys_.size();
+    }
+
+    const LocalKey& localKey(std::size_t i) const
+    {
+      assert(i < localKeys_.size());
+      return localKeys_[i];
+    }
+
+  private:
+    std::vector<LocalKey> localKeys_;
+  };
+
+
+
+  // The L2 projection onto an orthonormal basis: The coefficients are the L2 products
+  // of the function with the shape functions. These are computed by a quadrature rule
+  // that is exact for polynomials of order k, hence the interpolation is exact for them.
+  // The shape function values at the quadrature points are precomputed, scaled
+  // by the quadrature weights.
+  template<class D, class R, int dim>
+  class ModalDGLocalInterpolation
+  {
+  public:
+    ModalDGLocalInterpolation() = default;
+
+    template<class LocalBasis>
+    ModalDGLocalInterpolation(const GeometryType& type, const LocalBasis& localBasis)
+      : size_(localBasis.size())
+    {
+      std::vector<typename LocalBasis::Traits::RangeType> values;
+      for (const auto& quadPoint : QuadratureRules<D,dim>::rule(type, 2*localBasis.order()))
+      {
+        points_.push_back(quadPoint.position());
+        localBasis.evaluateFunction(quadPoint.position(), values);
+        for (std::size_t i = 0; i < size_; ++i)
+          weightedValues_.push_back(values[i][0]*quadPoint.weight());
+      }
+    }
+
+    template<class F, class C>
+    void interpolate(const F& f, std::vector<C>& out) const
+    {
+      out.assign(size_, C(0));
+      for (std::size_t p = 0; p < points_.size(); ++p)
+      {
+        const C y = f(points_[p]);
+        for (std::size_t i = 0; i < size_; ++i)
+          out[i] += weightedValues_[p*size_ + i]*y;
+      }
+    }
+
+  private:
+    std::size_t size_ = 0;
+    std::vector<FieldVector<D,dim>> points_;
+    std::vector<R> weightedValues_;
+  };
+
+
+
+  /**
+   * \brief Local finite element with orthonormal modal shape functions of order k
+   *
+   * The geometry type, either a cube or a simplex, is selected at run-time.
+   */
+  template<class D, class R, int dim, int k>
+  class ModalDGLocalFiniteElement
+  {
+    using LocalBasis = ModalDGLocalBasis<D,R,dim,k>;
+    using LocalCoefficients = ModalDGLocalCoefficients;
+    using LocalInterpolation = ModalDGLocalInterpolation<D,R,dim>;
+
+  public:
+    using Traits = LocalFiniteElementTraits<LocalBasis,LocalCoefficients,LocalInterpolation>;
+
+    ModalDGLocalFiniteElement(const GeometryType& type = GeometryTypes::cube(dim))
+      : type_(type)
+      , localBasis_(type)
+      , localCoefficients_(localBasis_.size())
+      , localInterpolation_(type, localBasis_)
+    {}
+
+    const LocalBasis& localBasis() const
+    {
+      return localBasis_;
+    }
+
+    const LocalCoefficients& localCoefficients() const
+    {
+      return localCoefficients_;
+    }
+
+    const LocalInterpolation& localInterpolation() const
+    {
+      return localInterpolation_;
+    }
+
+    std::size_t size() const
+    {
+      return localBasis_.size();
+    }
+
+    GeometryType type() const
+    {
+      return type_;
+    }
+
+    //! Number of leading shape functions spanning the polynomials of the given order
+    std::size_t truncatedSize(unsigned int order) const
+    {
+      return localBasis_.truncatedSize(order);
+    }
+
+  private:
+    GeometryType type_;
+    LocalBasis localBasis_;
+    LocalCoefficients localCoefficients_;
+    LocalInterpolation localInterpolation_;
+  };
+
+} // end namespace Impl
+
+
+
+// *****************************************************************************
+// This is the reusable part of the basis. It contains
+//
+//   ModalDGPreBasis
+//
+// The pre-basis allows to create the others and is the owner of possible shared
+// state. These components do _not_ depend on the global basis and local view
+// and can be used without a global basis.
+// *****************************************************************************
+
+/**
+ * \brief A pre-basis for discontinuous bases with orthonormal modal shape functions of order k
+ *
+ * \ingroup FunctionSpaceBasesImplementations
+ *
+ * The shape functions are products of Legendre polynomials on cubes and
+ * Dubiner polynomials on simplices, spanning the same spaces as `LagrangeDGPreBasis`.
+ * They are orthonormal in L2 of the reference element. Hence the mass matrix of an
+ * affine element is the identity scaled by the constant integration element, and no
+ * linear system has to be solved for its inverse, see also `DGInverseMassOperator`.
+ *
+ * The shape functions of an element are sorted by their order, such that the first
+ * `finiteElement().truncatedSize(j)` ones span the polynomials of order j. Truncating
+ * the local coefficients after these is the L2 projection onto order j.
+ *
+ * \note All elements must have the same geometry type, either a cube or a simplex.
+ *
+ * \tparam GV  The grid view that the FE basis is defined on
+ * \tparam k   The polynomial order of ansatz functions
+ * \tparam R   Range field-type used for shape function values
+ */
+template<typename GV, int k, typename R = double>
+class ModalDGPreBasis :
+  public LFEPreBasisMixin<GV, Impl::ModalDGLocalFiniteElement<typename GV::ctype,R,GV::dimension,k>>
+{
+  static const int dim = GV::dimension;
+  using LFE = Impl::ModalDGLocalFiniteElement<typename GV::ctype,R,GV::dimension,k>;
+  using Base = LFEPreBasisMixin<GV, LFE>;
+
+  static GeometryType elementType(const GV& gridView)
+  {
+    const auto& types = gridView.indexSet().types(0);
+    if (std::distance(types.begin(), types.end()) != 1)
+      DUNE_THROW(Dune::NotImplemented, "ModalDGPreBasis requires a grid view with a single geometry type");
+    return *types.begin();
+  }
+
+public:
+  ModalDGPreBasis (const GV& gridView) :
+    Base(gridView, LFE(elementType(gridView)), [](GeometryType gt, int) -> std::size_t {
+      if (gt.dim() != dim)
+        return 0;
+      return gt.isSimplex() ? Dune::binomial(k+dim, dim) : Dune::power(k+1, dim);
+    })
+  {}
+};
+
+
+
+namespace BasisFactory {
+
+/**
+ * \brief Create a pre-basis factory that can create a modal DG pre-basis
+ *
+ * \ingroup FunctionSpaceBasesImplementations
+ *
+ * \tparam k   The polynomial order of the ansatz functions
+ * \tparam R   The range field-type of the local basis
+ */
+template<int k, typename R=double>
+auto modalDG()
+{
+  return [](const auto& gridView) {
+    return ModalDGPreBasis<std::decay_t<decltype(gridView)>, k, R>(gridView);
+  };
+}
+
+} // end namespace BasisFactory
+
+
+
+/** \brief Basis of a scalar discontinuous finite element space with orthonormal modal shape functions
+ *
+ * \ingroup FunctionSpaceBasesImplementations
+ *
+ * \tparam GV The GridView that the space is defined on
+ * \tparam k The order of the basis
+ * \tparam R The range type of the local basis
+ */
+template<typename GV, int k, typename R=double>
+using ModalDGBasis = DefaultGlobalBasis<ModalDGPreBasis<GV, k, R> >;
+
+
+
+} // end namespace Functions
+} // end namespace Dune
+
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_MODALDGBASIS_HH
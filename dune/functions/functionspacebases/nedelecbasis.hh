@@ -52,8 +52,7 @@ namespace Impl
     }
 
     Nedelec1stKindLocalFiniteElementMap(const GV& gv)
-      : elementMapper_(gv, mcmgElementLayout()),
-        orientation_(gv.size(0))
+      : elementMapper_(gv, mcmgElementLayout())
     {
       // create all variants
       if constexpr (hasFixedElementType)
@@ -72,6 +71,14 @@ namespace Impl
           variants_[i + numVariants(GeometryTypes::simplex(dim))] = CubeFiniteElement(i);
       }
 
+      update(gv);
+    }
+
+    //! Recompute the orientations of all elements, to be called if the grid has changed
+    void update(const GV& gv)
+    {
+      elementMapper_.update(gv);
+      orientation_.resize(gv.size(0));
 
       // compute orientation for all elements
       const auto& indexSet = gv.indexSet();
@@ -188,6 +195,7 @@ public:
   void update (const GridView& gv)
   {
     gridView_ = gv;
+    finiteElementMap_.update(gv);
     mapper_.update(gridView_);
   }
 
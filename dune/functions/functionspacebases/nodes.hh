@@ -5,8 +5,11 @@
 
 #include <cassert>
 #include <memory>
+#include <type_traits>
+#include <utility>
 
 #include <dune/common/indices.hh>
+#include <dune/common/std/type_traits.hh>
 
 #include <dune/typetree/leafnode.hh>
 #include <dune/typetree/powernode.hh>
@@ -49,16 +52,62 @@ namespace Dune {
       };
 
 
+      // Leaf nodes may implement bindLike(other) to bind to the element
+      // a node of the same type is bound to, reusing its finite element.
+      template<typename Node>
+      using BindLikeDetector = decltype(std::declval<Node&>().bindLike(std::declval<const Node&>()));
+
+      // Check if the children of a power node are leaf nodes that can share
+      // the binding of the first child, i.e., they implement bindLike().
+      template<typename Node>
+      constexpr bool bindsChildrenLikeFirst()
+      {
+        if constexpr (Node::isPower)
+        {
+          using Child = std::decay_t<typename Node::ChildType>;
+          if constexpr (Child::isLeaf)
+            return Std::is_detected_v<BindLikeDetector, Child>;
+          else
+            return false;
+        }
+        else
+          return false;
+      }
+
+
       template<typename Entity>
       struct BindVisitor
         : public TypeTree::TreeVisitor
         , public TypeTree::DynamicTraversal
       {
 
+        // The children of power nodes that share the binding of their
+        // first child are bound in pre() and thus not visited at all.
+        template<typename Node, typename Child, typename TreePath>
+        struct VisitChild
+        {
+          static const bool value = not bindsChildrenLikeFirst<std::decay_t<Node>>();
+        };
+
         template<typename Node, typename TreePath>
         void pre(Node& node, TreePath)
         {
           node.setOffset(offset_);
+          if constexpr (bindsChildrenLikeFirst<Node>())
+          {
+            // Bind the first child only. All other children are bound to the
+            // same element and finite element and differ only by their offset.
+            for (std::size_t i = 0; i < node.degree(); ++i)
+            {
+              auto& child = node.child(i);
+              child.setOffset(offset_);
+              if (i == 0)
+                child.bind(entity_);
+              else
+                child.bindLike(node.child(0));
+              offset_ += child.size();
+            }
+          }
         }
 
         template<typename Node, typename TreePath>
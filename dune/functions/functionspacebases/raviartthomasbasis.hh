@@ -121,8 +121,7 @@ namespace Impl {
     }
 
     RaviartThomasLocalFiniteElementMap(const GV& gv)
-      : elementMapper_(gv, mcmgElementLayout()),
-        orient_(gv.size(0))
+      : elementMapper_(gv, mcmgElementLayout())
     {
       if constexpr (hasFixedElementType)
       {
@@ -140,6 +139,15 @@ namespace Impl {
           variants_[i + numVariants(GeometryTypes::simplex(dim))] = CubeFiniteElement(i);
       }
 
+      update(gv);
+    }
+
+    //! Recompute the orientations of all elements, to be called if the grid has changed
+    void update(const GV& gv)
+    {
+      elementMapper_.update(gv);
+      orient_.resize(gv.size(0));
+
       for(const auto& cell : elements(gv))
       {
         unsigned int myId = elementMapper_.index(cell);
@@ -240,6 +248,7 @@ public:
   void update (const GridView& gv)
   {
     gridView_ = gv;
+    finiteElementMap_.update(gv);
   }
 
   /**
@@ -0,0 +1,185 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_SIMDLOCALVIEW_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_SIMDLOCALVIEW_HH
+
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+
+
+
+namespace Dune {
+namespace Functions {
+
+
+
+/**
+ * \brief The restriction of a finite element basis to several elements at once
+ *
+ * \ingroup FunctionSpaceBasesUtilities
+ *
+ * This binds up to `W` elements of the same geometry type at the same time.
+ * Each of these so called lanes is handled by its own local view of the
+ * global basis. The lanes share the structure of the local ansatz tree
+ * and the local finite elements, such that algorithms can process all
+ * lanes in lockstep using SIMD types with `W` lanes, e.g. `Dune::LoopSIMD`.
+ * This is useful for low order elements, where the work per element
+ * is too small to be vectorized within a single element.
+ *
+ * Binding is not shared between lanes: Each lane binds its own local view
+ * and computes its own global indices. Geometries are not handled by this
+ * class. They can be evaluated for all lanes at once using a `SimdGeometry`.
+ *
+ * If less than `W` elements are bound, only the first `boundLanes()`
+ * lanes are valid.
+ *
+ * \warning The shared local finite elements are taken from the first lane.
+ *   This is only valid if the local finite elements of the basis only depend
+ *   on the geometry type of the element, as e.g. for Lagrange bases. It is not
+ *   valid for bases with element dependent local finite elements, like
+ *   Raviart-Thomas or Nédélec bases.
+ *
+ * \tparam GB Type of global basis
+ * \tparam W Number of lanes, i.e., maximal number of bound elements
+ */
+template<class GB, std::size_t W>
+class SimdLocalView
+{
+public:
+
+  //! The global FE basis that this is a view on
+  using GlobalBasis = GB;
+
+  //! The grid view the global FE basis lives on
+  using GridView = typename GlobalBasis::GridView;
+
+  //! Type of the grid elements we are bound to
+  using Element = typename GridView::template Codim<0>::Entity;
+
+  //! The type used for sizes
+  using size_type = std::size_t;
+
+  //! The local view used for each lane
+  using LocalView = typename GlobalBasis::LocalView;
+
+  //! Tree of local finite elements / local shape function sets shared by all lanes
+  using Tree = typename LocalView::Tree;
+
+  //! Type used for global numbering of the basis vectors
+  using MultiIndex = typename LocalView::MultiIndex;
+
+  //! Number of lanes
+  static constexpr size_type lanes()
+  {
+    return W;
+  }
+
+  //! Construct local view for a given global finite element basis
+  SimdLocalView(const GlobalBasis& globalBasis) :
+    boundLanes_(0)
+  {
+    localViews_.reserve(W);
+    for (size_type lane = 0; lane < W; ++lane)
+      localViews_.push_back(globalBasis.localView());
+  }
+
+  /**
+   * \brief Bind the view to a set of grid elements
+   *
+   * \param elements A random access range of at most `W` elements of the same geometry type
+   *
+   * \throws Dune::RangeError if more than `W` or no elements are passed
+   * \throws Dune::Exception if the elements have different geometry types
+   */
+  template<class Elements>
+  void bind(const Elements& elements)
+  {
+    if ((elements.size() == 0) or (elements.size() > W))
+      DUNE_THROW(Dune::RangeError, "SimdLocalView with " << W << " lanes cannot be bound to " << elements.size() << " elements");
+    const auto type = elements[0].type();
+    for (size_type lane = 0; lane < elements.size(); ++lane)
+    {
+      if (elements[lane].type() != type)
+        DUNE_THROW(Dune::Exception, "All elements bound to a SimdLocalView must have the same geometry type");
+      localViews_[lane].bind(elements[lane]);
+    }
+    boundLanes_ = elements.size();
+  }
+
+  //! Return if the view is bound to grid elements
+  bool bound() const
+  {
+    return boundLanes_ > 0;
+  }
+
+  //! Unbind from the current elements
+  void unbind()
+  {
+    for (auto& localView : localViews_)
+      localView.unbind();
+    boundLanes_ = 0;
+  }
+
+  //! Return the number of lanes that are bound to an element
+  size_type boundLanes() const
+  {
+    return boundLanes_;
+  }
+
+  //! Return the grid element the given lane is bound to
+  const Element& element(size_type lane) const
+  {
+    return localViews_[lane].element();
+  }
+
+  //! Return the local ansatz tree shared by all lanes
+  const Tree& tree() const
+  {
+    return localViews_[0].tree();
+  }
+
+  //! Total number of degrees of freedom per element
+  size_type size() const
+  {
+    return localViews_[0].size();
+  }
+
+  //! Maximum local size for any element on the GridView
+  size_type maxSize() const
+  {
+    return localViews_[0].maxSize();
+  }
+
+  //! Maps from subtree index set [0..size-1] of the given lane to a globally unique multi index in global basis
+  const MultiIndex& index(size_type lane, size_type i) const
+  {
+    return localViews_[lane].index(i);
+  }
+
+  //! Return the local view of the given lane
+  const LocalView& laneLocalView(size_type lane) const
+  {
+    return localViews_[lane];
+  }
+
+  //! Return the global basis that we are a view on
+  const GlobalBasis& globalBasis() const
+  {
+    return localViews_[0].globalBasis();
+  }
+
+protected:
+  std::vector<LocalView> localViews_;
+  size_type boundLanes_;
+};
+
+
+
+} // end namespace Functions
+} // end namespace Dune
+
+
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_SIMDLOCALVIEW_HH
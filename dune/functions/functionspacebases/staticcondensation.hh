@@ -0,0 +1,273 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_FUNCTIONSPACEBASES_STATICCONDENSATION_HH
+#define DUNE_FUNCTIONS_FUNCTIONSPACEBASES_STATICCONDENSATION_HH
+
+#include <cassert>
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/rangeutilities.hh>
+
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <dune/typetree/traversal.hh>
+
+#include <dune/functions/backends/istlvectorbackend.hh>
+#include <dune/functions/common/parallelfor.hh>
+#include <dune/functions/functionspacebases/elementelimination.hh>
+#include <dune/functions/functionspacebases/subentitydofs.hh>
+
+namespace Dune {
+namespace Functions {
+
+
+
+/**
+ * \brief Static condensation of the element-interior DOFs of a global basis
+ *
+ * \ingroup FunctionSpaceBasesUtilities
+ *
+ * The DOFs of an element whose `LocalKey` has codimension 0 are only
+ * coupled to the other DOFs of the same element, e.g. the interior DOFs
+ * of `LagrangeBasis` for k>=2 or of `HierarchicalLagrangeBasis`.
+ * All other DOFs of an element are contained in the `SubEntityDOFs`
+ * of its facets and are called interface DOFs. They are numbered
+ * consecutively by the skeleton index set of this class.
+ *
+ * For a linear system assembled from element contributions this class
+ * eliminates the interior DOFs element by element: If the element matrix
+ * and vector are split into the interior part I and the interface part B,
+ * the element contributes the Schur complement
+ * \f$ S = A_{BB} - A_{BI} A_{II}^{-1} A_{IB} \f$ and the vector
+ * \f$ g = b_B - A_{BI} A_{II}^{-1} b_I \f$ to the skeleton system.
+ * After solving the skeleton system, the interior values are recovered by
+ * \f$ u_I = A_{II}^{-1}(b_I - A_{IB} u_B) \f$.
+ *
+ * A typical usage looks like this:
+ * \code
+ * StaticCondensation condensation(basis);
+ * condensation.condense(localAssembler, threads);
+ * condensation.skeletonPattern(pattern);
+ * // ... set up matrix from pattern, zero matrix and rhs ...
+ * condensation.assembleSkeletonSystem(matrix, rhs);
+ * // ... solve the skeleton system ...
+ * condensation.recoverSolution(skeletonSolution, x);
+ * \endcode
+ *
+ * The skeleton index set requires a basis with flat multi-indices.
+ * The class stores the condensed element contributions. Hence
+ * `condense()` has to be called again if the system changes,
+ * and the object has to be recreated if the basis changes.
+ * The basis is stored by pointer and must outlive this object.
+ *
+ * \tparam B Type of a global basis with flat multi-indices
+ * \tparam F Field type of the element matrices
+ */
+template<class B, class F = double>
+class StaticCondensation
+{
+  using Basis = B;
+  using Field = F;
+  using GridView = typename Basis::GridView;
+  using Element = typename GridView::template Codim<0>::Entity;
+  using MultiIndex = typename Basis::MultiIndex;
+  using size_type = std::size_t;
+
+public:
+
+  //! Marker for global indices that are not contained in the skeleton
+  static constexpr size_type invalidIndex = std::numeric_limits<size_type>::max();
+
+  /**
+   * \brief Classify the DOFs of all elements and number the interface DOFs
+   *
+   * \param basis A global basis with flat multi-indices, which must outlive this object
+   */
+  StaticCondensation(const B& basis) :
+    basis_(&basis),
+    skeletonIndices_(basis.dimension(), invalidIndex)
+  {
+    static_assert(Basis::PreBasis::maxMultiIndexSize == 1,
+      "StaticCondensation requires a basis with flat multi-indices");
+
+    auto localView = basis.localView();
+    auto seDOFs = subEntityDOFs(basis);
+    std::vector<bool> isInterface;
+    for (const auto& element : elements(basis.gridView()))
+    {
+      localView.bind(element);
+
+      // Interface DOFs are those on the facets of the element
+      isInterface.assign(localView.size(), false);
+      for (auto facet : Dune::range(referenceElement(element.geometry()).size(1)))
+        for (auto localIndex : seDOFs.bind(localView, facet, 1))
+          isInterface[localIndex] = true;
+
+      Dune::TypeTree::forEachLeafNode(localView.tree(), [&](auto&& node, auto&& /*treePath*/) {
+        const auto& localCoefficients = node.finiteElement().localCoefficients();
+        for (size_type i = 0; i < localCoefficients.size(); ++i)
+        {
+          auto localIndex = node.localIndex(i);
+          auto globalIndex = localView.index(localIndex);
+          assert(isInterface[localIndex] == (localCoefficients.localKey(i).codim() != 0));
+          if (isInterface[localIndex])
+          {
+            // Number the interface DOFs in the order of their first occurrence
+            auto& skeletonIndex = skeletonIndices_[globalIndex[0]];
+            if (skeletonIndex == invalidIndex)
+            {
+              skeletonIndex = skeletonGlobalIndices_.size();
+              skeletonGlobalIndices_.push_back(globalIndex);
+            }
+            elimination_.addKept(skeletonIndex);
+            interfaceLocalIndices_.push_back(localIndex);
+          }
+          else
+          {
+            elimination_.addEliminated(globalIndex);
+            interiorLocalIndices_.push_back(localIndex);
+          }
+        }
+      });
+      elimination_.finishElement();
+    }
+  }
+
+  /**
+   * \brief Compute the condensed element contributions
+   *
+   * The local assembler is called as `localAssembler(localView, elementMatrix, elementVector)`
+   * for each element, where `localView` is bound to the element. It has to add the element
+   * contributions to the zero-initialized `DynamicMatrix` and `DynamicVector` with respect
+   * to the local indices of `localView`.
+   *
+   * The elements can be processed by several threads. Each thread uses its own copy
+   * of the local view and the local assembler. Since each element only writes its own
+   * contributions, the result does not depend on the number of threads.
+   *
+   * \param localAssembler A callback computing element matrix and vector
+   * \param threads Number of threads used for the element loop
+   */
+  template<class LocalAssembler>
+  void condense(const LocalAssembler& localAssembler, std::size_t threads = 1)
+  {
+    std::vector<Element> elementList;
+    elementList.reserve(elimination_.size());
+    for (const auto& element : elements(basis_->gridView()))
+      elementList.push_back(element);
+    assert(elementList.size() == elimination_.size());
+
+    auto condenseRange = [&](size_type begin, size_type end) {
+      auto localView = basis_->localView();
+      auto assembler = localAssembler;
+      DynamicMatrix<Field> elementMatrix;
+      DynamicVector<Field> elementVector;
+      for (size_type e = begin; e < end; ++e)
+      {
+        localView.bind(elementList[e]);
+        elementMatrix.resize(localView.size(), localView.size());
+        elementVector.resize(localView.size());
+        elementMatrix = 0;
+        elementVector = 0;
+        assembler(localView, elementMatrix, elementVector);
+        condenseElement(e, elementMatrix, elementVector);
+      }
+    };
+
+    Impl::parallelForRanges(elementList.size(), threads, condenseRange);
+  }
+
+  /**
+   * \brief Fill the sparsity pattern of the skeleton matrix
+   *
+   * \param pattern A pattern like `Dune::MatrixIndexSet` providing `resize()` and `add()`
+   */
+  template<class Pattern>
+  void skeletonPattern(Pattern& pattern) const
+  {
+    elimination_.pattern(pattern, skeletonSize());
+  }
+
+  /**
+   * \brief Add the condensed element contributions to the skeleton system
+   *
+   * Both containers are indexed by the skeleton indices
+   * and must already have the size `skeletonSize()`.
+   *
+   * \param matrix A matrix providing `matrix[i][j]` access, e.g. a `BCRSMatrix` set up by skeletonPattern()
+   * \param rhs A vector providing `rhs[i]` access
+   */
+  template<class Matrix, class Vector>
+  void assembleSkeletonSystem(Matrix& matrix, Vector& rhs) const
+  {
+    elimination_.assemble(matrix, rhs);
+  }
+
+  /**
+   * \brief Compute the full solution from the solution of the skeleton system
+   *
+   * \param skeletonSolution Solution of the skeleton system indexed by the skeleton indices
+   * \param x Coefficient vector of the basis, which must already have the size of the basis
+   */
+  template<class SkeletonVector, class Vector>
+  void recoverSolution(const SkeletonVector& skeletonSolution, Vector& x) const
+  {
+    auto xBackend = Dune::Functions::istlVectorBackend(x);
+    for (size_type i = 0; i < skeletonGlobalIndices_.size(); ++i)
+      xBackend[skeletonGlobalIndices_[i]] = skeletonSolution[i];
+    elimination_.recover(skeletonSolution, x);
+  }
+
+  //! Number of interface DOFs, i.e., the size of the skeleton system
+  size_type skeletonSize() const
+  {
+    return skeletonGlobalIndices_.size();
+  }
+
+  //! Skeleton index of the DOF with given global index, or invalidIndex for interior DOFs
+  size_type skeletonIndex(const MultiIndex& globalIndex) const
+  {
+    return skeletonIndices_[globalIndex[0]];
+  }
+
+  //! Number of element-interior DOFs that are eliminated
+  size_type interiorSize() const
+  {
+    return elimination_.eliminatedSize();
+  }
+
+private:
+
+  // Pass the interior and interface blocks of the element matrix to the elimination
+  template<class ElementMatrix, class ElementVector>
+  void condenseElement(size_type e, const ElementMatrix& elementMatrix, const ElementVector& elementVector)
+  {
+    auto interface = [&](size_type i) { return interfaceLocalIndices_[elimination_.firstKept(e) + i]; };
+    auto interior = [&](size_type i) { return interiorLocalIndices_[elimination_.firstEliminated(e) + i]; };
+    elimination_.condenseElement(e,
+      [&](size_type i, size_type j) { return elementMatrix[interior(i)][interior(j)]; },
+      [&](size_type i, size_type j) { return elementMatrix[interior(i)][interface(j)]; },
+      [&](size_type i, size_type j) { return elementMatrix[interface(i)][interior(j)]; },
+      [&](size_type i, size_type j) { return elementMatrix[interface(i)][interface(j)]; },
+      [&](size_type i) { return elementVector[interior(i)]; },
+      [&](size_type i) { return elementVector[interface(i)]; });
+  }
+
+  const Basis* basis_;
+  Impl::ElementElimination<MultiIndex, Field> elimination_;
+  std::vector<size_type> interfaceLocalIndices_;
+  std::vector<size_type> interiorLocalIndices_;
+  std::vector<size_type> skeletonIndices_;
+  std::vector<MultiIndex> skeletonGlobalIndices_;
+};
+
+
+
+} // end namespace Functions
+} // end namespace Dune
+
+#endif // DUNE_FUNCTIONS_FUNCTIONSPACEBASES_STATICCONDENSATION_HH
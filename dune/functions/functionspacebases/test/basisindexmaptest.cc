@@ -0,0 +1,165 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/geometry/referenceelements.hh>
+
+#include <dune/grid/uggrid.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
+
+#include <dune/functions/functionspacebases/basisindexmap.hh>
+#include <dune/functions/functionspacebases/interpolate.hh>
+#include <dune/functions/functionspacebases/lagrangebasis.hh>
+#include <dune/functions/functionspacebases/lagrangedgbasis.hh>
+#include <dune/functions/functionspacebases/raviartthomasbasis.hh>
+
+using namespace Dune;
+using namespace Dune::Functions;
+
+template<class Grid>
+void refineSomeElements(Grid& grid)
+{
+  std::size_t count = 0;
+  for (const auto& element : elements(grid.leafGridView()))
+    if (count++ % 5 == 0)
+      grid.mark(1, element);
+  grid.preAdapt();
+  grid.adapt();
+  grid.postAdapt();
+}
+
+// Check that the kept coefficients of an interpolant are those of
+// the interpolant on the refined grid
+template<class Grid, class PreBasisFactory>
+TestSuite checkBasisIndexMap(Grid& grid, const PreBasisFactory& preBasisFactory)
+{
+  TestSuite test("BasisIndexMap");
+
+  auto f = [](const auto& x) {
+    return std::sin(3*x[0]) + x[1]*x[1];
+  };
+
+  auto basis = makeBasis(grid.leafGridView(), preBasisFactory);
+  std::vector<double> oldCoefficients;
+  interpolate(basis, oldCoefficients, f);
+
+  BasisIndexMap indexMap(basis);
+  for (int step = 0; step < 2; ++step)
+  {
+    refineSomeElements(grid);
+    basis.update(grid.leafGridView());
+    indexMap.update(basis);
+
+    std::vector<double> expected;
+    interpolate(basis, expected, f);
+
+    std::vector<double> newCoefficients(basis.dimension(), 0.0);
+    indexMap.transfer(oldCoefficients, newCoefficients);
+
+    std::size_t kept = 0;
+    for (std::size_t i = 0; i < basis.dimension(); ++i)
+    {
+      if (indexMap.isNew(i))
+        continue;
+      ++kept;
+      test.check(indexMap.oldToNew(indexMap.newToOld(i)) == i)
+        << "Index maps are not inverse to each other";
+      test.check(std::abs(newCoefficients[i] - expected[i]) < 1e-12)
+        << "Transferred coefficient does not match the interpolant";
+    }
+    test.check(kept > 0 and kept < basis.dimension())
+      << "Unexpected number of kept DOFs after local refinement";
+
+    for (std::size_t i = 0; i < oldCoefficients.size(); ++i)
+      if (indexMap.oldToNew(i) != BasisIndexMap<decltype(basis)>::invalidIndex)
+        test.check(indexMap.newToOld(indexMap.oldToNew(i)) == i)
+          << "Index maps are not inverse to each other";
+
+    oldCoefficients = expected;
+  }
+
+  return test;
+}
+
+// Check that the orientation tables are recomputed when the basis is updated
+template<class Grid>
+TestSuite checkOrientationUpdate(Grid& grid)
+{
+  TestSuite test("RaviartThomasBasis::update()");
+
+  using namespace Functions::BasisFactory;
+  auto basis = makeBasis(grid.leafGridView(), raviartThomas<0>());
+  refineSomeElements(grid);
+  basis.update(grid.leafGridView());
+  auto freshBasis = makeBasis(grid.leafGridView(), raviartThomas<0>());
+
+  auto localView = basis.localView();
+  auto freshLocalView = freshBasis.localView();
+  std::vector<FieldVector<double,2>> values, freshValues;
+  for (const auto& element : elements(grid.leafGridView()))
+  {
+    localView.bind(element);
+    freshLocalView.bind(element);
+    auto center = referenceElement(element).position(0, 0);
+    localView.tree().finiteElement().localBasis().evaluateFunction(center, values);
+    freshLocalView.tree().finiteElement().localBasis().evaluateFunction(center, freshValues);
+    for (std::size_t i = 0; i < values.size(); ++i)
+      test.check((values[i] - freshValues[i]).two_norm() < 1e-12)
+        << "Orientation of updated basis differs from a new basis";
+  }
+
+  return test;
+}
+
+int main (int argc, char* argv[]) try
+{
+  Dune::MPIHelper::instance(argc, argv);
+
+  TestSuite test;
+
+  using namespace Functions::BasisFactory;
+  using Grid = UGGrid<2>;
+
+  {
+    auto grid = StructuredGridFactory<Grid>::createSimplexGrid({0.0, 0.0}, {1.0, 1.0}, {4, 4});
+    test.subTest(checkBasisIndexMap(*grid, lagrange<2>()));
+  }
+
+  {
+    // The local order of the two DOFs on each edge depends on the orientation of the element
+    auto grid = StructuredGridFactory<Grid>::createSimplexGrid({0.0, 0.0}, {1.0, 1.0}, {4, 4});
+    test.subTest(checkBasisIndexMap(*grid, lagrange<3>()));
+  }
+
+  {
+    // Three DOFs on each triangular face
+    auto grid = StructuredGridFactory<UGGrid<3>>::createSimplexGrid({0.0, 0.0, 0.0}, {1.0, 1.0, 1.0}, {2, 2, 2});
+    test.subTest(checkBasisIndexMap(*grid, lagrange<4>()));
+  }
+
+  {
+    auto grid = StructuredGridFactory<Grid>::createSimplexGrid({0.0, 0.0}, {1.0, 1.0}, {4, 4});
+    test.subTest(checkBasisIndexMap(*grid, lagrangeDG<1>()));
+  }
+
+  {
+    auto grid = StructuredGridFactory<Grid>::createSimplexGrid({0.0, 0.0}, {1.0, 1.0}, {4, 4});
+    test.subTest(checkOrientationUpdate(*grid));
+  }
+
+  return test.exit();
+}
+catch (Exception &e)
+{
+  std::cerr << "Exception: " << e << std::endl;
+  return 1;
+}
@@ -0,0 +1,138 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/grid/uggrid.hh>
+#include <dune/grid/yaspgrid.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
+
+#include <dune/istl/bvector.hh>
+
+#include <dune/functions/functionspacebases/basisinterpolation.hh>
+#include <dune/functions/functionspacebases/hierarchicallagrangebasis.hh>
+#include <dune/functions/functionspacebases/interpolate.hh>
+#include <dune/functions/functionspacebases/lagrangebasis.hh>
+#include <dune/functions/functionspacebases/lagrangedgbasis.hh>
+#include <dune/functions/functionspacebases/powerbasis.hh>
+#include <dune/functions/gridfunctions/discreteglobalbasisfunction.hh>
+
+using namespace Dune;
+using namespace Dune::Functions;
+
+double distance(double a, double b)
+{
+  return std::abs(a - b);
+}
+
+template<class K, int n>
+double distance(const FieldVector<K,n>& a, const FieldVector<K,n>& b)
+{
+  return (a - b).two_norm();
+}
+
+// Compare the BasisInterpolator with interpolate() of the discrete source function
+template<class Range, class SourceBasis, class TargetBasis, class Vector>
+TestSuite checkBasisInterpolator(const SourceBasis& sourceBasis, const TargetBasis& targetBasis, const Vector& source)
+{
+  TestSuite test("BasisInterpolator");
+
+  auto sourceFunction = makeDiscreteGlobalBasisFunction<Range>(sourceBasis, source);
+  Vector expected;
+  interpolate(targetBasis, expected, sourceFunction);
+
+  Vector target;
+  BasisInterpolator interpolator(sourceBasis, targetBasis);
+  interpolator(source, target);
+
+  test.check(target.size() == expected.size())
+    << "Interpolated coefficient vector has wrong size";
+  for (std::size_t i = 0; i < target.size(); ++i)
+    test.check(distance(target[i], expected[i]) < 1e-10)
+      << "BasisInterpolator does not match interpolate()";
+
+  Vector target2;
+  interpolateBasisFunction(sourceBasis, source, targetBasis, target2);
+  for (std::size_t i = 0; i < target.size(); ++i)
+    test.check(target2[i] == target[i])
+      << "interpolateBasisFunction() does not match BasisInterpolator";
+
+  return test;
+}
+
+template<class GridView>
+TestSuite checkGridView(const GridView& gridView)
+{
+  TestSuite test;
+
+  using namespace Functions::BasisFactory;
+
+  auto f = [](const auto& x) {
+    return std::sin(3*x[0]) + x[1]*x[1];
+  };
+
+  auto p2 = makeBasis(gridView, lagrange<2>());
+  std::vector<double> x;
+  interpolate(p2, x, f);
+  test.subTest(checkBasisInterpolator<double>(p2, makeBasis(gridView, lagrange<1>()), x));
+  test.subTest(checkBasisInterpolator<double>(p2, makeBasis(gridView, lagrangeDG<1>()), x));
+  test.subTest(checkBasisInterpolator<double>(p2, makeBasis(gridView, lagrange<3>()), x));
+
+  using Velocity = FieldVector<double,2>;
+  auto velocityP2 = makeBasis(gridView, power<2>(lagrange<2>(), blockedInterleaved()));
+  auto velocityP1 = makeBasis(gridView, power<2>(lagrange<1>(), blockedInterleaved()));
+  BlockVector<Velocity> v;
+  interpolate(velocityP2, v, [](const auto& x) {
+    return Velocity{x[0]*x[1], std::cos(x[0])};
+  });
+  test.subTest(checkBasisInterpolator<Velocity>(velocityP2, velocityP1, v));
+
+  return test;
+}
+
+int main (int argc, char* argv[]) try
+{
+  Dune::MPIHelper::instance(argc, argv);
+
+  TestSuite test;
+
+  {
+    YaspGrid<2> grid({1.0, 1.0}, {3, 4});
+    test.subTest(checkGridView(grid.leafGridView()));
+  }
+
+  {
+    using Grid = UGGrid<2>;
+    auto grid = StructuredGridFactory<Grid>::createSimplexGrid({0.0, 0.0}, {1.0, 1.0}, {3, 3});
+    test.subTest(checkGridView(grid->leafGridView()));
+
+    // The shape functions of the hierarchical basis depend on the orientation of the edges
+    using namespace Functions::BasisFactory;
+    auto hierarchical = makeBasis(grid->leafGridView(), hierarchicalLagrange<3>());
+    auto p2 = makeBasis(grid->leafGridView(), lagrange<2>());
+    std::vector<double> coefficients;
+    interpolate(hierarchical, coefficients, [](const auto& x) {
+      return std::sin(3*x[0]) + x[1]*x[1];
+    });
+    test.subTest(checkBasisInterpolator<double>(hierarchical, p2, coefficients));
+    interpolate(p2, coefficients, [](const auto& x) {
+      return std::cos(2*x[1]) + x[0]*x[1];
+    });
+    test.subTest(checkBasisInterpolator<double>(p2, hierarchical, coefficients));
+  }
+
+  return test.exit();
+}
+catch (Exception &e)
+{
+  std::cerr << "Exception: " << e << std::endl;
+  return 1;
+}
@@ -9,6 +9,7 @@
 #include <sstream>
 #include <map>
 #include <optional>
+#include <vector>
 
 #include <dune/common/test/testsuite.hh>
 #include <dune/common/concept.hh>
@@ -498,6 +499,40 @@ Dune::TestSuite checkBasisContinuity(const Basis& basis, const LocalCheck& local
   return test;
 }
 
+/*
+ * Check if copies of a bound local view are unaffected
+ * if the local view is bound to another element.
+ */
+template<class Basis>
+Dune::TestSuite checkLocalViewCopy(const Basis& basis)
+{
+  Dune::TestSuite test("local view copy check");
+
+  using MultiIndex = typename Basis::MultiIndex;
+
+  auto localView = basis.localView();
+  for (const auto& e : elements(basis.gridView()))
+  {
+    auto copy = localView;
+    auto copyIndices = std::vector<MultiIndex>();
+    if (copy.bound())
+      for (std::size_t i = 0; i < copy.size(); ++i)
+        copyIndices.push_back(copy.index(i));
+
+    localView.bind(e);
+
+    if (copy.bound())
+    {
+      test.check(copy.size() == copyIndices.size(), "local view copy size check")
+        << "size of local view copy changed when binding the original local view";
+      for (std::size_t i = 0; i < std::min(copy.size(), copyIndices.size()); ++i)
+        test.check(copy.index(i) == copyIndices[i], "local view copy index check")
+          << "index " << i << " of local view copy changed when binding the original local view";
+    }
+  }
+  return test;
+}
+
 template<class Basis, class... Flags>
 Dune::TestSuite checkConstBasis(const Basis& basis, Flags... flags)
 {
@@ -517,6 +552,8 @@ Dune::TestSuite checkConstBasis(const Basis& basis, Flags... flags)
     test.subTest(checkLocalView(basis, localView, flags...));
   }
 
+  test.subTest(checkLocalViewCopy(basis));
+
   // Perform global index tests.
   test.subTest(checkBasisIndices(basis));
 
@@ -0,0 +1,146 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/grid/uggrid.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
+
+#include <dune/istl/bvector.hh>
+
+#include <dune/functions/functionspacebases/coefficienttransfer.hh>
+#include <dune/functions/functionspacebases/interpolate.hh>
+#include <dune/functions/functionspacebases/lagrangebasis.hh>
+#include <dune/functions/functionspacebases/lagrangedgbasis.hh>
+#include <dune/functions/functionspacebases/powerbasis.hh>
+
+using namespace Dune;
+using namespace Dune::Functions;
+
+double distance(double a, double b)
+{
+  return std::abs(a - b);
+}
+
+template<class K, int n>
+double distance(const FieldVector<K,n>& a, const FieldVector<K,n>& b)
+{
+  return (a - b).two_norm();
+}
+
+// Adapt the grid with the given marker while transferring the coefficients
+template<class Grid, class Basis, class Vector, class Marker>
+void adaptAndTransfer(Grid& grid, Basis& basis, Vector& coefficients, std::size_t threads, Marker&& marker)
+{
+  std::size_t count = 0;
+  for (const auto& element : elements(grid.leafGridView()))
+    marker(element, count++);
+  grid.preAdapt();
+  CoefficientTransfer transfer(basis);
+  transfer.store(coefficients);
+  grid.adapt();
+  basis.update(grid.leafGridView());
+  transfer.restore(coefficients, threads);
+  grid.postAdapt();
+}
+
+// Refine and coarsen the grid with the interpolant of a function in the basis.
+// The transferred coefficients must equal the interpolant on the new grid.
+template<class Grid, class PreBasisFactory, class Vector, class F>
+TestSuite checkCoefficientTransfer(Grid& grid, const PreBasisFactory& preBasisFactory, Vector& coefficients, const F& f, std::size_t threads = 1)
+{
+  TestSuite test("CoefficientTransfer");
+
+  auto basis = makeBasis(grid.leafGridView(), preBasisFactory);
+  interpolate(basis, coefficients, f);
+
+  auto checkInterpolant = [&](const std::string& step) {
+    Vector expected;
+    interpolate(basis, expected, f);
+    test.check(coefficients.size() == expected.size())
+      << "Coefficient vector has wrong size after " << step;
+    for (std::size_t i = 0; i < expected.size(); ++i)
+      test.check(distance(coefficients[i], expected[i]) < 1e-10)
+        << "Transferred coefficients do not match the interpolant after " << step;
+  };
+
+  adaptAndTransfer(grid, basis, coefficients, threads, [&](const auto& element, std::size_t i) {
+    if (i % 3 == 0)
+      grid.mark(1, element);
+  });
+  checkInterpolant("refinement");
+
+  adaptAndTransfer(grid, basis, coefficients, threads, [&](const auto& element, std::size_t i) {
+    if (i % 2 == 0)
+      grid.mark(1, element);
+  });
+  checkInterpolant("second refinement");
+
+  adaptAndTransfer(grid, basis, coefficients, threads, [&](const auto& element, std::size_t) {
+    if (element.level() > 0)
+      grid.mark(-1, element);
+  });
+  checkInterpolant("coarsening");
+
+  return test;
+}
+
+int main (int argc, char* argv[]) try
+{
+  Dune::MPIHelper::instance(argc, argv);
+
+  TestSuite test;
+
+  using namespace Functions::BasisFactory;
+  using Grid = UGGrid<2>;
+
+  // Use functions from the discrete spaces such that the transfer is exact
+  auto f = [](const auto& x) {
+    return 1 + x[0] - 2*x[0]*x[1] + x[1]*x[1];
+  };
+
+  {
+    auto grid = StructuredGridFactory<Grid>::createSimplexGrid({0.0, 0.0}, {1.0, 1.0}, {4, 4});
+    std::vector<double> coefficients;
+    test.subTest(checkCoefficientTransfer(*grid, lagrange<2>(), coefficients, f));
+  }
+
+  {
+    // The DOFs shared by several elements are only written by one thread
+    auto grid = StructuredGridFactory<Grid>::createSimplexGrid({0.0, 0.0}, {1.0, 1.0}, {4, 4});
+    std::vector<double> coefficients;
+    test.subTest(checkCoefficientTransfer(*grid, lagrange<2>(), coefficients, f, 3));
+  }
+
+  {
+    auto grid = StructuredGridFactory<Grid>::createSimplexGrid({0.0, 0.0}, {1.0, 1.0}, {4, 4});
+    std::vector<double> coefficients;
+    test.subTest(checkCoefficientTransfer(*grid, lagrangeDG<2>(), coefficients, f));
+  }
+
+  {
+    using Velocity = FieldVector<double,2>;
+    auto grid = StructuredGridFactory<Grid>::createSimplexGrid({0.0, 0.0}, {1.0, 1.0}, {4, 4});
+    BlockVector<Velocity> coefficients;
+    auto g = [](const auto& x) {
+      return Velocity{x[0]*x[1], 1 - x[0]};
+    };
+    test.subTest(checkCoefficientTransfer(*grid, power<2>(lagrange<2>(), blockedInterleaved()), coefficients, g));
+  }
+
+  return test.exit();
+}
+catch (Exception &e)
+{
+  std::cerr << "Exception: " << e << std::endl;
+  return 1;
+}
@@ -13,6 +13,7 @@
 #include <dune/functions/functionspacebases/powerbasis.hh>
 #include <dune/functions/functionspacebases/compositebasis.hh>
 #include <dune/functions/functionspacebases/lagrangebasis.hh>
+#include <dune/functions/functionspacebases/lagrangedgbasis.hh>
 #include <dune/grid/yaspgrid.hh>
 
 
@@ -254,6 +255,8 @@ int main (int argc, char *argv[])
   checkBasis(test, power<2>(lagrange<1>(), blockedLexicographic()) );
   checkBasis(test, composite(lagrange<1>(),lagrange<2>()) );
   checkBasis(test, power<2>(power<2>(lagrange<2>(), blockedLexicographic()), blockedLexicographic()) );
+  checkBasis(test, lagrangeDG<2>(blockedLexicographic()) );
+  checkBasis(test, power<2>(lagrangeDG<1>(blockedLexicographic()), blockedLexicographic()) );
 
   checkBasis(test, power<2>(
         composite(
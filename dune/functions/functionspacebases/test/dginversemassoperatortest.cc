@@ -0,0 +1,141 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/grid/uggrid.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/functions/backends/istlvectorbackend.hh>
+#include <dune/functions/functionspacebases/dginversemassoperator.hh>
+#include <dune/functions/functionspacebases/lagrangedgbasis.hh>
+
+using namespace Dune;
+using namespace Dune::Functions;
+
+// Compute y = M x by assembling the element mass matrices
+template<class Basis, class Vector>
+void applyMassMatrix(const Basis& basis, const Vector& x, Vector& y)
+{
+  auto xBackend = istlVectorBackend(x);
+  auto yBackend = istlVectorBackend(y);
+  auto localView = basis.localView();
+  std::vector<FieldVector<double,1>> values;
+  for (const auto& element : elements(basis.gridView()))
+  {
+    localView.bind(element);
+    const auto& node = localView.tree();
+    const auto& localBasis = node.finiteElement().localBasis();
+    const auto& geometry = element.geometry();
+    const auto& quadRule = QuadratureRules<double,Basis::GridView::dimension>::rule(element.type(), 2*localBasis.order()+2);
+    for (std::size_t i = 0; i < node.size(); ++i)
+      yBackend[localView.index(node.localIndex(i))] = 0;
+    for (const auto& quadPoint : quadRule)
+    {
+      localBasis.evaluateFunction(quadPoint.position(), values);
+      auto factor = quadPoint.weight() * geometry.integrationElement(quadPoint.position());
+      for (std::size_t i = 0; i < node.size(); ++i)
+        for (std::size_t j = 0; j < node.size(); ++j)
+          yBackend[localView.index(node.localIndex(i))] += values[i][0] * values[j][0] * factor * xBackend[localView.index(node.localIndex(j))];
+    }
+  }
+}
+
+// Check that the inverse mass operator inverts the mass matrix
+template<class Basis, class Vector>
+TestSuite checkInverseMass(const Basis& basis, Vector x, std::size_t batchSize)
+{
+  TestSuite test("DGInverseMassOperator");
+
+  auto backend = istlVectorBackend(x);
+  backend.resize(basis);
+  std::size_t k = 0;
+  for (const auto& element : elements(basis.gridView()))
+  {
+    auto localView = basis.localView();
+    localView.bind(element);
+    for (std::size_t i = 0; i < localView.size(); ++i)
+      backend[localView.index(i)] = std::sin(double(++k));
+  }
+
+  Vector mx = x;
+  Vector y = x;
+  applyMassMatrix(basis, x, mx);
+
+  DGInverseMassOperator inverseMass(basis, batchSize);
+  inverseMass.apply(mx, y);
+
+  auto yBackend = istlVectorBackend(y);
+  auto localView = basis.localView();
+  for (const auto& element : elements(basis.gridView()))
+  {
+    localView.bind(element);
+    for (std::size_t i = 0; i < localView.size(); ++i)
+      test.check(std::abs(yBackend[localView.index(i)] - backend[localView.index(i)]) < 1e-10)
+        << "Inverse mass operator does not invert the mass matrix";
+  }
+  return test;
+}
+
+int main (int argc, char* argv[]) try
+{
+  Dune::MPIHelper::instance(argc, argv);
+
+  TestSuite test;
+
+  using namespace Functions::BasisFactory;
+
+  {
+    using Grid = YaspGrid<2>;
+    Grid grid({1.0, 1.0}, {5, 7});
+    auto gridView = grid.leafGridView();
+
+    auto flatBasis = makeBasis(gridView, lagrangeDG<2>());
+    test.subTest(checkInverseMass(flatBasis, std::vector<double>{}, 4));
+
+    auto blockedBasis = makeBasis(gridView, lagrangeDG<2>(blockedLexicographic()));
+    test.subTest(checkInverseMass(blockedBasis, std::vector<std::vector<double>>{}, 16));
+
+    DGInverseMassOperator inverseMass(blockedBasis);
+    test.check(inverseMass.affineElements() == 35 and inverseMass.nonAffineElements() == 0)
+      << "Elements of YaspGrid are not recognized as affine";
+  }
+
+  {
+    // A grid with one affine and one non-affine quadrilateral
+    using Grid = UGGrid<2>;
+    GridFactory<Grid> factory;
+    factory.insertVertex({0,0});
+    factory.insertVertex({1,0});
+    factory.insertVertex({0,1});
+    factory.insertVertex({1,1});
+    factory.insertVertex({2,0});
+    factory.insertVertex({2.5,1.5});
+    factory.insertElement(GeometryTypes::quadrilateral, {0,1,2,3});
+    factory.insertElement(GeometryTypes::quadrilateral, {1,4,3,5});
+    auto grid = factory.createGrid();
+
+    auto basis = makeBasis(grid->leafGridView(), lagrangeDG<1>(blockedLexicographic()));
+    test.subTest(checkInverseMass(basis, std::vector<std::vector<double>>{}, 3));
+
+    DGInverseMassOperator inverseMass(basis);
+    test.check(inverseMass.affineElements() == 1 and inverseMass.nonAffineElements() == 1)
+      << "Wrong classification of affine and non-affine elements";
+  }
+
+  return test.exit();
+}
+catch (Exception &e)
+{
+  std::cerr << "Exception: " << e << std::endl;
+  return 1;
+}
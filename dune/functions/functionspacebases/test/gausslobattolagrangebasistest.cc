@@ -0,0 +1,155 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <dune/grid/uggrid.hh>
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/functions/functionspacebases/gausslobattolagrangebasis.hh>
+#include <dune/functions/functionspacebases/interpolate.hh>
+
+#include <dune/functions/functionspacebases/test/basistest.hh>
+
+using namespace Dune;
+using namespace Dune::Functions;
+
+// Check that the shape functions are collocated with the quadrature rule,
+// and that the rule integrates polynomials of order 2k-1 exactly.
+template<int dim, int order>
+TestSuite checkCollocation()
+{
+  TestSuite test("GaussLobattoLagrangeLocalFiniteElement");
+
+  Impl::GaussLobattoLagrangeLocalFiniteElement<double,double,dim,order> fe;
+  const auto& quadRule = fe.quadratureRule();
+  test.check(quadRule.size() == fe.size())
+    << "Number of quadrature points does not match the number of shape functions";
+
+  std::vector<FieldVector<double,1>> values;
+  for (std::size_t q = 0; q < quadRule.size(); ++q)
+  {
+    fe.localBasis().evaluateFunction(quadRule[q].position(), values);
+    for (std::size_t i = 0; i < fe.size(); ++i)
+      test.check(std::abs(values[i][0] - (i == q ? 1.0 : 0.0)) < 1e-10)
+        << "Shape function " << i << " is not collocated with quadrature point " << q;
+  }
+
+  double integral = 0;
+  for (const auto& quadPoint : quadRule)
+    integral += std::pow(quadPoint.position()[0], 2*order-1) * quadPoint.weight();
+  test.check(std::abs(integral - 1.0/(2*order)) < 1e-10)
+    << "Quadrature rule is not exact of order " << 2*order-1;
+
+  // The interpolation reproduces polynomials of order k in each direction
+  auto f = [&](const auto& x) {
+    double y = 1;
+    for (int j = 0; j < dim; ++j)
+      y *= std::pow(x[j] - 0.3*j, order);
+    return y;
+  };
+  std::vector<double> coefficients;
+  fe.localInterpolation().interpolate(f, coefficients);
+  FieldVector<double,dim> x(0.37);
+  fe.localBasis().evaluateFunction(x, values);
+  double y = 0;
+  for (std::size_t i = 0; i < fe.size(); ++i)
+    y += coefficients[i]*values[i][0];
+  test.check(std::abs(y - f(x)) < 1e-10)
+    << "Interpolation does not reproduce polynomials";
+
+  return test;
+}
+
+int main (int argc, char* argv[]) try
+{
+  Dune::MPIHelper::instance(argc, argv);
+
+  Dune::TestSuite test;
+
+  test.subTest(checkCollocation<1,1>());
+  test.subTest(checkCollocation<1,8>());
+  test.subTest(checkCollocation<2,5>());
+  test.subTest(checkCollocation<3,4>());
+
+  using namespace Functions::BasisFactory;
+
+  {
+    YaspGrid<2> grid({1.0, 1.0}, {3, 4});
+    auto gridView = grid.leafGridView();
+
+    // check GaussLobattoLagrangeBasis created 'manually'
+    GaussLobattoLagrangeBasis<decltype(gridView),4> basis(gridView);
+    test.subTest(checkBasis(basis, EnableContinuityCheck()));
+
+    // check GaussLobattoLagrangeBasis created using basis builder mechanism
+    auto basis8 = makeBasis(gridView, gaussLobattoLagrange<8>());
+    test.subTest(checkBasis(basis8, EnableContinuityCheck()));
+
+    // Same space and same number of DOFs as the equidistant Lagrange basis
+    auto lagrangeBasis = makeBasis(gridView, lagrange<4>());
+    test.check(basis.dimension() == lagrangeBasis.dimension())
+      << "Dimension does not match the Lagrange basis";
+
+    // The interpolation is exact for polynomials of order k
+    auto f = [](const auto& x) { return std::pow(x[0], 4) - x[0]*x[1]*x[1]*x[1]; };
+    std::vector<double> coefficients;
+    interpolate(basis, coefficients, f);
+    auto localView = basis.localView();
+    for (const auto& element : elements(gridView))
+    {
+      localView.bind(element);
+      const auto& fe = localView.tree().finiteElement();
+      const auto& geometry = element.geometry();
+      for (const auto& quadPoint : fe.quadratureRule())
+      {
+        std::vector<FieldVector<double,1>> values;
+        fe.localBasis().evaluateFunction(quadPoint.position(), values);
+        double y = 0;
+        for (std::size_t i = 0; i < fe.size(); ++i)
+          y += coefficients[localView.index(i)]*values[i][0];
+        test.check(std::abs(y - f(geometry.global(quadPoint.position()))) < 1e-10)
+          << "Interpolation is not exact";
+      }
+    }
+  }
+
+  {
+    YaspGrid<3> grid({1.0, 1.0, 1.0}, {2, 2, 3});
+    auto basis = makeBasis(grid.leafGridView(), gaussLobattoLagrange<4>());
+    test.subTest(checkBasis(basis, EnableContinuityCheck()));
+  }
+
+  {
+    // A grid with differently oriented elements, which
+    // requires the reordering of the DOFs on the shared edge
+    using Grid = UGGrid<2>;
+    GridFactory<Grid> factory;
+    factory.insertVertex({0,0});
+    factory.insertVertex({1,0});
+    factory.insertVertex({0,1});
+    factory.insertVertex({1,1});
+    factory.insertVertex({2,0});
+    factory.insertVertex({2,1});
+    factory.insertElement(GeometryTypes::quadrilateral, {0,1,2,3});
+    factory.insertElement(GeometryTypes::quadrilateral, {4,5,1,3});
+    auto grid = factory.createGrid();
+    grid->globalRefine(1);
+
+    auto basis = makeBasis(grid->leafGridView(), gaussLobattoLagrange<6>());
+    test.subTest(checkBasis(basis, EnableContinuityCheck()));
+  }
+
+  return test.exit();
+}
+catch (Exception &e)
+{
+  std::cerr << "Exception: " << e << std::endl;
+  return 1;
+}
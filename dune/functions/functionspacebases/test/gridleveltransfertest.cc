@@ -0,0 +1,130 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/grid/uggrid.hh>
+#include <dune/grid/yaspgrid.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
+
+#include <dune/istl/bcrsmatrix.hh>
+
+#include <dune/functions/functionspacebases/gridleveltransfer.hh>
+#include <dune/functions/functionspacebases/interpolate.hh>
+#include <dune/functions/functionspacebases/lagrangebasis.hh>
+
+using namespace Dune;
+using namespace Dune::Functions;
+
+template<class CoarseBasis, class FineBasis>
+TestSuite checkGridLevelTransfer(const CoarseBasis& coarseBasis, const FineBasis& fineBasis)
+{
+  TestSuite test("GridLevelTransfer");
+
+  const auto n = fineBasis.dimension();
+  const auto m = coarseBasis.dimension();
+
+  // A function of the coarse space is reproduced exactly on the fine grid
+  auto f = [](const auto& x) {
+    return 1 + x[0] - 2*x[0]*x[1] + x[1]*x[1];
+  };
+  std::vector<double> coarse, fineExact;
+  interpolate(coarseBasis, coarse, f);
+  interpolate(fineBasis, fineExact, f);
+
+  GridLevelTransfer transfer(coarseBasis, fineBasis);
+
+  std::vector<std::vector<double>> fine;
+  for (std::size_t threads : {1, 3})
+  {
+    fine.emplace_back(n, 0.0);
+    transfer.applyProlongation(coarse, fine.back(), threads);
+    for (std::size_t i = 0; i < n; ++i)
+      test.check(std::abs(fine.back()[i] - fineExact[i]) < 1e-10)
+        << "Prolongation does not reproduce the interpolant with " << threads << " threads";
+  }
+
+  BCRSMatrix<double> prolongation;
+  transfer.assembleProlongationMatrix(prolongation);
+  test.check(prolongation.N() == n and prolongation.M() == m)
+    << "Prolongation matrix has wrong size";
+
+  std::vector<double> fineMatrix(n, 0.0);
+  for (auto row = prolongation.begin(); row != prolongation.end(); ++row)
+    for (auto entry = row->begin(); entry != row->end(); ++entry)
+      fineMatrix[row.index()] += *entry * coarse[entry.index()];
+  for (std::size_t i = 0; i < n; ++i)
+    test.check(std::abs(fineMatrix[i] - fine[0][i]) < 1e-10)
+      << "Prolongation matrix does not match matrix-free prolongation";
+
+  // Restriction of an arbitrary vector must be the transposed matrix-vector product
+  std::vector<double> residual(n);
+  for (std::size_t i = 0; i < n; ++i)
+    residual[i] = std::sin(1.0 + i);
+  std::vector<double> restrictedMatrix(m, 0.0);
+  for (auto row = prolongation.begin(); row != prolongation.end(); ++row)
+    for (auto entry = row->begin(); entry != row->end(); ++entry)
+      restrictedMatrix[entry.index()] += *entry * residual[row.index()];
+  for (std::size_t threads : {1, 4})
+  {
+    std::vector<double> restricted(m, 0.0);
+    transfer.applyRestriction(residual, restricted, threads);
+    for (std::size_t j = 0; j < m; ++j)
+      test.check(std::abs(restricted[j] - restrictedMatrix[j]) < 1e-10)
+        << "Restriction does not match the transposed prolongation with " << threads << " threads";
+  }
+
+  return test;
+}
+
+int main (int argc, char* argv[]) try
+{
+  Dune::MPIHelper::instance(argc, argv);
+
+  TestSuite test;
+
+  using namespace Functions::BasisFactory;
+
+  {
+    YaspGrid<2> grid({1.0, 1.0}, {3, 4});
+    grid.globalRefine(2);
+    auto basis0 = makeBasis(grid.levelGridView(0), lagrange<2>());
+    auto basis1 = makeBasis(grid.levelGridView(1), lagrange<2>());
+    auto leafBasis = makeBasis(grid.leafGridView(), lagrange<2>());
+    test.subTest(checkGridLevelTransfer(basis0, basis1));
+    test.subTest(checkGridLevelTransfer(basis0, leafBasis));
+    test.subTest(checkGridLevelTransfer(leafBasis, leafBasis));
+  }
+
+  {
+    // Local refinement, such that the leaf grid view contains elements of different levels
+    using Grid = UGGrid<2>;
+    auto grid = StructuredGridFactory<Grid>::createSimplexGrid({0.0, 0.0}, {1.0, 1.0}, {3, 3});
+    for (int i = 0; i < 2; ++i)
+    {
+      for (const auto& element : elements(grid->leafGridView()))
+        if (element.geometry().center()[0] < 0.5)
+          grid->mark(1, element);
+      grid->preAdapt();
+      grid->adapt();
+      grid->postAdapt();
+    }
+    auto basis0 = makeBasis(grid->levelGridView(0), lagrange<2>());
+    auto leafBasis = makeBasis(grid->leafGridView(), lagrange<2>());
+    test.subTest(checkGridLevelTransfer(basis0, leafBasis));
+  }
+
+  return test.exit();
+}
+catch (Exception &e)
+{
+  std::cerr << "Exception: " << e << std::endl;
+  return 1;
+}
@@ -0,0 +1,208 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/exceptions.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/grid/uggrid.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/matrixindexset.hh>
+
+#include <dune/functions/functionspacebases/hangingnodeconstraints.hh>
+#include <dune/functions/functionspacebases/interpolate.hh>
+#include <dune/functions/functionspacebases/lagrangebasis.hh>
+
+using namespace Dune;
+using namespace Dune::Functions;
+
+using Vector = BlockVector<double>;
+using Matrix = BCRSMatrix<double>;
+
+// Assemble the element mass matrix and the element vector of the L2 projection of f
+template<class LocalView, class F>
+void assembleElementMassMatrix(const LocalView& localView, const F& f, DynamicMatrix<double>& elementMatrix, DynamicVector<double>& elementVector)
+{
+  const auto& element = localView.element();
+  const auto& localBasis = localView.tree().finiteElement().localBasis();
+  elementMatrix.resize(localView.size(), localView.size());
+  elementVector.resize(localView.size());
+  elementMatrix = 0;
+  elementVector = 0;
+  std::vector<FieldVector<double,1>> values;
+  const auto& quadRule = QuadratureRules<double,2>::rule(element.type(), 2*localBasis.order());
+  for (const auto& quadPoint : quadRule)
+  {
+    localBasis.evaluateFunction(quadPoint.position(), values);
+    auto factor = quadPoint.weight() * element.geometry().integrationElement(quadPoint.position());
+    auto fValue = f(element.geometry().global(quadPoint.position()));
+    for (std::size_t i = 0; i < localView.size(); ++i)
+    {
+      elementVector[i] += fValue * values[i][0] * factor;
+      for (std::size_t j = 0; j < localView.size(); ++j)
+        elementMatrix[i][j] += values[i][0] * values[j][0] * factor;
+    }
+  }
+}
+
+template<class Basis>
+TestSuite checkHangingNodeConstraints(const Basis& basis)
+{
+  TestSuite test("HangingNodeConstraints");
+
+  const auto n = basis.dimension();
+  HangingNodeConstraints constraints(basis);
+  test.check(constraints.constrainedSize() > 0)
+    << "No hanging DOFs found on a nonconforming grid";
+
+  // The interpolant of a function in the conforming space satisfies the constraints
+  auto f = [](const auto& x) {
+    return 1 + x[0] - 2*x[1] + 3*x[0]*x[1];
+  };
+  Vector interpolant;
+  interpolate(basis, interpolant, f);
+  for (std::size_t i = 0; i < n; ++i)
+  {
+    if (not constraints.isConstrained(i))
+      continue;
+    double value = 0;
+    for (const auto& [j, w] : constraints.constraint(i))
+    {
+      test.check(not constraints.isConstrained(j))
+        << "Constrained DOF " << i << " depends on constrained DOF " << j;
+      value += w * interpolant[j];
+    }
+    test.check(std::abs(value - interpolant[i]) < 1e-10)
+      << "Interpolant does not satisfy the constraint of DOF " << i;
+  }
+
+  // The constraint matrix P applies the constraints
+  Vector y(n), distributed(n), py(n);
+  for (std::size_t i = 0; i < n; ++i)
+    y[i] = std::sin(1.0 + i);
+  distributed = y;
+  constraints.distribute(distributed);
+  Matrix constraintMatrix;
+  constraints.assembleConstraintMatrix(constraintMatrix);
+  constraintMatrix.mv(y, py);
+  for (std::size_t i = 0; i < n; ++i)
+    test.check(std::abs(py[i] - distributed[i]) < 1e-12)
+      << "Constraint matrix does not match distribute()";
+
+  // Assemble the L2 projection with and without eliminating the constraints
+  MatrixIndexSet pattern(n, n), unconstrainedPattern(n, n);
+  auto localView = basis.localView();
+  for (const auto& element : elements(basis.gridView()))
+  {
+    localView.bind(element);
+    constraints.addLocalPattern(localView, pattern);
+    for (std::size_t i = 0; i < localView.size(); ++i)
+      for (std::size_t j = 0; j < localView.size(); ++j)
+        unconstrainedPattern.add(localView.index(i), localView.index(j));
+  }
+  Matrix matrix, unconstrainedMatrix;
+  pattern.exportIdx(matrix);
+  unconstrainedPattern.exportIdx(unconstrainedMatrix);
+  matrix = 0;
+  unconstrainedMatrix = 0;
+  Vector rhs(n), unconstrainedRhs(n);
+  rhs = 0;
+  unconstrainedRhs = 0;
+  DynamicMatrix<double> elementMatrix;
+  DynamicVector<double> elementVector;
+  for (const auto& element : elements(basis.gridView()))
+  {
+    localView.bind(element);
+    assembleElementMassMatrix(localView, f, elementMatrix, elementVector);
+    constraints.distributeLocal(localView, elementMatrix, elementVector, matrix, rhs);
+    for (std::size_t i = 0; i < localView.size(); ++i)
+    {
+      unconstrainedRhs[localView.index(i)] += elementVector[i];
+      for (std::size_t j = 0; j < localView.size(); ++j)
+        unconstrainedMatrix[localView.index(i)][localView.index(j)] += elementMatrix[i][j];
+    }
+  }
+  constraints.setConstrainedRows(matrix, rhs);
+
+  // The operator applies the same matrix as the one assembled with elimination
+  HangingNodeConstrainedOperator<Matrix, Vector, Vector, decltype(constraints)> constrainedOperator(unconstrainedMatrix, constraints);
+  Vector opY(n), matrixY(n);
+  constrainedOperator.apply(y, opY);
+  matrix.mv(y, matrixY);
+  for (std::size_t i = 0; i < n; ++i)
+    test.check(std::abs(opY[i] - matrixY[i]) < 1e-12)
+      << "Constrained operator does not match the assembled constrained matrix";
+
+  Vector transformedRhs = unconstrainedRhs;
+  constraints.distributeTransposed(transformedRhs);
+  for (std::size_t i = 0; i < n; ++i)
+    test.check(std::abs(transformedRhs[i] - rhs[i]) < 1e-12)
+      << "Transformed right hand side does not match the assembled one";
+
+  // The L2 projection of a function in the conforming space reproduces it
+  DynamicMatrix<double> denseMatrix(n, n, 0.0);
+  for (auto row = matrix.begin(); row != matrix.end(); ++row)
+    for (auto entry = row->begin(); entry != row->end(); ++entry)
+      denseMatrix[row.index()][entry.index()] = *entry;
+  DynamicVector<double> denseRhs(n), denseSolution(n);
+  for (std::size_t i = 0; i < n; ++i)
+    denseRhs[i] = rhs[i];
+  denseMatrix.solve(denseSolution, denseRhs);
+  Vector solution(n);
+  for (std::size_t i = 0; i < n; ++i)
+    solution[i] = denseSolution[i];
+  constraints.distribute(solution);
+  for (std::size_t i = 0; i < n; ++i)
+    test.check(std::abs(solution[i] - interpolant[i]) < 1e-9)
+      << "Constrained L2 projection does not reproduce the function";
+
+  return test;
+}
+
+int main (int argc, char* argv[]) try
+{
+  Dune::MPIHelper::instance(argc, argv);
+
+  TestSuite test;
+
+  using namespace Functions::BasisFactory;
+  using Grid = UGGrid<2>;
+
+  auto grid = StructuredGridFactory<Grid>::createCubeGrid({0.0, 0.0}, {1.0, 1.0}, {4, 4});
+  grid->setClosureType(Grid::NONE);
+
+  // Refine twice to obtain neighbors differing by more than one level
+  for (int step = 0; step < 2; ++step)
+  {
+    std::size_t count = 0;
+    for (const auto& element : elements(grid->leafGridView()))
+      if (count++ % 3 == 0 and element.geometry().center()[0] < 0.5)
+        grid->mark(1, element);
+    grid->preAdapt();
+    grid->adapt();
+    grid->postAdapt();
+  }
+
+  auto gridView = grid->leafGridView();
+  test.subTest(checkHangingNodeConstraints(makeBasis(gridView, lagrange<1>())));
+  test.subTest(checkHangingNodeConstraints(makeBasis(gridView, lagrange<2>())));
+
+  return test.exit();
+}
+catch (Exception &e)
+{
+  std::cerr << "Exception: " << e << std::endl;
+  return 1;
+}
@@ -2,6 +2,11 @@
 // vi: set et ts=4 sw=2 sts=2:
 #include <config.h>
 
+#include <array>
+#include <cmath>
+#include <memory>
+#include <vector>
+
 #include <dune/common/exceptions.hh>
 #include <dune/common/filledarray.hh>
 #include <dune/common/parallel/mpihelper.hh>
@@ -11,10 +16,114 @@
 #include <dune/grid/utility/structuredgridfactory.hh>
 
 #include <dune/functions/functionspacebases/hierarchicallagrangebasis.hh>
+#include <dune/functions/functionspacebases/interpolate.hh>
 #include <dune/functions/functionspacebases/test/basistest.hh>
 
 using namespace Dune;
 
+// Check that the interpolation reproduces polynomials of order k,
+// and that the interior DOFs are the trailing ones of each element.
+template <class Basis>
+TestSuite checkInterpolationAndInteriorDOFs(const Basis& basis, int k)
+{
+  TestSuite test("HierarchicalLagrangeBasis interpolation and interior DOFs");
+  static const int dim = Basis::GridView::dimension;
+
+  auto f = [&](const auto& x) {
+    double y = 1;
+    for (int i = 0; i < dim; ++i)
+      y += (i+1)*x[i];
+    return std::pow(y, k);
+  };
+  std::vector<double> coefficients;
+  Functions::interpolate(basis, coefficients, f);
+
+  std::size_t interiorDOFs = 0;
+  auto localView = basis.localView();
+  std::vector<FieldVector<double,1>> values;
+  for (const auto& element : elements(basis.gridView()))
+  {
+    localView.bind(element);
+    const auto& node = localView.tree();
+    const auto& fe = node.finiteElement();
+
+    FieldVector<double,dim> x(0.2);
+    fe.localBasis().evaluateFunction(x, values);
+    double y = 0;
+    for (std::size_t i = 0; i < fe.size(); ++i)
+      y += coefficients[localView.index(i)]*values[i][0];
+    test.check(std::abs(y - f(element.geometry().global(x))) < 1e-8)
+      << "Interpolation does not reproduce polynomials of order " << k;
+
+    test.check(node.interiorDOFs().size() == node.interiorSize())
+      << "Number of interior DOFs does not match interiorSize()";
+    for (std::size_t i = 0; i < node.size(); ++i)
+      test.check(node.isInterior(i) == (i >= node.interfaceSize()))
+        << "Interior DOFs are not the trailing ones";
+    interiorDOFs += node.interiorSize();
+  }
+
+  std::size_t interiorSize = (k > dim) ? Dune::binomial(k-1, dim) : 0;
+  test.check(interiorDOFs == basis.gridView().size(0)*interiorSize)
+    << "Wrong total number of interior DOFs";
+
+  return test;
+}
+
+// Create a simplex grid whose vertices are inserted in reverse order and whose
+// elements list their vertices in different even permutations. Hence the vertex
+// indices of the elements are not ascending, unlike for the StructuredGridFactory,
+// and the elements have all kinds of orientations.
+template <class Grid>
+std::unique_ptr<Grid> createPermutedSimplexGrid()
+{
+  static const int dim = Grid::dimension;
+  FieldVector<double,dim> lower(0.0), upper(1.0);
+  auto structuredGrid = StructuredGridFactory<Grid>::createSimplexGrid(lower, upper, Dune::filledArray<dim,unsigned int>(2));
+  auto gridView = structuredGrid->leafGridView();
+  const auto& indexSet = gridView.indexSet();
+
+  std::vector<std::array<int,dim+1>> permutations;
+  if constexpr (dim == 2)
+    permutations = {{{0, 1, 2}}, {{1, 2, 0}}, {{2, 0, 1}}};
+  else
+    permutations = {{{0, 1, 2, 3}}, {{1, 2, 0, 3}}, {{0, 2, 3, 1}}, {{1, 0, 3, 2}}, {{3, 2, 1, 0}}};
+
+  GridFactory<Grid> factory;
+  const std::size_t vertexCount = gridView.size(dim);
+  std::vector<FieldVector<double,dim>> positions(vertexCount);
+  for (const auto& vertex : vertices(gridView))
+    positions[indexSet.index(vertex)] = vertex.geometry().corner(0);
+  for (std::size_t i = 0; i < vertexCount; ++i)
+    factory.insertVertex(positions[vertexCount-1-i]);
+  for (const auto& element : elements(gridView))
+  {
+    const auto& permutation = permutations[indexSet.index(element) % permutations.size()];
+    std::vector<unsigned int> corners(dim+1);
+    for (int m = 0; m <= dim; ++m)
+      corners[m] = vertexCount-1-indexSet.subIndex(element, permutation[m], dim);
+    factory.insertElement(element.type(), corners);
+  }
+  return factory.createGrid();
+}
+
+template <class Grid>
+void testPermutedGrid(TestSuite& test)
+{
+  static const int dim = Grid::dimension;
+  auto gridPtr = createPermutedSimplexGrid<Grid>();
+  auto gridView = gridPtr->leafGridView();
+
+  // The interior DOFs couple to the edges and faces for k>=dim+2
+  using namespace Functions::BasisFactory;
+  auto basis = makeBasis(gridView, hierarchicalLagrange<dim+2>());
+  test.subTest(checkBasis(basis, EnableContinuityCheck()));
+  test.subTest(checkInterpolationAndInteriorDOFs(basis, dim+2));
+
+  auto basis2 = makeBasis(gridView, hierarchicalLagrange<dim+3>());
+  test.subTest(checkInterpolationAndInteriorDOFs(basis2, dim+3));
+}
+
 template <class Grid>
 void testDim(TestSuite& test)
 {
@@ -34,6 +143,9 @@ void testDim(TestSuite& test)
 
     Functions::HierarchicalLagrangeBasis<GridView,2> basis2(gridView);
     test.subTest(checkBasis(basis2, EnableContinuityCheck()));
+
+    Functions::HierarchicalLagrangeBasis<GridView,3> basis3(gridView);
+    test.subTest(checkBasis(basis3, EnableContinuityCheck()));
   }
 
   // check HierarchicalBasis created using basis builder mechanism
@@ -44,6 +156,13 @@ void testDim(TestSuite& test)
 
     auto basis2 = makeBasis(gridView, hierarchicalLagrange<2>());
     test.subTest(checkBasis(basis2, EnableContinuityCheck()));
+
+    auto basis4 = makeBasis(gridView, hierarchicalLagrange<4>());
+    test.subTest(checkBasis(basis4, EnableContinuityCheck()));
+    test.subTest(checkInterpolationAndInteriorDOFs(basis4, 4));
+
+    auto basis5 = makeBasis(gridView, hierarchicalLagrange<5>());
+    test.subTest(checkInterpolationAndInteriorDOFs(basis5, 5));
   }
 }
 
@@ -55,6 +174,8 @@ int main (int argc, char* argv[])
   testDim<OneDGrid>(test);
   testDim<UGGrid<2>>(test);
   testDim<UGGrid<3>>(test);
+  testPermutedGrid<UGGrid<2>>(test);
+  testPermutedGrid<UGGrid<3>>(test);
 
   return test.exit();
 }
@@ -0,0 +1,259 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/exceptions.hh>
+#include <dune/common/indices.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/grid/uggrid.hh>
+#include <dune/grid/yaspgrid.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/matrixindexset.hh>
+
+#include <dune/functions/functionspacebases/boundarydofs.hh>
+#include <dune/functions/functionspacebases/brezzidouglasmarinibasis.hh>
+#include <dune/functions/functionspacebases/brokenbasis.hh>
+#include <dune/functions/functionspacebases/compositebasis.hh>
+#include <dune/functions/functionspacebases/facetlagrangebasis.hh>
+#include <dune/functions/functionspacebases/hybridization.hh>
+#include <dune/functions/functionspacebases/lagrangebasis.hh>
+#include <dune/functions/functionspacebases/lagrangedgbasis.hh>
+#include <dune/functions/functionspacebases/raviartthomasbasis.hh>
+
+#include <dune/functions/functionspacebases/test/basistest.hh>
+
+using namespace Dune;
+using namespace Dune::Functions;
+using namespace Dune::Indices;
+
+// Assemble the element matrix and vector of the mixed Poisson problem
+//   (sigma, tau) - (p, div tau) = 0,  -(div sigma, q) = -(f, q)
+// with homogeneous Dirichlet values for the pressure. The flux and the
+// pressure are the first and the second child of the local view.
+struct MixedPoissonAssembler
+{
+  template<class LocalView, class Matrix, class Vector>
+  void operator()(const LocalView& localView, Matrix& elementMatrix, Vector& elementVector) const
+  {
+    static const int dim = LocalView::GridView::dimension;
+    const auto& element = localView.element();
+    const auto& geometry = element.geometry();
+    const auto& fluxNode = localView.tree().child(_0);
+    const auto& pressureNode = localView.tree().child(_1);
+    const auto& fluxLocalBasis = fluxNode.finiteElement().localBasis();
+    const auto& pressureLocalBasis = pressureNode.finiteElement().localBasis();
+
+    std::vector<FieldVector<double,dim>> fluxValues;
+    std::vector<FieldMatrix<double,dim,dim>> fluxJacobians;
+    std::vector<FieldVector<double,1>> pressureValues;
+    int order = 2*std::max<int>(fluxLocalBasis.order(), pressureLocalBasis.order()) + 2;
+    for (const auto& quadPoint : QuadratureRules<double,dim>::rule(element.type(), order))
+    {
+      const auto& x = quadPoint.position();
+      const auto jacobianInverse = geometry.jacobianInverse(x);
+      const auto factor = quadPoint.weight() * geometry.integrationElement(x);
+      const auto globalX = geometry.global(x);
+      const double f = std::sin(3*globalX[0]) + globalX[1];
+
+      fluxLocalBasis.evaluateFunction(x, fluxValues);
+      fluxLocalBasis.evaluateJacobian(x, fluxJacobians);
+      pressureLocalBasis.evaluateFunction(x, pressureValues);
+
+      for (std::size_t i = 0; i < fluxValues.size(); ++i)
+      {
+        auto jacobian = fluxJacobians[i] * jacobianInverse;
+        double divergence = 0;
+        for (int j = 0; j < dim; ++j)
+          divergence += jacobian[j][j];
+
+        for (std::size_t j = 0; j < fluxValues.size(); ++j)
+          elementMatrix[fluxNode.localIndex(i)][fluxNode.localIndex(j)] += (fluxValues[i] * fluxValues[j]) * factor;
+        for (std::size_t j = 0; j < pressureValues.size(); ++j)
+        {
+          double b = -divergence * pressureValues[j][0] * factor;
+          elementMatrix[fluxNode.localIndex(i)][pressureNode.localIndex(j)] += b;
+          elementMatrix[pressureNode.localIndex(j)][fluxNode.localIndex(i)] += b;
+        }
+      }
+      for (std::size_t j = 0; j < pressureValues.size(); ++j)
+        elementVector[pressureNode.localIndex(j)] -= f * pressureValues[j][0] * factor;
+    }
+  }
+
+  template<class LocalView, class MultiplierLocalView, class Matrix, class Vector>
+  void operator()(const LocalView& localView, const MultiplierLocalView& multiplierLocalView, Matrix& elementMatrix, Matrix& couplingMatrix, Vector& elementVector) const
+  {
+    (*this)(localView, elementMatrix, elementVector);
+    addNormalTraceCoupling(localView.tree().child(_0), multiplierLocalView.tree(), couplingMatrix);
+  }
+};
+
+// Evaluate flux and pressure at the center of the element
+template<class LocalView, class Vector>
+auto evaluateAtCenter(const LocalView& localView, const Vector& x)
+{
+  static const int dim = LocalView::GridView::dimension;
+  const auto& center = referenceElement(localView.element().geometry()).position(0,0);
+  const auto& fluxNode = localView.tree().child(_0);
+  const auto& pressureNode = localView.tree().child(_1);
+
+  std::vector<FieldVector<double,dim>> fluxValues;
+  std::vector<FieldVector<double,1>> pressureValues;
+  fluxNode.finiteElement().localBasis().evaluateFunction(center, fluxValues);
+  pressureNode.finiteElement().localBasis().evaluateFunction(center, pressureValues);
+
+  FieldVector<double,dim+1> result(0);
+  for (std::size_t i = 0; i < fluxValues.size(); ++i)
+    for (int j = 0; j < dim; ++j)
+      result[j] += x[localView.index(fluxNode.localIndex(i))[0]] * fluxValues[i][j];
+  for (std::size_t i = 0; i < pressureValues.size(); ++i)
+    result[dim] += x[localView.index(pressureNode.localIndex(i))[0]] * pressureValues[i][0];
+  return result;
+}
+
+// Compare the hybridized solution with the solution of the full saddle point problem
+template<class GridView, class FluxFactory, class PressureFactory, class MultiplierFactory>
+TestSuite checkHybridization(const GridView& gridView, const FluxFactory& flux, const PressureFactory& pressure, const MultiplierFactory& multiplier)
+{
+  TestSuite test("Hybridization");
+  using namespace Functions::BasisFactory;
+  MixedPoissonAssembler localAssembler;
+
+  // The full saddle point problem
+  auto basis = makeBasis(gridView, composite(flux, pressure, flatLexicographic()));
+  const auto n = basis.dimension();
+  DynamicMatrix<double> matrix(n, n, 0.0);
+  DynamicVector<double> rhs(n, 0.0), x(n);
+  {
+    auto localView = basis.localView();
+    DynamicMatrix<double> elementMatrix;
+    DynamicVector<double> elementVector;
+    for (const auto& element : elements(gridView))
+    {
+      localView.bind(element);
+      elementMatrix.resize(localView.size(), localView.size());
+      elementVector.resize(localView.size());
+      elementMatrix = 0;
+      elementVector = 0;
+      localAssembler(localView, elementMatrix, elementVector);
+      for (std::size_t i = 0; i < localView.size(); ++i)
+      {
+        rhs[localView.index(i)[0]] += elementVector[i];
+        for (std::size_t j = 0; j < localView.size(); ++j)
+          matrix[localView.index(i)[0]][localView.index(j)[0]] += elementMatrix[i][j];
+      }
+    }
+  }
+  matrix.solve(x, rhs);
+
+  // The hybridized problem
+  auto brokenBasis = makeBasis(gridView, composite(broken(flux), pressure, flatLexicographic()));
+  auto multiplierBasis = makeBasis(gridView, multiplier);
+  test.check(brokenBasis.dimension() > basis.dimension())
+    << "Broken basis does not decouple the flux DOFs";
+
+  Hybridization hybridization(brokenBasis, multiplierBasis);
+  hybridization.condense(localAssembler, 2);
+
+  const auto m = multiplierBasis.dimension();
+  MatrixIndexSet pattern;
+  hybridization.multiplierPattern(pattern);
+  BCRSMatrix<double> multiplierMatrix;
+  pattern.exportIdx(multiplierMatrix);
+  multiplierMatrix = 0;
+  BlockVector<double> multiplierRhs(m);
+  multiplierRhs = 0;
+  hybridization.assembleMultiplierSystem(multiplierMatrix, multiplierRhs);
+
+  DynamicMatrix<double> denseMatrix(m, m, 0.0);
+  for (auto row = multiplierMatrix.begin(); row != multiplierMatrix.end(); ++row)
+    for (auto entry = row->begin(); entry != row->end(); ++entry)
+      denseMatrix[row.index()][entry.index()] = *entry;
+  for (std::size_t i = 0; i < m; ++i)
+    for (std::size_t j = 0; j < m; ++j)
+      test.check(std::abs(denseMatrix[i][j] - denseMatrix[j][i]) < 1e-10)
+        << "Multiplier system is not symmetric";
+
+  // The multiplier is the pressure trace, hence it vanishes on the boundary
+  std::vector<bool> isBoundary(m, false);
+  forEachBoundaryDOF(multiplierBasis, [&](auto&& localIndex, const auto& localView) {
+    isBoundary[localView.index(localIndex)[0]] = true;
+  });
+  DynamicVector<double> denseRhs(m), lambda(m);
+  for (std::size_t i = 0; i < m; ++i)
+  {
+    denseRhs[i] = isBoundary[i] ? 0.0 : multiplierRhs[i];
+    if (isBoundary[i])
+      for (std::size_t j = 0; j < m; ++j)
+        denseMatrix[i][j] = (i == j) ? 1.0 : 0.0;
+  }
+  denseMatrix.solve(lambda, denseRhs);
+
+  std::vector<double> y(brokenBasis.dimension());
+  hybridization.recoverSolution(lambda, y);
+
+  auto localView = basis.localView();
+  auto brokenLocalView = brokenBasis.localView();
+  for (const auto& element : elements(gridView))
+  {
+    localView.bind(element);
+    brokenLocalView.bind(element);
+    auto difference = evaluateAtCenter(localView, x) - evaluateAtCenter(brokenLocalView, y);
+    test.check(difference.infinity_norm() < 1e-8)
+      << "Hybridized solution does not match the solution of the saddle point problem";
+  }
+
+  return test;
+}
+
+int main (int argc, char* argv[]) try
+{
+  Dune::MPIHelper::instance(argc, argv);
+
+  TestSuite test;
+
+  using namespace Functions::BasisFactory;
+
+  {
+    YaspGrid<2> grid({1.0, 1.0}, {4, 3});
+    auto gridView = grid.leafGridView();
+
+    auto brokenBasis = makeBasis(gridView, broken(raviartThomas<1>()));
+    test.subTest(checkBasis(brokenBasis));
+
+    auto multiplierBasis = makeBasis(gridView, facetLagrange<1>());
+    test.check(multiplierBasis.dimension() == 2*gridView.size(1))
+      << "Wrong dimension of FacetLagrangeBasis";
+
+    test.subTest(checkHybridization(gridView, raviartThomas<0>(), lagrange<0>(), facetLagrange<0>()));
+    test.subTest(checkHybridization(gridView, raviartThomas<1>(), lagrangeDG<1>(), facetLagrange<1>()));
+    test.subTest(checkHybridization(gridView, brezziDouglasMarini<1>(), lagrange<0>(), facetLagrange<1>()));
+  }
+
+  {
+    using Grid = UGGrid<2>;
+    auto grid = StructuredGridFactory<Grid>::createSimplexGrid({0.0, 0.0}, {1.0, 1.0}, {3, 3});
+    test.subTest(checkHybridization(grid->leafGridView(), raviartThomas<0>(), lagrange<0>(), facetLagrange<0>()));
+  }
+
+  return test.exit();
+}
+catch (Exception &e)
+{
+  std::cerr << "Exception: " << e << std::endl;
+  return 1;
+}
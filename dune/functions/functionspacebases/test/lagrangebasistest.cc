@@ -13,7 +13,9 @@
 #include <dune/grid/io/file/vtk/subsamplingvtkwriter.hh>
 #include <dune/grid/utility/structuredgridfactory.hh>
 
+#include <dune/functions/functionspacebases/dynamicpowerbasis.hh>
 #include <dune/functions/functionspacebases/lagrangebasis.hh>
+#include <dune/functions/functionspacebases/powerbasis.hh>
 
 #include <dune/functions/functionspacebases/test/basistest.hh>
 #include <dune/functions/gridfunctions/discreteglobalbasisfunction.hh>
@@ -21,6 +23,30 @@
 using namespace Dune;
 using namespace Dune::Functions;
 
+// The children of a power node of Lagrange nodes are bound once
+// and must share the local finite element of the first child.
+template<class Basis>
+Dune::TestSuite checkSharedPowerChildren(const Basis& basis)
+{
+  Dune::TestSuite test("shared finite elements of power node children");
+  auto localView = basis.localView();
+  for (const auto& element : elements(basis.gridView()))
+  {
+    localView.bind(element);
+    const auto& tree = localView.tree();
+    for (std::size_t i = 0; i < tree.degree(); ++i)
+    {
+      test.check(&tree.child(i).finiteElement() == &tree.child(0).finiteElement())
+        << "Child " << i << " does not share the finite element of the first child";
+      test.check(tree.child(i).localIndex(0) == i*tree.child(0).size())
+        << "Child " << i << " has wrong offset";
+      test.check(&tree.child(i).element() == &localView.element())
+        << "Child " << i << " is not bound to the element of the local view";
+    }
+  }
+  return test;
+}
+
 
 
 int main (int argc, char* argv[])
@@ -63,6 +89,34 @@ int main (int argc, char* argv[])
     vtkWriter.addVertexData(v_f, VTK::FieldInfo("lambda_5", VTK::FieldInfo::Type::scalar, 1));
     vtkWriter.write("debug");
 
+    {
+      // With run-time order all local views share the local finite elements
+      auto basis = makeBasis(gridView, lagrange(3));
+      test.subTest(checkBasis(basis, EnableContinuityCheck()));
+
+      auto localView = basis.localView();
+      auto otherLocalView = basis.localView();
+      for (const auto& element : elements(gridView))
+      {
+        localView.bind(element);
+        otherLocalView.bind(element);
+        test.check(&localView.tree().finiteElement() == &otherLocalView.tree().finiteElement())
+          << "Local views of basis with run-time order do not share the finite element";
+      }
+    }
+
+    {
+      auto powerBasis = makeBasis(gridView, power<3>(lagrange<2>()));
+      test.subTest(checkBasis(powerBasis, EnableContinuityCheck()));
+      test.subTest(checkSharedPowerChildren(powerBasis));
+    }
+
+    {
+      auto powerBasis = makeBasis(gridView, power(lagrange(2), 3));
+      test.subTest(checkBasis(powerBasis, EnableContinuityCheck()));
+      test.subTest(checkSharedPowerChildren(powerBasis));
+    }
+
   }
 
   {
@@ -93,6 +147,112 @@ int main (int argc, char* argv[])
 
   }
 
+  // Higher order bases in 3d require a consistent numbering of the face DOFs
+  {
+    using Grid = Dune::YaspGrid<3>;
+    Grid grid({1.0, 1.0, 1.0}, {2, 2, 2});
+    auto gridView = grid.leafGridView();
+
+    {
+      auto basis = makeBasis(gridView, lagrange<4>());
+      test.subTest(checkBasis(basis, EnableContinuityCheck()));
+    }
+
+    {
+      auto basis = makeBasis(gridView, lagrange(5));
+      test.subTest(checkBasis(basis, EnableContinuityCheck()));
+    }
+  }
+
+  {
+    using Grid = Dune::UGGrid<3>;
+    auto grid = StructuredGridFactory<Grid>::createSimplexGrid({0.0, 0.0, 0.0}, {1.0, 1.0, 1.0}, {2, 2, 2});
+    auto gridView = grid->leafGridView();
+
+    {
+      auto basis = makeBasis(gridView, lagrange<4>());
+      test.subTest(checkBasis(basis, EnableContinuityCheck()));
+    }
+
+    {
+      auto basis = makeBasis(gridView, lagrange(6));
+      test.subTest(checkBasis(basis, EnableContinuityCheck()));
+    }
+  }
+
+  // Unstructured hexahedral grid, which does not use the closed form indices of YaspGrid
+  {
+    using Grid = Dune::UGGrid<3>;
+    auto grid = StructuredGridFactory<Grid>::createCubeGrid({0.0, 0.0, 0.0}, {1.0, 1.0, 1.0}, {2, 2, 2});
+    auto gridView = grid->leafGridView();
+    auto basis = makeBasis(gridView, lagrange<4>());
+    test.subTest(checkBasis(basis, EnableContinuityCheck()));
+  }
+
+  // Mixed grid containing all 3d element types. The faces shared by different
+  // element types have to be numbered consistently by all of them.
+  {
+    using Grid = Dune::UGGrid<3>;
+    Dune::GridFactory<Grid> factory;
+    factory.insertVertex({0.0, 0.0, 0.0});
+    factory.insertVertex({1.0, 0.0, 0.0});
+    factory.insertVertex({0.0, 1.0, 0.0});
+    factory.insertVertex({1.0, 1.0, 0.0});
+    factory.insertVertex({0.0, 0.0, 1.0});
+    factory.insertVertex({1.0, 0.0, 1.0});
+    factory.insertVertex({0.0, 1.0, 1.0});
+    factory.insertVertex({1.0, 1.0, 1.0});
+    factory.insertVertex({2.0, 0.0, 0.0});
+    factory.insertVertex({2.0, 0.0, 1.0});
+    factory.insertVertex({0.5, 0.5, 1.5});
+    factory.insertVertex({0.5, -0.5, 1.2});
+    factory.insertElement(Dune::GeometryTypes::hexahedron, {0, 1, 2, 3, 4, 5, 6, 7});
+    factory.insertElement(Dune::GeometryTypes::prism, {1, 8, 3, 5, 9, 7});
+    factory.insertElement(Dune::GeometryTypes::pyramid, {4, 5, 6, 7, 10});
+    factory.insertElement(Dune::GeometryTypes::tetrahedron, {4, 5, 10, 11});
+    auto grid = factory.createGrid();
+    auto gridView = grid->leafGridView();
+
+    {
+      auto basis = makeBasis(gridView, lagrange(3));
+      test.subTest(checkBasis(basis, EnableContinuityCheck()));
+    }
+
+    {
+      auto basis = makeBasis(gridView, lagrange(4));
+      test.subTest(checkBasis(basis, EnableContinuityCheck()));
+    }
+  }
+
+  // On YaspGrid the indices are computed in closed form. They must be
+  // the same as the generic ones: For second order these are the vertex
+  // indices, followed by the edge indices and the element indices.
+  {
+    using Grid = Dune::YaspGrid<2>;
+    Grid grid({1.0, 1.0}, {3, 2});
+    auto gridView = grid.leafGridView();
+    const auto& indexSet = gridView.indexSet();
+    auto basis = makeBasis(gridView, lagrange<2>());
+    test.subTest(checkBasis(basis, EnableContinuityCheck()));
+
+    auto localView = basis.localView();
+    for (const auto& element : elements(gridView))
+    {
+      localView.bind(element);
+      const auto& node = localView.tree();
+      for (std::size_t i = 0; i < node.size(); ++i)
+      {
+        const auto& localKey = node.finiteElement().localCoefficients().localKey(i);
+        std::size_t expected = indexSet.subIndex(element, localKey.subEntity(), localKey.codim());
+        if (localKey.codim() < 2)
+          expected += gridView.size(2);
+        if (localKey.codim() < 1)
+          expected += gridView.size(1);
+        test.check(localView.index(node.localIndex(i))[0] == expected)
+          << "Index of DOF " << i << " differs from the generic numbering";
+      }
+    }
+  }
 
   return test.exit();
 }
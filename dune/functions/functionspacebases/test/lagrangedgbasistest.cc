@@ -52,5 +52,16 @@ int main (int argc, char* argv[])
 
 
 
+  // check LagrangeDGBasis with element blocks
+  {
+    using namespace Functions::BasisFactory;
+    auto basis = makeBasis(grid.leafGridView(), lagrangeDG<2>(blockedLexicographic()));
+    test.subTest(checkBasis(basis));
+    test.check(basis.size() == 100 and basis.size(std::decay_t<decltype(basis)>::SizePrefix{5}) == 9)
+      << "Blocked LagrangeDGBasis has wrong block structure";
+  }
+
+
+
   return test.exit();
 }
@@ -0,0 +1,126 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/grid/uggrid.hh>
+#include <dune/grid/yaspgrid.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
+
+#include <dune/istl/bcrsmatrix.hh>
+
+#include <dune/functions/functionspacebases/interpolate.hh>
+#include <dune/functions/functionspacebases/lagrangebasis.hh>
+#include <dune/functions/functionspacebases/lagrangeordertransfer.hh>
+
+using namespace Dune;
+using namespace Dune::Functions;
+
+template<class CoarseBasis, class FineBasis>
+TestSuite checkLagrangeOrderTransfer(const CoarseBasis& coarseBasis, const FineBasis& fineBasis)
+{
+  TestSuite test("LagrangeOrderTransfer");
+
+  const auto n = fineBasis.dimension();
+  const auto m = coarseBasis.dimension();
+
+  // A polynomial of the coarse order is reproduced exactly by the fine basis
+  auto f = [](const auto& x) {
+    return 1 + x[0] - 2*x[0]*x[1] + x[1]*x[1];
+  };
+  std::vector<double> coarse, fineExact;
+  interpolate(coarseBasis, coarse, f);
+  interpolate(fineBasis, fineExact, f);
+
+  LagrangeOrderTransfer transfer(coarseBasis, fineBasis);
+
+  std::vector<std::vector<double>> fine;
+  for (std::size_t threads : {1, 3})
+  {
+    fine.emplace_back(n, 0.0);
+    transfer.applyProlongation(coarse, fine.back(), threads);
+    for (std::size_t i = 0; i < n; ++i)
+      test.check(std::abs(fine.back()[i] - fineExact[i]) < 1e-10)
+        << "Prolongation does not reproduce the interpolant with " << threads << " threads";
+  }
+
+  BCRSMatrix<double> prolongation;
+  transfer.assembleProlongationMatrix(prolongation);
+  test.check(prolongation.N() == n and prolongation.M() == m)
+    << "Prolongation matrix has wrong size";
+
+  std::vector<double> fineMatrix(n, 0.0);
+  for (auto row = prolongation.begin(); row != prolongation.end(); ++row)
+    for (auto entry = row->begin(); entry != row->end(); ++entry)
+      fineMatrix[row.index()] += *entry * coarse[entry.index()];
+  for (std::size_t i = 0; i < n; ++i)
+    test.check(std::abs(fineMatrix[i] - fine[0][i]) < 1e-10)
+      << "Prolongation matrix does not match matrix-free prolongation";
+
+  // Restriction of an arbitrary vector must be the transposed matrix-vector product
+  std::vector<double> residual(n);
+  for (std::size_t i = 0; i < n; ++i)
+    residual[i] = std::sin(1.0 + i);
+  std::vector<double> restrictedMatrix(m, 0.0);
+  for (auto row = prolongation.begin(); row != prolongation.end(); ++row)
+    for (auto entry = row->begin(); entry != row->end(); ++entry)
+      restrictedMatrix[entry.index()] += *entry * residual[row.index()];
+  for (std::size_t threads : {1, 4})
+  {
+    std::vector<double> restricted(m, 0.0);
+    transfer.applyRestriction(residual, restricted, threads);
+    for (std::size_t j = 0; j < m; ++j)
+      test.check(std::abs(restricted[j] - restrictedMatrix[j]) < 1e-10)
+        << "Restriction does not match the transposed prolongation with " << threads << " threads";
+  }
+
+  return test;
+}
+
+int main (int argc, char* argv[]) try
+{
+  Dune::MPIHelper::instance(argc, argv);
+
+  TestSuite test;
+
+  using namespace Functions::BasisFactory;
+
+  {
+    YaspGrid<2> grid({1.0, 1.0}, {3, 4});
+    auto gridView = grid.leafGridView();
+    auto basis1 = makeBasis(gridView, lagrange<1>());
+    auto basis2 = makeBasis(gridView, lagrange<2>());
+    auto basis4 = makeBasis(gridView, lagrange<4>());
+    test.subTest(checkLagrangeOrderTransfer(basis2, basis4));
+    test.subTest(checkLagrangeOrderTransfer(basis2, basis2));
+
+    // The test function is not contained in Q1, hence we only check the local matrix
+    LagrangeOrderTransfer transfer(basis1, basis2);
+    test.check(transfer.localMatrix(GeometryTypes::quadrilateral).N() == 9
+      and transfer.localMatrix(GeometryTypes::quadrilateral).M() == 4)
+      << "Local transfer matrix has wrong size";
+  }
+
+  {
+    using Grid = UGGrid<2>;
+    auto grid = StructuredGridFactory<Grid>::createSimplexGrid({0.0, 0.0}, {1.0, 1.0}, {3, 3});
+    auto gridView = grid->leafGridView();
+    auto basis2 = makeBasis(gridView, lagrange<2>());
+    auto basis3 = makeBasis(gridView, lagrange<3>());
+    test.subTest(checkLagrangeOrderTransfer(basis2, basis3));
+  }
+
+  return test.exit();
+}
+catch (Exception &e)
+{
+  std::cerr << "Exception: " << e << std::endl;
+  return 1;
+}
@@ -0,0 +1,176 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/filledarray.hh>
+#include <dune/common/parallel/mpihelper.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/grid/uggrid.hh>
+#include <dune/grid/yaspgrid.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
+
+#include <dune/functions/functionspacebases/dginversemassoperator.hh>
+#include <dune/functions/functionspacebases/interpolate.hh>
+#include <dune/functions/functionspacebases/modaldgbasis.hh>
+
+#include <dune/functions/functionspacebases/test/basistest.hh>
+
+using namespace Dune;
+using namespace Dune::Functions;
+
+// Check that the shape functions are orthonormal on the reference element,
+// that the truncated sizes match the polynomial spaces, and that the
+// interpolation reproduces polynomials of the basis order.
+template<int dim, int k>
+TestSuite checkLocalFiniteElement(GeometryType type)
+{
+  TestSuite test("ModalDGLocalFiniteElement");
+
+  Impl::ModalDGLocalFiniteElement<double,double,dim,k> fe(type);
+  const auto& localBasis = fe.localBasis();
+  const auto n = fe.size();
+
+  std::vector<FieldVector<double,1>> values;
+  std::vector<double> mass(n*n, 0.0);
+  for (const auto& quadPoint : QuadratureRules<double,dim>::rule(type, 2*k))
+  {
+    localBasis.evaluateFunction(quadPoint.position(), values);
+    for (std::size_t i = 0; i < n; ++i)
+      for (std::size_t j = 0; j < n; ++j)
+        mass[i*n+j] += values[i][0]*values[j][0]*quadPoint.weight();
+  }
+  for (std::size_t i = 0; i < n; ++i)
+    for (std::size_t j = 0; j < n; ++j)
+      test.check(std::abs(mass[i*n+j] - (i == j ? 1.0 : 0.0)) < 1e-10)
+        << "Shape functions " << i << " and " << j << " are not orthonormal on " << type;
+
+  for (int j = 0; j <= k; ++j)
+    test.check(fe.truncatedSize(j) == (type.isSimplex() ? binomial(j+dim, dim) : power(j+1, dim)))
+      << "Wrong truncated size for order " << j << " on " << type;
+
+  // A polynomial of total order k is contained in both spaces
+  auto f = [](const auto& x) {
+    double y = 1;
+    for (int i = 0; i < dim; ++i)
+      y += (i+1)*x[i];
+    return std::pow(y, k);
+  };
+  std::vector<double> coefficients;
+  fe.localInterpolation().interpolate(f, coefficients);
+  FieldVector<double,dim> x(0.2);
+  localBasis.evaluateFunction(x, values);
+  double y = 0;
+  for (std::size_t i = 0; i < n; ++i)
+    y += coefficients[i]*values[i][0];
+  test.check(std::abs(y - f(x)) < 1e-10)
+    << "Interpolation does not reproduce polynomials on " << type;
+
+  return test;
+}
+
+template<class Basis>
+TestSuite checkDiagonalInverseMass(const Basis& basis)
+{
+  TestSuite test("DGInverseMassOperator for ModalDGBasis");
+
+  // On affine elements the mass matrix is the identity scaled by the
+  // volume of the element relative to the reference element.
+  std::vector<double> x(basis.dimension(), 1.0), y(basis.dimension());
+  DGInverseMassOperator inverseMass(basis);
+  inverseMass.apply(x, y);
+
+  auto localView = basis.localView();
+  for (const auto& element : elements(basis.gridView()))
+  {
+    localView.bind(element);
+    const auto& geometry = element.geometry();
+    auto scale = 1/geometry.integrationElement(referenceElement(geometry).position(0,0));
+    for (std::size_t i = 0; i < localView.size(); ++i)
+      test.check(std::abs(y[localView.index(i)] - scale) < 1e-10)
+        << "Inverse mass matrix is not diagonal";
+  }
+  return test;
+}
+
+template <class Grid>
+void testSimplexGrid(TestSuite& test)
+{
+  static const int dim = Grid::dimension;
+  using Factory = StructuredGridFactory<Grid>;
+  FieldVector<double,dim> lower(0.0), upper(1.0);
+  std::array<unsigned int,dim> elems = Dune::filledArray<dim,unsigned int>(2);
+  auto gridPtr = Factory::createSimplexGrid(lower, upper, elems);
+
+  using namespace Functions::BasisFactory;
+  auto basis = makeBasis(gridPtr->leafGridView(), modalDG<3>());
+  test.subTest(checkBasis(basis));
+  test.subTest(checkDiagonalInverseMass(basis));
+}
+
+int main (int argc, char* argv[]) try
+{
+  Dune::MPIHelper::instance(argc, argv);
+
+  Dune::TestSuite test;
+
+  test.subTest(checkLocalFiniteElement<1,4>(GeometryTypes::line));
+  test.subTest(checkLocalFiniteElement<2,4>(GeometryTypes::quadrilateral));
+  test.subTest(checkLocalFiniteElement<2,5>(GeometryTypes::triangle));
+  test.subTest(checkLocalFiniteElement<3,3>(GeometryTypes::hexahedron));
+  test.subTest(checkLocalFiniteElement<3,4>(GeometryTypes::tetrahedron));
+
+  {
+    const int dim = 2;
+    using Grid = YaspGrid<dim>;
+    Grid grid({1.0, 1.0}, {4, 5});
+    using GridView = Grid::LeafGridView;
+
+    // check ModalDGBasis created 'manually'
+    ModalDGBasis<GridView,2> basis(grid.leafGridView());
+    test.subTest(checkBasis(basis));
+
+    // check ModalDGBasis created using basis builder mechanism
+    using namespace Functions::BasisFactory;
+    auto basis3 = makeBasis(grid.leafGridView(), modalDG<3>());
+    test.subTest(checkBasis(basis3));
+    test.subTest(checkDiagonalInverseMass(basis3));
+
+    // The interpolation is exact for polynomials, and truncating the
+    // coefficients of each element yields the interpolant of lower order.
+    auto f = [](const auto& x) { return x[0]*x[0] + 2*x[0]*x[1] + x[1]; };
+    std::vector<double> coefficients, coefficients3;
+    interpolate(basis, coefficients, f);
+    interpolate(basis3, coefficients3, f);
+    auto localView = basis.localView();
+    auto localView3 = basis3.localView();
+    for (const auto& element : elements(grid.leafGridView()))
+    {
+      localView.bind(element);
+      localView3.bind(element);
+      const auto& fe3 = localView3.tree().finiteElement();
+      for (std::size_t i = 0; i < fe3.size(); ++i)
+      {
+        auto c = (i < fe3.truncatedSize(2)) ? coefficients[localView.index(i)] : 0.0;
+        test.check(std::abs(coefficients3[localView3.index(i)] - c) < 1e-10)
+          << "Truncated coefficients do not match the lower order interpolant";
+      }
+    }
+  }
+
+  testSimplexGrid<UGGrid<2>>(test);
+  testSimplexGrid<UGGrid<3>>(test);
+
+  return test.exit();
+}
+catch (Exception &e)
+{
+  std::cerr << "Exception: " << e << std::endl;
+  return 1;
+}
@@ -0,0 +1,170 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/dynmatrix.hh>
+#include <dune/common/dynvector.hh>
+#include <dune/common/exceptions.hh>
+#include <dune/common/filledarray.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/grid/uggrid.hh>
+#include <dune/grid/yaspgrid.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
+
+#include <dune/istl/bcrsmatrix.hh>
+#include <dune/istl/bvector.hh>
+#include <dune/istl/matrixindexset.hh>
+
+#include <dune/functions/functionspacebases/hierarchicallagrangebasis.hh>
+#include <dune/functions/functionspacebases/lagrangebasis.hh>
+#include <dune/functions/functionspacebases/staticcondensation.hh>
+
+using namespace Dune;
+using namespace Dune::Functions;
+
+// Assemble the element matrix and vector of the problem -div(grad u) + u = f
+// with natural boundary conditions and a variable right hand side
+struct LocalAssembler
+{
+  template<class LocalView, class Matrix, class Vector>
+  void operator()(const LocalView& localView, Matrix& elementMatrix, Vector& elementVector) const
+  {
+    static const int dim = LocalView::GridView::dimension;
+    const auto& node = localView.tree();
+    const auto& localBasis = node.finiteElement().localBasis();
+    const auto& geometry = localView.element().geometry();
+    const auto& quadRule = QuadratureRules<double,dim>::rule(localView.element().type(), 2*localBasis.order());
+    for (const auto& quadPoint : quadRule)
+    {
+      const auto& x = quadPoint.position();
+      localBasis.evaluateFunction(x, values_);
+      localBasis.evaluateJacobian(x, jacobians_);
+      const auto& jacobianInverseTransposed = geometry.jacobianInverseTransposed(x);
+      gradients_.resize(jacobians_.size());
+      for (std::size_t i = 0; i < jacobians_.size(); ++i)
+        jacobianInverseTransposed.mv(jacobians_[i][0], gradients_[i]);
+      auto factor = quadPoint.weight() * geometry.integrationElement(x);
+      auto globalX = geometry.global(x);
+      auto f = std::sin(3*globalX[0]) + globalX[1];
+      for (std::size_t i = 0; i < node.size(); ++i)
+      {
+        elementVector[node.localIndex(i)] += f * values_[i][0] * factor;
+        for (std::size_t j = 0; j < node.size(); ++j)
+          elementMatrix[node.localIndex(i)][node.localIndex(j)] += (gradients_[i] * gradients_[j] + values_[i][0] * values_[j][0]) * factor;
+      }
+    }
+  }
+
+  mutable std::vector<FieldVector<double,1>> values_;
+  mutable std::vector<FieldMatrix<double,1,2>> jacobians_;
+  mutable std::vector<FieldVector<double,2>> gradients_;
+};
+
+// Compare the condensed solution with the solution of the full system
+template<class Basis>
+TestSuite checkStaticCondensation(const Basis& basis, std::size_t threads)
+{
+  TestSuite test("StaticCondensation");
+
+  const auto n = basis.dimension();
+  DynamicMatrix<double> matrix(n, n, 0.0);
+  DynamicVector<double> rhs(n, 0.0), x(n);
+  LocalAssembler localAssembler;
+  auto localView = basis.localView();
+  DynamicMatrix<double> elementMatrix;
+  DynamicVector<double> elementVector;
+  for (const auto& element : elements(basis.gridView()))
+  {
+    localView.bind(element);
+    elementMatrix.resize(localView.size(), localView.size());
+    elementVector.resize(localView.size());
+    elementMatrix = 0;
+    elementVector = 0;
+    localAssembler(localView, elementMatrix, elementVector);
+    for (std::size_t i = 0; i < localView.size(); ++i)
+    {
+      rhs[localView.index(i)] += elementVector[i];
+      for (std::size_t j = 0; j < localView.size(); ++j)
+        matrix[localView.index(i)][localView.index(j)] += elementMatrix[i][j];
+    }
+  }
+  matrix.solve(x, rhs);
+
+  StaticCondensation condensation(basis);
+  condensation.condense(localAssembler, threads);
+  const auto m = condensation.skeletonSize();
+  test.check(m + condensation.interiorSize() == n)
+    << "Skeleton and interior DOFs do not partition the DOFs";
+  test.check(m < n)
+    << "No interior DOFs have been eliminated";
+
+  MatrixIndexSet pattern;
+  condensation.skeletonPattern(pattern);
+  BCRSMatrix<double> skeletonMatrix;
+  pattern.exportIdx(skeletonMatrix);
+  skeletonMatrix = 0;
+  BlockVector<double> skeletonRhs(m);
+  skeletonRhs = 0;
+  condensation.assembleSkeletonSystem(skeletonMatrix, skeletonRhs);
+
+  DynamicMatrix<double> denseSkeletonMatrix(m, m, 0.0);
+  for (auto row = skeletonMatrix.begin(); row != skeletonMatrix.end(); ++row)
+    for (auto entry = row->begin(); entry != row->end(); ++entry)
+      denseSkeletonMatrix[row.index()][entry.index()] = *entry;
+  DynamicVector<double> denseSkeletonRhs(m), skeletonSolution(m);
+  for (std::size_t i = 0; i < m; ++i)
+    denseSkeletonRhs[i] = skeletonRhs[i];
+  denseSkeletonMatrix.solve(skeletonSolution, denseSkeletonRhs);
+
+  std::vector<double> y(n);
+  condensation.recoverSolution(skeletonSolution, y);
+  for (std::size_t i = 0; i < n; ++i)
+    test.check(std::abs(x[i] - y[i]) < 1e-9)
+      << "Condensed solution does not match the solution of the full system";
+
+  return test;
+}
+
+int main (int argc, char* argv[]) try
+{
+  Dune::MPIHelper::instance(argc, argv);
+
+  TestSuite test;
+
+  using namespace Functions::BasisFactory;
+
+  {
+    YaspGrid<2> grid({1.0, 1.0}, {3, 4});
+    auto basis = makeBasis(grid.leafGridView(), lagrange<3>());
+    test.subTest(checkStaticCondensation(basis, 1));
+    test.subTest(checkStaticCondensation(basis, 3));
+
+    // The first order basis has no interior DOFs
+    auto basis1 = makeBasis(grid.leafGridView(), lagrange<1>());
+    StaticCondensation condensation(basis1);
+    test.check(condensation.skeletonSize() == basis1.dimension() and condensation.interiorSize() == 0)
+      << "Interior DOFs found for the first order Lagrange basis";
+  }
+
+  {
+    using Grid = UGGrid<2>;
+    auto grid = StructuredGridFactory<Grid>::createSimplexGrid({0.0, 0.0}, {1.0, 1.0}, {2, 2});
+    auto basis = makeBasis(grid->leafGridView(), hierarchicalLagrange<4>());
+    test.subTest(checkStaticCondensation(basis, 2));
+  }
+
+  return test.exit();
+}
+catch (Exception &e)
+{
+  std::cerr << "Exception: " << e << std::endl;
+  return 1;
+}
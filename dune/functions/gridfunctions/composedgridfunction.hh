@@ -3,11 +3,18 @@
 #ifndef DUNE_FUNCTIONS_GRIDFUNCTIONS_COMPOSEDGRIDFUNCTION_HH
 #define DUNE_FUNCTIONS_GRIDFUNCTIONS_COMPOSEDGRIDFUNCTION_HH
 
+#include <array>
+#include <cstddef>
 #include <type_traits>
 #include <tuple>
+#include <utility>
+#include <vector>
 
+#include <dune/common/hybridutilities.hh>
+#include <dune/common/indices.hh>
 #include <dune/common/referencehelper.hh>
 #include <dune/common/typeutilities.hh>
+#include <dune/common/std/type_traits.hh>
 
 #include <dune/functions/common/defaultderivativetraits.hh>
 #include <dune/functions/common/differentiablefunction.hh>
@@ -34,6 +41,11 @@ namespace Functions {
  * Notice that all functions are captured by value.
  * To store references you can pass `std::ref()`.
  *
+ * If several inner functions are `DiscreteGlobalBasisFunction`s
+ * of the same basis object, their local-functions are fused:
+ * Only the first of them binds a local view and evaluates the
+ * shape functions, while the others reuse both.
+ *
  * \tparam OF Type of outer function. std::reference_wrapper is supported.
  * \tparam IF Types of inner outer functions. `std::reference_wrapper` is supported.
  */
@@ -46,6 +58,16 @@ class ComposedGridFunction
   template<std::size_t i>
   using InnerFunction = std::decay_t<ResolveRef_t<std::tuple_element_t<i, InnerFunctions>>>;
 
+  template<std::size_t i>
+  using InnerLocalFunction = std::tuple_element_t<i, InnerLocalFunctions>;
+
+  // Local-functions that can be bound to the local view of another local-function
+  // and evaluated using the shape function values computed by another local-function
+  template<class LF>
+  using FusableLocalFunctionDetector = decltype(
+    std::declval<LF&>().bindToLocalView(std::declval<const LF&>().localView()),
+    std::declval<const LF&>().evaluate(std::declval<const LF&>().shapeFunctionValues()));
+
   using OuterFunction = OF;
 
 public:
@@ -64,6 +86,29 @@ private:
 
   class LocalFunction
   {
+    static constexpr auto innerIndices = std::make_index_sequence<sizeof...(IF)>();
+
+    template<std::size_t i>
+    using InnerLocalRange = decltype(std::declval<const InnerLocalFunction<i>&>()(std::declval<LocalDomain>()));
+
+    template<std::size_t i>
+    static constexpr bool isFusable()
+    {
+      return Std::is_detected_v<FusableLocalFunctionDetector, InnerLocalFunction<i>>;
+    }
+
+    // Check if the inner local-functions i and j can share a local view
+    template<std::size_t i, std::size_t j>
+    static constexpr bool isFusable()
+    {
+      if constexpr (isFusable<i>() and isFusable<j>())
+        return std::is_same_v<
+          std::decay_t<decltype(std::declval<const InnerLocalFunction<i>&>().localView())>,
+          std::decay_t<decltype(std::declval<const InnerLocalFunction<j>&>().localView())>>;
+      else
+        return false;
+    }
+
   public:
     /**
      * \brief Construct the local-function.
@@ -74,7 +119,34 @@ private:
     LocalFunction(const ComposedGridFunction& globalFunction) :
       globalFunction_(globalFunction),
       innerLocalFunctions_(globalFunction.innerLocalFunctions())
-    {}
+    {
+      // Each fusable inner local-function is lead by the first
+      // inner local-function that has the same basis object.
+      Hybrid::forEach(innerIndices, [&](auto i) {
+        leader_[i] = i;
+        Hybrid::forEach(std::make_index_sequence<i>(), [&](auto j) {
+          if constexpr (isFusable<i,j>())
+            if ((leader_[i] == i) and (leader_[j] == j))
+              if (&std::get<i>(innerLocalFunctions_).localView().globalBasis() == &std::get<j>(innerLocalFunctions_).localView().globalBasis())
+                leader_[i] = j;
+        });
+      });
+    }
+
+    /**
+     * \brief Copy-construct the local-function.
+     *
+     * Fused inner local-functions of the copy refer to
+     * the local views of the copied inner local-functions.
+     **/
+    LocalFunction(const LocalFunction& other) :
+      globalFunction_(other.globalFunction_),
+      innerLocalFunctions_(other.innerLocalFunctions_),
+      leader_(other.leader_)
+    {
+      if (bound())
+        bindFollowers();
+    }
 
     /**
      * \brief Bind the inner local-functions to an `element`.
@@ -87,9 +159,11 @@ private:
      **/
     void bind(const Element& element)
     {
-      std::apply([&](auto&... innerFunction) {
-          (innerFunction.bind(element),...);
-      }, innerLocalFunctions_);
+      Hybrid::forEach(innerIndices, [&](auto i) {
+        if (not isFollower(i))
+          std::get<i>(innerLocalFunctions_).bind(element);
+      });
+      bindFollowers();
     }
 
     //! \brief Unbind the inner local-functions.
@@ -120,9 +194,32 @@ private:
      **/
     Range operator()(const LocalDomain& x) const
     {
-      return std::apply([&](const auto&... innerFunction) {
-          return globalFunction_.outerFunction_(innerFunction(x)...);
-      }, innerLocalFunctions_);
+      return unpackIntegerSequence([&](auto... i) {
+        // The braced initialization guarantees that the inner local-functions
+        // are evaluated in order. Hence the shape function values computed
+        // by a leading inner local-function in `x` are available when its
+        // followers are evaluated and can be reused by them.
+        auto innerValues = std::tuple<InnerLocalRange<i>...>{evaluateInner(i, x)...};
+        return std::apply(globalFunction_.outerFunction_, std::move(innerValues));
+      }, innerIndices);
+    }
+
+    /**
+     * \brief Evaluation of the composed local-function in several points.
+     *
+     * The values in the local coordinates `x[k]` are stored in `y[k]`.
+     * The shape function values shared by fused inner local-functions
+     * are evaluated only once per point.
+     *
+     * \b Expects:
+     * - All inner local-functions are bound to the same element.
+     **/
+    void evaluate(const std::vector<LocalDomain>& x, std::vector<Range>& y) const
+    {
+      y.clear();
+      y.reserve(x.size());
+      for (const auto& xk : x)
+        y.push_back((*this)(xk));
     }
 
     /**
@@ -146,8 +243,48 @@ private:
     }
 
   private:
+
+    template<std::size_t i>
+    bool isFollower(Dune::index_constant<i>) const
+    {
+      if constexpr (isFusable<i>())
+        return leader_[i] != i;
+      else
+        return false;
+    }
+
+    // Bind the fused inner local-functions to the local views of their leaders
+    void bindFollowers()
+    {
+      Hybrid::forEach(innerIndices, [&](auto i) {
+        if (isFollower(i))
+          Hybrid::forEach(std::make_index_sequence<i>(), [&](auto j) {
+            if constexpr (isFusable<i,j>())
+              if (leader_[i] == j)
+                std::get<i>(innerLocalFunctions_).bindToLocalView(std::get<j>(innerLocalFunctions_).localView());
+          });
+      });
+    }
+
+    template<std::size_t i>
+    InnerLocalRange<i> evaluateInner(Dune::index_constant<i> ii, const LocalDomain& x) const
+    {
+      const auto& innerFunction = std::get<i>(innerLocalFunctions_);
+      if (isFollower(ii))
+        return Hybrid::switchCases(std::make_index_sequence<i>(), leader_[i], [&](auto j) -> InnerLocalRange<i> {
+          if constexpr (isFusable<i,j>())
+            return innerFunction.evaluate(std::get<j>(innerLocalFunctions_).shapeFunctionValues());
+          else
+            return innerFunction(x);
+        }, [&]() -> InnerLocalRange<i> {
+          return innerFunction(x);
+        });
+      return innerFunction(x);
+    }
+
     const ComposedGridFunction& globalFunction_;
     InnerLocalFunctions innerLocalFunctions_;
+    std::array<std::size_t, sizeof...(IF)> leader_;
   };
 
 public:
@@ -3,13 +3,19 @@
 #ifndef DUNE_FUNCTIONS_GRIDFUNCTIONS_DISCRETEGLOBALBASISFUNCTIONS_HH
 #define DUNE_FUNCTIONS_GRIDFUNCTIONS_DISCRETEGLOBALBASISFUNCTIONS_HH
 
+#include <array>
+#include <cassert>
 #include <memory>
 #include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
 
 #include <dune/common/typetraits.hh>
 
 #include <dune/grid/utility/hierarchicsearch.hh>
 
+#include <dune/typetree/traversal.hh>
 #include <dune/typetree/treecontainer.hh>
 
 #include <dune/functions/functionspacebases/hierarchicnodetorangemap.hh>
@@ -36,6 +42,12 @@ public:
   // we have to use AutonomousValue<T> instead of std::decay_t<T>
   using Coefficient = Dune::AutonomousValue<decltype(std::declval<Vector>()[std::declval<typename Basis::MultiIndex>()])>;
 
+  // Coefficients can only be accessed via cached pointers
+  // if the vector backend hands out true references.
+  using CoefficientReference = decltype(std::declval<const Vector&>()[std::declval<typename Basis::MultiIndex>()]);
+  static constexpr bool hasDirectCoefficientAccess = std::is_lvalue_reference_v<CoefficientReference>
+    and std::is_same_v<std::decay_t<CoefficientReference>, Coefficient>;
+
   using GridView = typename Basis::GridView;
   using EntitySet = GridViewEntitySet<GridView, 0>;
   using Tree = typename Basis::LocalView::Tree;
@@ -48,6 +60,32 @@ public:
 
 protected:
 
+  // Table of pointers to the coefficients of the local DOFs of all
+  // elements. If this is filled by cacheCoefficientAccess(), bind()
+  // copies the local coefficients by a simple indexed load instead
+  // of resolving each multi-index in the vector backend.
+  struct CoefficientAccessCache
+  {
+    // Check if the table was filled for the given coefficient vector.
+    // If the vector was reallocated, the address of a probed entry has
+    // changed and the table must not be used anymore. For blocked layouts
+    // the leaf nodes may be stored in different sub-vectors which can be
+    // reallocated independently. Hence there is one probe per leaf node.
+    bool validFor(const Vector& dofs) const
+    {
+      if (probes.empty())
+        return false;
+      for (const auto& [index, pointer] : probes)
+        if (&dofs[index] != pointer)
+          return false;
+      return true;
+    }
+
+    std::vector<std::size_t> elementOffsets;
+    std::vector<const Coefficient*> pointers;
+    std::vector<std::pair<typename Basis::MultiIndex, const Coefficient*>> probes;
+  };
+
   // This collects all data that is shared by all related
   // global and local functions. This way we don't need to
   // keep track of it individually.
@@ -57,22 +95,29 @@ protected:
     std::shared_ptr<const Basis> basis;
     std::shared_ptr<const Vector> coefficients;
     std::shared_ptr<const NodeToRangeEntry> nodeToRangeEntry;
+    std::shared_ptr<CoefficientAccessCache> coefficientAccessCache = std::make_shared<CoefficientAccessCache>();
   };
 
 public:
   class LocalFunctionBase
   {
-    using LocalView = typename Basis::LocalView;
     using size_type = typename Tree::size_type;
 
+  protected:
+
+    // Number of scalar entries of a single coefficient
+    static constexpr std::size_t coeffDim = decltype(flatVectorView(std::declval<const Coefficient&>()).size())::value;
+
   public:
     using Domain = LocalDomain;
     using Element = typename EntitySet::Element;
+    using LocalView = typename Basis::LocalView;
 
   protected:
     LocalFunctionBase(const std::shared_ptr<const Data>& data)
       : data_(data)
       , localView_(data_->basis->localView())
+      , sharedLocalView_(nullptr)
     {
       localDoFs_.reserve(localView_.maxSize());
     }
@@ -82,14 +127,19 @@ public:
      *
      * This copy-constructor copies the cached local DOFs only
      * if the `other` local-function is bound to an element.
+     * The copy always uses its own local view, even if `other`
+     * was bound using `bindToLocalView()`.
      **/
     LocalFunctionBase(const LocalFunctionBase& other)
       : data_(other.data_)
-      , localView_(other.localView_)
+      , localView_(other.localView())
+      , sharedLocalView_(nullptr)
     {
       localDoFs_.reserve(localView_.maxSize());
       if (bound())
+      {
         localDoFs_ = other.localDoFs_;
+      }
     }
 
     /**
@@ -97,14 +147,18 @@ public:
      *
      * Assign all members from `other` to `this`, except the
      * local DOFs. Those are copied only if the `other`
-     * local-function is bound to an element.
+     * local-function is bound to an element. Like the
+     * copy-constructor, this always uses an own local view.
      **/
     LocalFunctionBase& operator=(const LocalFunctionBase& other)
     {
       data_ = other.data_;
-      localView_ = other.localView_;
+      localView_ = other.localView();
+      sharedLocalView_ = nullptr;
       if (bound())
+      {
         localDoFs_ = other.localDoFs_;
+      }
       return *this;
     }
 
@@ -117,7 +171,60 @@ public:
      */
     void bind(const Element& element)
     {
+      sharedLocalView_ = nullptr;
       localView_.bind(element);
+      updateLocalDoFs();
+    }
+
+    /**
+     * \brief Bind LocalFunction to the element a given local view is bound to.
+     *
+     * Instead of binding its own local view, the local-function refers
+     * to the given bound local view of the same basis, e.g., the one
+     * of another local-function. This avoids binding the same local
+     * view several times. The given local view must stay alive and
+     * bound to the same element until this local-function is bound
+     * again or unbound.
+     */
+    void bindToLocalView(const LocalView& localView)
+    {
+      assert(&localView.globalBasis() == data_->basis.get());
+      localView_.unbind();
+      sharedLocalView_ = &localView;
+      updateLocalDoFs();
+    }
+
+    //! Unbind the local-function.
+    void unbind()
+    {
+      localView_.unbind();
+      sharedLocalView_ = nullptr;
+    }
+
+    //! Check if LocalFunction is already bound to an element.
+    bool bound() const
+    {
+      return localView().bound();
+    }
+
+    //! Return the element the local-function is bound to.
+    const Element& localContext() const
+    {
+      return localView().element();
+    }
+
+    //! Return the local view the local-function is bound with.
+    const LocalView& localView() const
+    {
+      return sharedLocalView_ ? *sharedLocalView_ : localView_;
+    }
+
+  protected:
+
+    // Copy the coefficients of the bound element to the local caches
+    void updateLocalDoFs()
+    {
+      const auto& localView = this->localView();
       // Use cache of full local view size. For a subspace basis,
       // this may be larger than the number of local DOFs in the
       // tree. In this case only cache entries associated to local
@@ -129,38 +236,65 @@ public:
       // the size of the tree. However, this would require to
       // subtract an offset from localIndex(i) on each cache
       // access in operator().
-      localDoFs_.resize(localView_.size());
+      localDoFs_.resize(localView.size());
+      gatherLocalDoFs(localView);
+    }
+
+    // Copy the coefficients of all local DOFs in the tree to localDoFs_
+    void gatherLocalDoFs(const LocalView& localView)
+    {
       const auto& dofs = *data_->coefficients;
-      for (size_type i = 0; i < localView_.tree().size(); ++i)
+      if constexpr (hasDirectCoefficientAccess)
+      {
+        const auto& cache = *data_->coefficientAccessCache;
+        if (cache.validFor(dofs))
+        {
+          auto elementIndex = data_->basis->gridView().indexSet().index(localView.element());
+          const auto* pointers = cache.pointers.data() + cache.elementOffsets[elementIndex];
+          for (size_type i = 0; i < localView.tree().size(); ++i)
+            localDoFs_[localView.tree().localIndex(i)] = *pointers[i];
+          return;
+        }
+      }
+      for (size_type i = 0; i < localView.tree().size(); ++i)
       {
         // For a subspace basis the index-within-tree i
         // is not the same as the localIndex within the
         // full local view.
-        size_t localIndex = localView_.tree().localIndex(i);
-        localDoFs_[localIndex] = dofs[localView_.index(localIndex)];
+        size_t localIndex = localView.tree().localIndex(i);
+        localDoFs_[localIndex] = dofs[localView.index(localIndex)];
       }
     }
 
-    //! Unbind the local-function.
-    void unbind()
-    {
-      localView_.unbind();
-    }
-
-    //! Check if LocalFunction is already bound to an element.
-    bool bound() const
+    /**
+     * \brief Compute linear combinations of shape function values of a leaf node
+     *
+     * Non-scalar coefficients of dimension coeffDim are handled by
+     * processing the coeffDim linear combinations independently
+     * and storing them as entries of the array `values`.
+     *
+     * The linear combinations are accumulated in a single pass over the
+     * shape function values (or Jacobians).
+     */
+    template<class Node, class ShapeValue, class Value, std::size_t n>
+    void linearCombination(const Node& node, const std::vector<ShapeValue>& shapeValues, std::array<Value, n>& values) const
     {
-      return localView_.bound();
-    }
+      static_assert(n == coeffDim);
+      istlVectorBackend(values) = 0;
 
-    //! Return the element the local-function is bound to.
-    const Element& localContext() const
-    {
-      return localView_.element();
+      for (size_type i = 0; i < node.size(); ++i)
+      {
+        auto c = flatVectorView(localDoFs_[node.localIndex(i)]);
+        auto shapeValue = flatVectorView(shapeValues[i]);
+        for (std::size_t j = 0; j < coeffDim; ++j)
+        {
+          auto value = flatVectorView(values[j]);
+          for (std::size_t r = 0; r < value.size(); ++r)
+            value[r] += c[j] * shapeValue[r];
+        }
+      }
     }
 
-  protected:
-
     template<class To, class From>
     void assignWith(To& to, const From& from) const
     {
@@ -179,6 +313,7 @@ public:
 
     std::shared_ptr<const Data> data_;
     LocalView localView_;
+    const LocalView* sharedLocalView_;
     std::vector<Coefficient> localDoFs_;
   };
 
@@ -215,6 +350,58 @@ public:
     return data_->entitySet;
   }
 
+  /**
+   * \brief Precompute direct access to the local coefficients of all elements.
+   *
+   * This resolves the global multi-indices of all local DOFs once and
+   * stores pointers to the corresponding coefficients per element.
+   * Afterwards `bind()` of all local-functions associated with this
+   * function (including its derivative) copies the local coefficients
+   * by an indexed load instead of resolving the multi-indices in the
+   * vector backend. This pays off if the local-functions are bound to each
+   * element several times, e.g. in nonlinear or time-stepping loops, in
+   * particular for blocked index layouts.
+   *
+   * The cache is bypassed automatically if the coefficient vector is reallocated.
+   * It must be recomputed if the basis was updated while the vector kept its
+   * storage. It is not used at all if the vector backend does not provide
+   * references to the coefficients. This must not be called concurrently
+   * with `bind()`.
+   */
+  void cacheCoefficientAccess()
+  {
+    if constexpr (hasDirectCoefficientAccess)
+    {
+      auto& cache = *data_->coefficientAccessCache;
+      const auto& dofs = *data_->coefficients;
+      const auto& gridView = data_->basis->gridView();
+      const auto& indexSet = gridView.indexSet();
+      auto localView = data_->basis->localView();
+
+      cache.pointers.clear();
+      cache.pointers.reserve(localView.maxSize() * gridView.size(0));
+      cache.elementOffsets.assign(gridView.size(0), 0);
+      cache.probes.clear();
+      for (const auto& element : elements(gridView))
+      {
+        localView.bind(element);
+        if (cache.pointers.empty())
+        {
+          TypeTree::forEachLeafNode(localView.tree(), [&](auto&& node, auto&& /*treePath*/) {
+            if (node.size() > 0)
+            {
+              const auto& index = localView.index(node.localIndex(0));
+              cache.probes.emplace_back(index, &dofs[index]);
+            }
+          });
+        }
+        cache.elementOffsets[indexSet.index(element)] = cache.pointers.size();
+        for (std::size_t i = 0; i < localView.tree().size(); ++i)
+          cache.pointers.push_back(&dofs[localView.index(localView.tree().localIndex(i))]);
+      }
+    }
+  }
+
 protected:
   std::shared_ptr<const Data> data_;
 };
@@ -328,31 +515,57 @@ public:
      * usable.
      */
     Range operator()(const Domain& x) const
+    {
+      return evaluate(shapeFunctionValues(x));
+    }
+
+    /**
+     * \brief Evaluate the shape functions of all leaf nodes in coordinates `x`.
+     *
+     * The values are stored in a container indexed by the tree paths of
+     * the leaf nodes. The returned reference stays valid until the
+     * shape functions are evaluated again.
+     */
+    const PerNodeEvaluationBuffer& shapeFunctionValues(const Domain& x) const
+    {
+      TypeTree::forEachLeafNode(this->localView().tree(), [&](auto&& node, auto&& treePath) {
+        node.finiteElement().localBasis().evaluateFunction(x, evaluationBuffer_[treePath]);
+      });
+      return evaluationBuffer_;
+    }
+
+    /**
+     * \brief Return the shape function values of the last evaluation.
+     *
+     * These are the values computed by the last call of `operator()`
+     * or `shapeFunctionValues(x)`.
+     */
+    const PerNodeEvaluationBuffer& shapeFunctionValues() const
+    {
+      return evaluationBuffer_;
+    }
+
+    /**
+     * \brief Evaluate this local-function for given shape function values.
+     *
+     * The shape function values must be computed by `shapeFunctionValues()`
+     * of a local-function for the same basis bound to the same element.
+     * This allows to share the evaluation of the shape functions among
+     * several functions with the same basis.
+     */
+    template<class ShapeFunctionValues>
+    Range evaluate(const ShapeFunctionValues& shapeFunctionValues) const
     {
       Range y;
       istlVectorBackend(y) = 0;
 
-      TypeTree::forEachLeafNode(this->localView_.tree(), [&](auto&& node, auto&& treePath) {
-        const auto& fe = node.finiteElement();
-        const auto& localBasis = fe.localBasis();
-        auto& shapeFunctionValues = evaluationBuffer_[treePath];
-
-        localBasis.evaluateFunction(x, shapeFunctionValues);
+      TypeTree::forEachLeafNode(this->localView().tree(), [&](auto&& node, auto&& treePath) {
+        const auto& nodeShapeFunctionValues = shapeFunctionValues[treePath];
 
-        // Compute linear combinations of basis function jacobian.
-        // Non-scalar coefficients of dimension coeffDim are handled by
-        // processing the coeffDim linear combinations independently
-        // and storing them as entries of an array.
+        // Compute linear combinations of basis function values.
         using Value = LocalBasisRange< std::decay_t<decltype(node)> >;
-        static constexpr auto coeffDim = decltype(flatVectorView(this->localDoFs_[node.localIndex(0)]).size())::value;
-        auto values = std::array<Value, coeffDim>{};
-        istlVectorBackend(values) = 0;
-        for (size_type i = 0; i < localBasis.size(); ++i)
-        {
-          auto c = flatVectorView(this->localDoFs_[node.localIndex(i)]);
-          for (std::size_t j = 0; j < coeffDim; ++j)
-            values[j].axpy(c[j], shapeFunctionValues[i]);
-        }
+        auto values = std::array<Value, LocalBase::coeffDim>{};
+        LocalBase::linearCombination(node, nodeShapeFunctionValues, values);
 
         // Assign computed values to node entry of range.
         // Types are matched using the lexicographic ordering provided by flatVectorView.
@@ -362,13 +575,18 @@ public:
       return y;
     }
 
-    //! Local function of the derivative
+    /**
+     * \brief Local function of the derivative
+     *
+     * If `lf` is bound, the derivative is a copy of its local view
+     * and its local coefficients. Hence it is bound to the same element
+     * without gathering the coefficients again, and it is independent
+     * of `lf` afterwards.
+     */
     friend typename DiscreteGlobalBasisFunctionDerivative<DiscreteGlobalBasisFunction>::LocalFunction derivative(const LocalFunction& lf)
     {
-      auto dlf = localFunction(DiscreteGlobalBasisFunctionDerivative<DiscreteGlobalBasisFunction>(lf.data_));
-      if (lf.bound())
-        dlf.bind(lf.localContext());
-      return dlf;
+      using DerivativeLocalFunction = typename DiscreteGlobalBasisFunctionDerivative<DiscreteGlobalBasisFunction>::LocalFunction;
+      return DerivativeLocalFunction(static_cast<const LocalBase&>(lf));
     }
 
   private:
@@ -540,6 +758,21 @@ public:
       /* Nothing. */
     }
 
+    /**
+     * \brief Create a local function from a local-function of the differentiated function
+     *
+     * The created local function copies the local view and the local
+     * coefficients of `other`. If `other` is bound to an element,
+     * so is the created local function.
+     */
+    explicit LocalFunction(const LocalBase& other)
+      : LocalBase(other)
+      , evaluationBuffer_(this->localView().tree())
+    {
+      if (this->bound())
+        geometry_.emplace(this->localContext().geometry());
+    }
+
     /**
      * \brief Bind LocalFunction to grid element.
      *
@@ -552,6 +785,17 @@ public:
       geometry_.emplace(element.geometry());
     }
 
+    /**
+     * \brief Bind LocalFunction to the element a given local view is bound to.
+     *
+     * \copydetails LocalFunctionBase::bindToLocalView
+     */
+    void bindToLocalView(const typename LocalBase::LocalView& localView)
+    {
+      LocalBase::bindToLocalView(localView);
+      geometry_.emplace(localView.element().geometry());
+    }
+
     //! Unbind the local-function.
     void unbind()
     {
@@ -579,7 +823,7 @@ public:
 
       const auto& jacobianInverse = geometry_->jacobianInverse(x);
 
-      TypeTree::forEachLeafNode(this->localView_.tree(), [&](auto&& node, auto&& treePath) {
+      TypeTree::forEachLeafNode(this->localView().tree(), [&](auto&& node, auto&& treePath) {
         const auto& fe = node.finiteElement();
         const auto& localBasis = fe.localBasis();
         auto& shapeFunctionJacobians = evaluationBuffer_[treePath];
@@ -587,23 +831,13 @@ public:
         localBasis.evaluateJacobian(x, shapeFunctionJacobians);
 
         // Compute linear combinations of basis function jacobian.
-        // Non-scalar coefficients of dimension coeffDim are handled by
-        // processing the coeffDim linear combinations independently
-        // and storing them as entries of an array.
         using RefJacobian = LocalBasisRange< std::decay_t<decltype(node)> >;
-        static constexpr auto coeffDim = decltype(flatVectorView(this->localDoFs_[node.localIndex(0)]).size())::value;
-        auto refJacobians = std::array<RefJacobian, coeffDim>{};
-        istlVectorBackend(refJacobians) = 0;
-        for (size_type i = 0; i < localBasis.size(); ++i)
-        {
-          auto c = flatVectorView(this->localDoFs_[node.localIndex(i)]);
-          for (std::size_t j = 0; j < coeffDim; ++j)
-            refJacobians[j].axpy(c[j], shapeFunctionJacobians[i]);
-        }
+        auto refJacobians = std::array<RefJacobian, LocalBase::coeffDim>{};
+        LocalBase::linearCombination(node, shapeFunctionJacobians, refJacobians);
 
         // Transform Jacobians form local to global coordinates.
         using Jacobian = decltype(refJacobians[0] * jacobianInverse);
-        auto jacobians = std::array<Jacobian, coeffDim>{};
+        auto jacobians = std::array<Jacobian, LocalBase::coeffDim>{};
         std::transform(
           refJacobians.begin(), refJacobians.end(), jacobians.begin(),
           [&](const auto& refJacobian) { return refJacobian * jacobianInverse; });
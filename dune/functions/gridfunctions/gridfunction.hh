@@ -4,6 +4,7 @@
 #define DUNE_FUNCTIONS_GRIDFUNCTIONS_GRID_FUNCTION_HH
 
 #include <type_traits>
+#include <vector>
 
 #include <dune/common/typeutilities.hh>
 
@@ -96,11 +97,12 @@ template<class Range, class Domain, class ES, template<class> class DerivativeTr
 class GridFunction<Range(Domain), ES, DerivativeTraits, bufferSize> :
   public TypeErasureBase<
     typename Imp::GridFunctionTraits<Range(Domain), ES, DerivativeTraits, bufferSize>::Concept,
-    Imp::GridFunctionTraits<Range(Domain), ES, DerivativeTraits, bufferSize>::template Model>
+    Imp::GridFunctionTraits<Range(Domain), ES, DerivativeTraits, bufferSize>::template Model,
+    bufferSize>
 {
   using Traits = Imp::GridFunctionTraits<Range(Domain), ES, DerivativeTraits, bufferSize>;
 
-  using Base = TypeErasureBase<typename Traits::Concept, Traits::template Model>;
+  using Base = TypeErasureBase<typename Traits::Concept, Traits::template Model, bufferSize>;
 
   using DerivativeInterface = typename Traits::DerivativeInterface;
 
@@ -140,6 +142,18 @@ public:
     return this->asInterface().operator()(x);
   }
 
+  /**
+   * \brief Evaluation of wrapped function in several points.
+   *
+   * The values in the global coordinates `x[k]` are stored in `y[k]`.
+   * In contrast to the evaluation in single points this
+   * only needs a single virtual function call.
+   */
+  void evaluate(const std::vector<std::decay_t<Domain>>& x, std::vector<std::decay_t<Range>>& y) const
+  {
+    this->asInterface().evaluate(x, y);
+  }
+
   /**
    * \brief Get derivative of wrapped function.
    *
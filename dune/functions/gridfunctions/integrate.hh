@@ -0,0 +1,251 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_GRIDFUNCTIONS_INTEGRATE_HH
+#define DUNE_FUNCTIONS_GRIDFUNCTIONS_INTEGRATE_HH
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <dune/geometry/quadraturerules.hh>
+
+#include <dune/grid/common/partitionset.hh>
+#include <dune/grid/common/rangegenerators.hh>
+
+#include <dune/functions/backends/istlvectorbackend.hh>
+#include <dune/functions/common/parallelfor.hh>
+#include <dune/functions/functionspacebases/flatvectorview.hh>
+
+namespace Dune {
+namespace Functions {
+
+
+
+namespace Impl {
+
+  // Sum the entries in [begin,end) by recursive bisection. In contrast to
+  // a plain loop the rounding error only grows logarithmically with the
+  // number of summands, and the result does not depend on how the
+  // summands have been computed.
+  template<class T>
+  T pairwiseSum(const std::vector<T>& values, std::size_t begin, std::size_t end)
+  {
+    assert(begin < end);
+    if (end - begin <= 8)
+    {
+      T sum = values[begin];
+      for (std::size_t i = begin+1; i < end; ++i)
+        sum += values[i];
+      return sum;
+    }
+    std::size_t middle = begin + (end - begin)/2;
+    T sum = pairwiseSum(values, begin, middle);
+    sum += pairwiseSum(values, middle, end);
+    return sum;
+  }
+
+  // Sum up the contributions of all interior elements of the grid view.
+  //
+  // The callback makeElementIntegrator() is called once per thread and must return
+  // a callable computing the contribution of a single element. The contributions are
+  // stored per element and summed pairwise afterwards. Hence the result is independent
+  // of the number of threads.
+  template<class T, class GridView, class MakeElementIntegrator>
+  T sumElementContributions(const GridView& gridView, const T& zero, MakeElementIntegrator&& makeElementIntegrator, std::size_t threads)
+  {
+    using Element = typename GridView::template Codim<0>::Entity;
+
+    std::vector<Element> elementList;
+    elementList.reserve(gridView.size(0));
+    for (const auto& element : elements(gridView, Dune::Partitions::interior))
+      elementList.push_back(element);
+
+    std::vector<T> contributions(elementList.size(), zero);
+
+    Impl::parallelForRanges(elementList.size(), threads, [&](std::size_t begin, std::size_t end) {
+      auto elementIntegrator = makeElementIntegrator();
+      for (std::size_t i = begin; i < end; ++i)
+        contributions[i] = elementIntegrator(elementList[i]);
+    });
+
+    if (contributions.empty())
+      return zero;
+    return pairwiseSum(contributions, 0, contributions.size());
+  }
+
+  // Compute the squared euclidean distance of two values by
+  // comparing their entries in the ordering of flatVectorView.
+  template<class Field, class A, class B>
+  Field squaredDistance(const A& a, const B& b)
+  {
+    auto aFlat = flatVectorView(a);
+    auto bFlat = flatVectorView(b);
+    assert(aFlat.size() == bFlat.size());
+    Field result = 0;
+    for (std::size_t k = 0; k < aFlat.size(); ++k)
+    {
+      auto diff = aFlat[k] - bFlat[k];
+      result += diff*diff;
+    }
+    return result;
+  }
+
+  // Compute the integral of the squared distance of two local-functions over an element
+  template<class Field, class Element, class LocalF, class LocalG>
+  Field squaredErrorOnElement(const Element& element, unsigned int order, LocalF& localF, LocalG& localG)
+  {
+    using Geometry = typename Element::Geometry;
+    const auto& geometry = element.geometry();
+    const auto& quadRule = QuadratureRules<typename Geometry::ctype, Geometry::mydimension>::rule(element.type(), order);
+
+    localF.bind(element);
+    localG.bind(element);
+    Field result = 0;
+    for (const auto& quadPoint : quadRule)
+    {
+      const auto& x = quadPoint.position();
+      result += squaredDistance<Field>(localF(x), localG(x)) * quadPoint.weight() * geometry.integrationElement(x);
+    }
+    localF.unbind();
+    localG.unbind();
+    return result;
+  }
+
+} // end namespace Impl
+
+
+
+/**
+ * \brief Compute the integral of a grid function
+ *
+ * \ingroup FunctionUtility
+ *
+ * The integral is computed using the quadrature rules of
+ * the given order on each interior element of the grid view
+ * the function is defined on. This works for all grid functions
+ * providing a local-function, e.g. `DiscreteGlobalBasisFunction`,
+ * `ComposedGridFunction`, or `AnalyticGridViewFunction`.
+ *
+ * The elements can be processed by several threads. Each thread
+ * uses its own copy of the local-function, hence evaluating the
+ * local-functions of `f` concurrently must be safe.
+ * The element contributions are summed pairwise, such that
+ * the result does not depend on the number of threads.
+ *
+ * \note For distributed grids only the local interior elements
+ *   are considered. The results of all processes have to be
+ *   summed up by the caller.
+ *
+ * \param f A grid function
+ * \param order Order of the quadrature rule
+ * \param threads Number of threads used for the element loop
+ * \returns The integral of f
+ */
+template<class F>
+auto integrate(const F& f, unsigned int order, std::size_t threads = 1)
+{
+  const auto& gridView = f.entitySet().gridView();
+  using GridView = std::decay_t<decltype(gridView)>;
+  using Element = typename GridView::template Codim<0>::Entity;
+  using Geometry = typename Element::Geometry;
+  using LocalDomain = typename Geometry::LocalCoordinate;
+  using LocalFunction = std::decay_t<decltype(localFunction(f))>;
+  using Range = std::decay_t<decltype(std::declval<LocalFunction&>()(std::declval<LocalDomain>()))>;
+
+  Range zero;
+  istlVectorBackend(zero) = 0;
+
+  return Impl::sumElementContributions(gridView, zero, [&]() {
+    return [&, localF = localFunction(f)](const Element& element) mutable {
+      const auto& geometry = element.geometry();
+      const auto& quadRule = QuadratureRules<typename Geometry::ctype, Geometry::mydimension>::rule(element.type(), order);
+
+      localF.bind(element);
+      Range integral = zero;
+      for (const auto& quadPoint : quadRule)
+      {
+        const auto& x = quadPoint.position();
+        integral += localF(x) * (quadPoint.weight() * geometry.integrationElement(x));
+      }
+      localF.unbind();
+      return integral;
+    };
+  }, threads);
+}
+
+
+
+//! Norms supported by errorNorm()
+enum class NormType
+{
+  L2,       //!< The L2 norm
+  H1Semi,   //!< The H1 seminorm, i.e., the L2 norm of the derivative
+  H1        //!< The full H1 norm
+};
+
+
+
+/**
+ * \brief Compute the norm of the difference of two grid functions
+ *
+ * \ingroup FunctionUtility
+ *
+ * The values of `f` and `g` are compared entry by entry in the
+ * ordering provided by `flatVectorView()`. Hence both ranges
+ * must have the same number of scalar entries. For the `H1Semi`
+ * and `H1` norms both functions must implement `derivative()`.
+ * This is e.g. not the case for `ComposedGridFunction`.
+ *
+ * The integrals are computed as in integrate(), i.e.,
+ * using a quadrature rule of the given order, a parallel element
+ * loop with the given number of threads, and a pairwise summation
+ * of the element contributions.
+ *
+ * \param f A grid function
+ * \param g A grid function defined on the same grid view as f
+ * \param normType The norm to compute
+ * \param order Order of the quadrature rule
+ * \param threads Number of threads used for the element loop
+ * \returns The norm of f-g
+ */
+template<class F, class G>
+auto errorNorm(const F& f, const G& g, NormType normType, unsigned int order, std::size_t threads = 1)
+{
+  const auto& gridView = f.entitySet().gridView();
+  using GridView = std::decay_t<decltype(gridView)>;
+  using Element = typename GridView::template Codim<0>::Entity;
+  using Field = typename GridView::ctype;
+
+  Field squaredError = 0;
+
+  if (normType != NormType::H1Semi)
+    squaredError += Impl::sumElementContributions(gridView, Field(0), [&]() {
+      return [&, localF = localFunction(f), localG = localFunction(g)](const Element& element) mutable {
+        return Impl::squaredErrorOnElement<Field>(element, order, localF, localG);
+      };
+    }, threads);
+
+  if (normType != NormType::L2)
+  {
+    auto df = derivative(f);
+    auto dg = derivative(g);
+    squaredError += Impl::sumElementContributions(gridView, Field(0), [&]() {
+      return [&, localDF = localFunction(df), localDG = localFunction(dg)](const Element& element) mutable {
+        return Impl::squaredErrorOnElement<Field>(element, order, localDF, localDG);
+      };
+    }, threads);
+  }
+
+  using std::sqrt;
+  return sqrt(squaredError);
+}
+
+
+
+} // namespace Functions
+} // namespace Dune
+
+#endif // DUNE_FUNCTIONS_GRIDFUNCTIONS_INTEGRATE_HH
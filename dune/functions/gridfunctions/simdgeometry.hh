@@ -0,0 +1,300 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_GRIDFUNCTIONS_SIMDGEOMETRY_HH
+#define DUNE_FUNCTIONS_GRIDFUNCTIONS_SIMDGEOMETRY_HH
+
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/simd/loop.hh>
+#include <dune/common/simd/simd.hh>
+
+#include <dune/geometry/referenceelements.hh>
+#include <dune/geometry/type.hh>
+
+namespace Dune {
+namespace Functions {
+
+
+
+/**
+ * \brief Geometries of several elements of the same geometry type evaluated in lockstep
+ *
+ * \ingroup FunctionImplementations
+ *
+ * This stores the corners of up to `W` elements in SIMD types of type
+ * `Dune::LoopSIMD` with `W` lanes. The geometry mappings, their Jacobians,
+ * and the (pseudo-)inverses of the Jacobians are evaluated for all lanes at
+ * once with SIMD arithmetic.
+ *
+ * The mapping is the multilinear interpolation of the corners, as for
+ * `Dune::MultiLinearGeometry`. Only simplices and cubes are supported.
+ * For grids with non-multilinear geometries the result differs from the
+ * geometries of the elements.
+ *
+ * Lanes which are not bound to an element are masked by binding them to the
+ * reference element. Hence their Jacobians are invertible, but their values
+ * are meaningless.
+ *
+ * \tparam ct Coordinate type of a single lane
+ * \tparam mydim Dimension of the elements
+ * \tparam cdim Dimension of the world coordinates
+ * \tparam W Number of lanes, i.e., maximal number of bound elements
+ */
+template<class ct, int mydim, int cdim, std::size_t W>
+class SimdGeometry
+{
+  static_assert((1 <= mydim) and (mydim <= 3), "SimdGeometry is only implemented for 1 <= mydim <= 3");
+  static_assert(mydim <= cdim, "SimdGeometry requires mydim <= cdim");
+
+  using size_type = std::size_t;
+
+public:
+
+  //! SIMD type storing one coordinate for all lanes
+  using LaneCoordinate = Dune::LoopSIMD<ct, W>;
+
+  //! Local coordinate shared by all lanes
+  using LocalCoordinate = FieldVector<ct, mydim>;
+
+  //! Global coordinates of all lanes
+  using GlobalCoordinate = std::array<LaneCoordinate, cdim>;
+
+  //! Transposed Jacobians of all lanes, i.e. `jacobianTransposed[i][k]` is the derivative of the k-th coordinate in direction i
+  using JacobianTransposed = std::array<std::array<LaneCoordinate, cdim>, mydim>;
+
+  //! (Pseudo-)inverses of the Jacobians of all lanes
+  using JacobianInverse = std::array<std::array<LaneCoordinate, cdim>, mydim>;
+
+  //! Create an unbound geometry
+  SimdGeometry() :
+    boundLanes_(0)
+  {}
+
+  /**
+   * \brief Bind to the geometries of a set of grid elements.
+   *
+   * \param elements A random access range of at most `W` elements of the same geometry type
+   *
+   * \throws Dune::NotImplemented if the elements are neither simplices nor cubes
+   */
+  template<class Elements>
+  void bind(const Elements& elements)
+  {
+    assert((elements.size() > 0) and (elements.size() <= W));
+    type_ = elements[0].type();
+    if (not (type_.isSimplex() or type_.isCube()))
+      DUNE_THROW(Dune::NotImplemented, "SimdGeometry is only implemented for simplices and cubes");
+
+    const auto& refElement = Dune::referenceElement<ct, mydim>(type_);
+    corners_.resize(refElement.size(mydim));
+    boundLanes_ = elements.size();
+    for (size_type lane = 0; lane < W; ++lane)
+    {
+      for (size_type c = 0; c < corners_.size(); ++c)
+      {
+        // Unbound lanes are masked by the identity mapping of the reference element
+        auto corner = FieldVector<ct, cdim>(0);
+        if (lane < boundLanes_)
+          corner = elements[lane].geometry().corner(c);
+        else
+          for (int k = 0; k < mydim; ++k)
+            corner[k] = refElement.position(c, mydim)[k];
+        for (int k = 0; k < cdim; ++k)
+          Simd::lane(lane, corners_[c][k]) = corner[k];
+      }
+    }
+  }
+
+  //! Return the number of lanes bound to an element
+  size_type boundLanes() const
+  {
+    return boundLanes_;
+  }
+
+  //! Return the geometry type of the bound elements
+  const GeometryType& type() const
+  {
+    return type_;
+  }
+
+  //! Evaluate the mappings of all lanes in local coordinates `x`
+  GlobalCoordinate global(const LocalCoordinate& x) const
+  {
+    GlobalCoordinate y;
+    y.fill(LaneCoordinate(ct(0)));
+    for (size_type c = 0; c < corners_.size(); ++c)
+    {
+      const auto value = cornerValue(c, x);
+      for (int k = 0; k < cdim; ++k)
+        y[k] += corners_[c][k] * value;
+    }
+    return y;
+  }
+
+  //! Evaluate the transposed Jacobians of all lanes in local coordinates `x`
+  JacobianTransposed jacobianTransposed(const LocalCoordinate& x) const
+  {
+    JacobianTransposed jacobianTransposed;
+    for (auto& row : jacobianTransposed)
+      row.fill(LaneCoordinate(ct(0)));
+    for (size_type c = 0; c < corners_.size(); ++c)
+    {
+      const auto gradient = cornerGradient(c, x);
+      for (int i = 0; i < mydim; ++i)
+        for (int k = 0; k < cdim; ++k)
+          jacobianTransposed[i][k] += corners_[c][k] * gradient[i];
+    }
+    return jacobianTransposed;
+  }
+
+  /**
+   * \brief Evaluate the (pseudo-)inverses of the Jacobians of all lanes in local coordinates `x`
+   *
+   * For `mydim < cdim` this is the Moore-Penrose pseudo-inverse
+   * \f$ (J^T J)^{-1} J^T \f$, as for the geometries of the grid.
+   */
+  JacobianInverse jacobianInverse(const LocalCoordinate& x) const
+  {
+    const auto jT = jacobianTransposed(x);
+    LaneCoordinate det;
+    const auto gramInverse = inverse(gram(jT), det);
+
+    JacobianInverse jacobianInverse;
+    for (int i = 0; i < mydim; ++i)
+      for (int k = 0; k < cdim; ++k)
+      {
+        jacobianInverse[i][k] = LaneCoordinate(ct(0));
+        for (int j = 0; j < mydim; ++j)
+          jacobianInverse[i][k] += gramInverse[i][j] * jT[j][k];
+      }
+    return jacobianInverse;
+  }
+
+  //! Evaluate the integration elements of all lanes in local coordinates `x`
+  LaneCoordinate integrationElement(const LocalCoordinate& x) const
+  {
+    const auto g = gram(jacobianTransposed(x));
+    LaneCoordinate result = determinant(g);
+    for (size_type lane = 0; lane < W; ++lane)
+      Simd::lane(lane, result) = std::sqrt(Simd::lane(lane, result));
+    return result;
+  }
+
+private:
+
+  using SquareMatrix = std::array<std::array<LaneCoordinate, mydim>, mydim>;
+
+  // Value of the multilinear shape function of corner c
+  ct cornerValue(size_type c, const LocalCoordinate& x) const
+  {
+    if (type_.isSimplex())
+    {
+      if (c == 0)
+      {
+        ct value = 1;
+        for (int i = 0; i < mydim; ++i)
+          value -= x[i];
+        return value;
+      }
+      return x[c-1];
+    }
+    ct value = 1;
+    for (int i = 0; i < mydim; ++i)
+      value *= ((c >> i) & 1) ? x[i] : 1 - x[i];
+    return value;
+  }
+
+  // Gradient of the multilinear shape function of corner c
+  FieldVector<ct, mydim> cornerGradient(size_type c, const LocalCoordinate& x) const
+  {
+    auto gradient = FieldVector<ct, mydim>(0);
+    if (type_.isSimplex())
+    {
+      if (c == 0)
+        gradient = -1;
+      else
+        gradient[c-1] = 1;
+      return gradient;
+    }
+    for (int i = 0; i < mydim; ++i)
+    {
+      gradient[i] = ((c >> i) & 1) ? 1 : -1;
+      for (int j = 0; j < mydim; ++j)
+        if (j != i)
+          gradient[i] *= ((c >> j) & 1) ? x[j] : 1 - x[j];
+    }
+    return gradient;
+  }
+
+  // Compute J^T J from the transposed Jacobian
+  static SquareMatrix gram(const JacobianTransposed& jT)
+  {
+    SquareMatrix g;
+    for (int i = 0; i < mydim; ++i)
+      for (int j = 0; j < mydim; ++j)
+      {
+        g[i][j] = LaneCoordinate(ct(0));
+        for (int k = 0; k < cdim; ++k)
+          g[i][j] += jT[i][k] * jT[j][k];
+      }
+    return g;
+  }
+
+  static LaneCoordinate determinant(const SquareMatrix& a)
+  {
+    if constexpr (mydim == 1)
+      return a[0][0];
+    else if constexpr (mydim == 2)
+      return a[0][0]*a[1][1] - a[0][1]*a[1][0];
+    else
+      return a[0][0]*(a[1][1]*a[2][2] - a[1][2]*a[2][1])
+        - a[0][1]*(a[1][0]*a[2][2] - a[1][2]*a[2][0])
+        + a[0][2]*(a[1][0]*a[2][1] - a[1][1]*a[2][0]);
+  }
+
+  // Invert a matrix by its adjugate. This avoids pivoting,
+  // such that all lanes are processed by the same instructions.
+  static SquareMatrix inverse(const SquareMatrix& a, LaneCoordinate& det)
+  {
+    det = determinant(a);
+    const LaneCoordinate detInverse = LaneCoordinate(ct(1)) / det;
+    SquareMatrix b;
+    if constexpr (mydim == 1)
+      b[0][0] = detInverse;
+    else if constexpr (mydim == 2)
+    {
+      b[0][0] = a[1][1]*detInverse;
+      b[0][1] = -a[0][1]*detInverse;
+      b[1][0] = -a[1][0]*detInverse;
+      b[1][1] = a[0][0]*detInverse;
+    }
+    else
+    {
+      for (int i = 0; i < 3; ++i)
+        for (int j = 0; j < 3; ++j)
+        {
+          const int j1 = (j+1)%3, j2 = (j+2)%3;
+          const int i1 = (i+1)%3, i2 = (i+2)%3;
+          b[i][j] = (a[j1][i1]*a[j2][i2] - a[j1][i2]*a[j2][i1])*detInverse;
+        }
+    }
+    return b;
+  }
+
+  GeometryType type_;
+  std::vector<std::array<LaneCoordinate, cdim>> corners_;
+  size_type boundLanes_;
+};
+
+
+
+} // namespace Functions
+} // namespace Dune
+
+#endif // DUNE_FUNCTIONS_GRIDFUNCTIONS_SIMDGEOMETRY_HH
@@ -0,0 +1,356 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#ifndef DUNE_FUNCTIONS_GRIDFUNCTIONS_SIMDLOCALFUNCTION_HH
+#define DUNE_FUNCTIONS_GRIDFUNCTIONS_SIMDLOCALFUNCTION_HH
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include <dune/common/typetraits.hh>
+#include <dune/common/simd/loop.hh>
+#include <dune/common/simd/simd.hh>
+
+#include <dune/typetree/traversal.hh>
+#include <dune/typetree/treecontainer.hh>
+
+#include <dune/functions/common/signature.hh>
+#include <dune/functions/functionspacebases/flatvectorview.hh>
+#include <dune/functions/functionspacebases/simdlocalview.hh>
+#include <dune/functions/backends/istlvectorbackend.hh>
+#include <dune/functions/gridfunctions/simdgeometry.hh>
+
+namespace Dune {
+namespace Functions {
+
+
+
+/**
+ * \brief Local-function of a `DiscreteGlobalBasisFunction` evaluated on several elements in lockstep
+ *
+ * \ingroup FunctionImplementations
+ *
+ * This binds up to `W` elements of the same geometry type using a
+ * `SimdLocalView` and evaluates the discrete function on all of them
+ * at the same local coordinate. The local coefficients of all elements
+ * are stored in SIMD types of type `Dune::LoopSIMD` with `W` lanes.
+ * Since the shape function values are shared by all lanes, the linear
+ * combinations are computed once for all elements with SIMD arithmetic.
+ * The geometries of the elements are stored in a `SimdGeometry`, such that
+ * the derivatives with respect to global coordinates are computed for all
+ * lanes at once as well.
+ *
+ * Binding is not vectorized: Each lane is bound by its own local view,
+ * and the coefficients of each lane are gathered separately.
+ *
+ * Lanes which are not bound to an element are masked explicitly: Their
+ * coefficients are zero and their geometry is the reference element.
+ *
+ * The same restrictions as for `SimdLocalView` apply: The local finite
+ * elements of the basis must only depend on the geometry type of the element.
+ *
+ * \tparam F Type of the `DiscreteGlobalBasisFunction`
+ * \tparam W Number of lanes, i.e., maximal number of bound elements
+ */
+template<class F, std::size_t W>
+class SimdLocalFunction
+{
+  using Basis = typename F::Basis;
+  using Vector = typename F::Vector;
+  using LocalView = SimdLocalView<Basis, W>;
+  using Tree = typename LocalView::Tree;
+  using size_type = std::size_t;
+
+  using Coefficient = Dune::AutonomousValue<decltype(std::declval<const Vector&>()[std::declval<typename Basis::MultiIndex>()])>;
+  static constexpr std::size_t coeffDim = decltype(flatVectorView(std::declval<const Coefficient&>()).size())::value;
+  using CoefficientField = std::decay_t<decltype(flatVectorView(std::declval<const Coefficient&>())[0])>;
+
+  template<class Node>
+  using LocalBasisRange = typename Node::FiniteElement::Traits::LocalBasisType::Traits::RangeType;
+  template<class Node>
+  using NodeData = typename std::vector<LocalBasisRange<Node>>;
+  using PerNodeEvaluationBuffer = typename TypeTree::TreeContainer<NodeData, Tree>;
+
+  template<class Node>
+  using LocalBasisJacobian = typename Node::FiniteElement::Traits::LocalBasisType::Traits::JacobianType;
+  template<class Node>
+  using NodeJacobianData = typename std::vector<LocalBasisJacobian<Node>>;
+  using PerNodeJacobianBuffer = typename TypeTree::TreeContainer<NodeJacobianData, Tree>;
+
+  using ElementGeometry = typename LocalView::Element::Geometry;
+
+public:
+
+  using Element = typename LocalView::Element;
+  using Domain = typename F::EntitySet::LocalCoordinate;
+  using Range = typename F::Range;
+
+  //! Scalar type of the local coefficients stored for each lane
+  using LaneField = std::decay_t<decltype(std::declval<CoefficientField>() * std::declval<typename Domain::field_type>())>;
+
+  //! SIMD type storing one scalar local coefficient for all lanes
+  using LaneCoefficient = Dune::LoopSIMD<LaneField, W>;
+
+  //! Result of an evaluation, i.e. one value per lane
+  using LaneRange = std::array<Range, W>;
+
+  //! Range of the derivative with respect to global coordinates
+  using DerivativeRange = typename SignatureTraits<typename F::Traits::DerivativeInterface>::Range;
+
+  //! Result of the evaluation of the derivative, i.e. one value per lane
+  using LaneDerivativeRange = std::array<DerivativeRange, W>;
+
+  //! Geometries of all lanes
+  using Geometry = SimdGeometry<typename ElementGeometry::ctype, ElementGeometry::mydimension, ElementGeometry::coorddimension, W>;
+
+  //! Create a SIMD local-function from the associated grid-function
+  SimdLocalFunction(const F& f) :
+    f_(f),
+    localView_(f_.basis()),
+    evaluationBuffer_(localView_.tree()),
+    jacobianBuffer_(localView_.tree())
+  {
+    laneDoFs_.reserve(localView_.maxSize()*coeffDim);
+  }
+
+  //! Copy-construct the SIMD local-function
+  SimdLocalFunction(const SimdLocalFunction& other) :
+    f_(other.f_),
+    localView_(other.localView_),
+    geometry_(other.geometry_),
+    evaluationBuffer_(localView_.tree()),
+    jacobianBuffer_(localView_.tree()),
+    laneDoFs_(other.laneDoFs_)
+  {}
+
+  /**
+   * \brief Bind to a set of grid elements.
+   *
+   * \param elements A random access range of at most `W` elements of the same geometry type
+   *
+   * You must call this method before `operator()`
+   * and after changes to the coefficient vector.
+   * The coefficients of lanes that are not bound to
+   * an element are set to zero.
+   */
+  template<class Elements>
+  void bind(const Elements& elements)
+  {
+    localView_.bind(elements);
+    geometry_.bind(elements);
+
+    const auto& dofs = f_.dofs();
+    const auto& tree = localView_.tree();
+    laneDoFs_.assign(localView_.size()*coeffDim, LaneCoefficient(LaneField(0)));
+    for (size_type lane = 0; lane < localView_.boundLanes(); ++lane)
+    {
+      for (size_type i = 0; i < tree.size(); ++i)
+      {
+        auto localIndex = tree.localIndex(i);
+        const Coefficient coefficient = dofs[localView_.index(lane, localIndex)];
+        auto c = flatVectorView(coefficient);
+        for (std::size_t j = 0; j < coeffDim; ++j)
+          Simd::lane(lane, laneDoFs_[localIndex*coeffDim + j]) = c[j];
+      }
+    }
+  }
+
+  //! Unbind the local-function.
+  void unbind()
+  {
+    localView_.unbind();
+  }
+
+  //! Check if the local-function is bound to elements.
+  bool bound() const
+  {
+    return localView_.bound();
+  }
+
+  //! Return the number of lanes bound to an element.
+  size_type boundLanes() const
+  {
+    return localView_.boundLanes();
+  }
+
+  //! Return the element the given lane is bound to.
+  const Element& localContext(size_type lane) const
+  {
+    return localView_.element(lane);
+  }
+
+  //! Return the geometries of the bound elements
+  const Geometry& geometry() const
+  {
+    return geometry_;
+  }
+
+  /**
+   * \brief Evaluate in local coordinates `x` in all bound elements.
+   *
+   * The i-th entry of the result is the value in the element bound to
+   * the i-th lane. Entries of lanes which are not bound to an element
+   * are zero.
+   */
+  LaneRange operator()(const Domain& x) const
+  {
+    LaneRange y;
+    for (auto& yLane : y)
+      istlVectorBackend(yLane) = 0;
+
+    TypeTree::forEachLeafNode(localView_.tree(), [&](auto&& node, auto&& treePath) {
+      const auto& localBasis = node.finiteElement().localBasis();
+      auto& shapeFunctionValues = evaluationBuffer_[treePath];
+
+      localBasis.evaluateFunction(x, shapeFunctionValues);
+
+      // Compute linear combinations of basis function values for all lanes at once.
+      using Value = LocalBasisRange< std::decay_t<decltype(node)> >;
+      constexpr std::size_t valueDim = decltype(flatVectorView(std::declval<const Value&>()).size())::value;
+      auto laneValues = std::array<std::array<LaneCoefficient, valueDim>, coeffDim>{};
+      for (auto& laneValue : laneValues)
+        laneValue.fill(LaneCoefficient(LaneField(0)));
+      for (size_type i = 0; i < node.size(); ++i)
+      {
+        auto shapeValue = flatVectorView(shapeFunctionValues[i]);
+        for (std::size_t j = 0; j < coeffDim; ++j)
+        {
+          const auto& c = laneDoFs_[node.localIndex(i)*coeffDim + j];
+          for (std::size_t r = 0; r < valueDim; ++r)
+            laneValues[j][r] += c * LaneField(shapeValue[r]);
+        }
+      }
+
+      // Extract the values of each lane and assign them to node entry of range.
+      // Types are matched using the lexicographic ordering provided by flatVectorView.
+      for (size_type lane = 0; lane < localView_.boundLanes(); ++lane)
+      {
+        auto values = std::array<Value, coeffDim>{};
+        auto values_flat = flatVectorView(values);
+        for (std::size_t j = 0; j < coeffDim; ++j)
+          for (std::size_t r = 0; r < valueDim; ++r)
+            values_flat[j*valueDim + r] = Simd::lane(lane, laneValues[j][r]);
+
+        auto&& entry = f_.nodeToRangeEntry()(node, treePath, y[lane]);
+        auto entry_flat = flatVectorView(entry);
+        assert(entry_flat.size() == values_flat.size());
+        for (size_type k = 0; k < entry_flat.size(); ++k)
+          entry_flat[k] = values_flat[k];
+      }
+    });
+
+    return y;
+  }
+
+  /**
+   * \brief Evaluate the derivative with respect to global coordinates in local coordinates `x` in all bound elements.
+   *
+   * The Jacobians of the shape functions are shared by all lanes. The linear
+   * combinations and the transformation by the inverse Jacobians of the
+   * geometries are computed for all lanes at once. Entries of lanes which
+   * are not bound to an element are zero.
+   */
+  LaneDerivativeRange derivative(const Domain& x) const
+  {
+    LaneDerivativeRange y;
+    for (auto& yLane : y)
+      istlVectorBackend(yLane) = 0;
+
+    // Convert the inverse Jacobians of the geometries to the field of the coefficients
+    constexpr int mydim = ElementGeometry::mydimension;
+    constexpr int cdim = ElementGeometry::coorddimension;
+    const auto geometryJacobianInverse = geometry_.jacobianInverse(x);
+    auto jacobianInverse = std::array<std::array<LaneCoefficient, cdim>, mydim>{};
+    for (int i = 0; i < mydim; ++i)
+      for (int k = 0; k < cdim; ++k)
+        for (size_type lane = 0; lane < W; ++lane)
+          Simd::lane(lane, jacobianInverse[i][k]) = Simd::lane(lane, geometryJacobianInverse[i][k]);
+
+    TypeTree::forEachLeafNode(localView_.tree(), [&](auto&& node, auto&& treePath) {
+      const auto& localBasis = node.finiteElement().localBasis();
+      auto& shapeFunctionJacobians = jacobianBuffer_[treePath];
+
+      localBasis.evaluateJacobian(x, shapeFunctionJacobians);
+
+      // Compute linear combinations of the basis function Jacobians for all lanes at once.
+      using RefJacobian = LocalBasisJacobian< std::decay_t<decltype(node)> >;
+      constexpr int rows = RefJacobian::rows;
+      auto laneRefJacobians = std::array<std::array<std::array<LaneCoefficient, mydim>, rows>, coeffDim>{};
+      for (auto& laneRefJacobian : laneRefJacobians)
+        for (auto& row : laneRefJacobian)
+          row.fill(LaneCoefficient(LaneField(0)));
+      for (size_type i = 0; i < node.size(); ++i)
+      {
+        const auto& shapeJacobian = shapeFunctionJacobians[i];
+        for (std::size_t j = 0; j < coeffDim; ++j)
+        {
+          const auto& c = laneDoFs_[node.localIndex(i)*coeffDim + j];
+          for (int r = 0; r < rows; ++r)
+            for (int d = 0; d < mydim; ++d)
+              laneRefJacobians[j][r][d] += c * LaneField(shapeJacobian[r][d]);
+        }
+      }
+
+      // Transform the Jacobians from local to global coordinates for all lanes at once.
+      auto laneJacobians = std::array<std::array<std::array<LaneCoefficient, cdim>, rows>, coeffDim>{};
+      for (std::size_t j = 0; j < coeffDim; ++j)
+        for (int r = 0; r < rows; ++r)
+          for (int k = 0; k < cdim; ++k)
+          {
+            laneJacobians[j][r][k] = LaneCoefficient(LaneField(0));
+            for (int d = 0; d < mydim; ++d)
+              laneJacobians[j][r][k] += laneRefJacobians[j][r][d] * jacobianInverse[d][k];
+          }
+
+      // Extract the Jacobians of each lane and assign them to node entry of range.
+      // Types are matched using the lexicographic ordering provided by flatVectorView.
+      for (size_type lane = 0; lane < localView_.boundLanes(); ++lane)
+      {
+        auto&& entry = f_.nodeToRangeEntry()(node, treePath, y[lane]);
+        auto entry_flat = flatVectorView(entry);
+        assert(entry_flat.size() == coeffDim*rows*cdim);
+        for (std::size_t j = 0; j < coeffDim; ++j)
+          for (int r = 0; r < rows; ++r)
+            for (int k = 0; k < cdim; ++k)
+              entry_flat[(j*rows + r)*cdim + k] = Simd::lane(lane, laneJacobians[j][r][k]);
+      }
+    });
+
+    return y;
+  }
+
+private:
+  F f_;
+  LocalView localView_;
+  Geometry geometry_;
+  mutable PerNodeEvaluationBuffer evaluationBuffer_;
+  mutable PerNodeJacobianBuffer jacobianBuffer_;
+  std::vector<LaneCoefficient> laneDoFs_;
+};
+
+
+
+/**
+ * \brief Create a local-function evaluating a `DiscreteGlobalBasisFunction` on `W` elements in lockstep
+ *
+ * \ingroup FunctionImplementations
+ *
+ * \tparam W Number of lanes, i.e., maximal number of bound elements
+ * \param f A `DiscreteGlobalBasisFunction`
+ *
+ * \relatesalso SimdLocalFunction
+ */
+template<std::size_t W, class F>
+auto simdLocalFunction(const F& f)
+{
+  return SimdLocalFunction<F, W>(f);
+}
+
+
+
+} // namespace Functions
+} // namespace Dune
+
+#endif // DUNE_FUNCTIONS_GRIDFUNCTIONS_SIMDLOCALFUNCTION_HH
@@ -2,7 +2,9 @@
 // vi: set et ts=4 sw=2 sts=2:
 #include <config.h>
 
+#include <cmath>
 #include <iostream>
+#include <vector>
 
 #include <dune/common/exceptions.hh>
 #include <dune/common/parallel/mpihelper.hh>
@@ -18,6 +20,7 @@
 #include <dune/functions/functionspacebases/subspacebasis.hh>
 #include <dune/functions/gridfunctions/discreteglobalbasisfunction.hh>
 #include <dune/functions/gridfunctions/composedgridfunction.hh>
+#include <dune/functions/common/localfunction.hh>
 
 #include <dune/functions/gridfunctions/test/gridfunctiontest.hh>
 
@@ -108,6 +111,41 @@ int main (int argc, char* argv[]) try
           checkGridViewFunction(gridView, gf_gridfunction, integral, 4),
           "Check if ComposedGridFunction has correct integral (capture by value)");
     }
+
+    {
+      // Both inner functions share the same basis object, such that their
+      // local-functions are fused. Compare with the separate evaluation.
+      auto gf_gridfunction = makeComposedGridFunction(g, f0_gridfunction, f0_gridfunction);
+      auto localGf = localFunction(gf_gridfunction);
+      auto localF0 = localFunction(f0_gridfunction);
+      auto points = std::vector<FieldVector<double,dim>>{{0.5, 0.5}, {0.2, 0.7}, {0.2, 0.7}, {0.0, 1.0}};
+      std::vector<double> values;
+      for (const auto& element : Dune::elements(gridView))
+      {
+        localGf.bind(element);
+        localF0.bind(element);
+        auto localGfCopy = localGf;
+        localGf.evaluate(points, values);
+        for (std::size_t k = 0; k < points.size(); ++k)
+        {
+          auto expected = g(localF0(points[k]), localF0(points[k]));
+          suite.check(std::abs(localGf(points[k]) - expected) < 1e-12)
+            << "Fused ComposedGridFunction evaluates to wrong value";
+          suite.check(std::abs(localGfCopy(points[k]) - expected) < 1e-12)
+            << "Copy of fused ComposedGridFunction evaluates to wrong value";
+          suite.check(std::abs(values[k] - expected) < 1e-12)
+            << "Batched evaluation of ComposedGridFunction returns wrong value";
+        }
+
+        // Batched evaluation through the type-erased interface
+        using Element = typename decltype(gridView)::template Codim<0>::Entity;
+        auto erasedLocalGf = Dune::Functions::LocalFunction<double(FieldVector<double,dim>), Element>(localGf);
+        std::vector<double> erasedValues;
+        erasedLocalGf.evaluate(points, erasedValues);
+        suite.check(erasedValues == values)
+          << "Batched evaluation of type-erased LocalFunction returns wrong values";
+      }
+    }
   }
 
 
@@ -2,12 +2,16 @@
 // vi: set et ts=4 sw=2 sts=2:
 #include <config.h>
 
+#include <cmath>
 #include <iostream>
 #include <tuple>
+#include <vector>
 
 #include <dune/common/exceptions.hh>
 #include <dune/common/parallel/mpihelper.hh>
 #include <dune/common/hybridutilities.hh>
+#include <dune/common/indices.hh>
+#include <dune/common/tuplevector.hh>
 
 #include <dune/grid/yaspgrid.hh>
 
@@ -72,6 +76,43 @@ bool checkInterpolationConsistency(B&& basis, C&& x)
   return passed;
 }
 
+template<class R, class B, class C>
+bool checkCoefficientAccessCache(B&& basis, C&& x)
+{
+  bool passed = true;
+
+  auto f = Dune::Functions::makeDiscreteGlobalBasisFunction<R>(basis, x);
+  auto fCached = Dune::Functions::makeDiscreteGlobalBasisFunction<R>(basis, x);
+  fCached.cacheCoefficientAccess();
+
+  auto localF = localFunction(f);
+  auto localFCached = localFunction(fCached);
+  auto localDF = localFunction(derivative(f));
+  auto localDFCached = localFunction(derivative(fCached));
+  for (const auto& element : elements(basis.gridView()))
+  {
+    localF.bind(element);
+    localFCached.bind(element);
+    localDF.bind(element);
+    localDFCached.bind(element);
+    auto center = referenceElement(element).position(0,0);
+    if (infinityDiff(localF(center), localFCached(center)) > 1e-14)
+    {
+      std::cout << "Evaluation with cached coefficient access differs from uncached evaluation" << std::endl;
+      passed = false;
+    }
+    auto dfDiff = localDF(center);
+    dfDiff -= localDFCached(center);
+    if (dfDiff.infinity_norm() > 1e-14)
+    {
+      std::cout << "Derivative with cached coefficient access differs from uncached derivative" << std::endl;
+      passed = false;
+    }
+  }
+
+  return passed;
+}
+
 
 int main (int argc, char* argv[]) try
 {
@@ -118,6 +159,10 @@ int main (int argc, char* argv[]) try
     auto passedThisTest = checkInterpolationConsistency<Range>(feBasis, x);
     std::cout << "checkInterpolationConsistency for power Lagrange basis" << (passedThisTest? " " : " NOT  ") << "successful." << std::endl;
     passed = passed and passedThisTest;
+
+    passedThisTest = checkCoefficientAccessCache<Range>(feBasis, x);
+    std::cout << "checkCoefficientAccessCache for power Lagrange basis" << (passedThisTest? " " : " NOT  ") << "successful." << std::endl;
+    passed = passed and passedThisTest;
   }
 
   // Taylor-Hood basis
@@ -163,6 +208,66 @@ int main (int argc, char* argv[]) try
     }
   }
 
+  // Taylor-Hood basis with blocked interleaved velocity
+  {
+    auto taylorHoodBasis = makeBasis(
+        gridView,
+        composite(
+          power<dim>(
+            lagrange<2>(),
+            blockedInterleaved()),
+          lagrange<1>(),
+          blockedLexicographic()
+          ));
+    using VelocityVector = std::vector<FieldVector<double,dim>>;
+    using PressureVector = std::vector<double>;
+    using Vector = Dune::TupleVector<VelocityVector, PressureVector>;
+    using namespace Dune::Indices;
+
+    Vector x;
+    {
+      auto feBasis = Dune::Functions::subspaceBasis(taylorHoodBasis, _0);
+      using Range = FieldVector<double,dim>;
+      auto f = [](const auto& x){
+        return Range{ x[1]*x[1], x[0]*x[1] };
+      };
+      interpolate(feBasis, x, f);
+      auto passedThisTest = checkCoefficientAccessCache<Range>(feBasis, x);
+      std::cout << "checkCoefficientAccessCache for velocity part of blocked Taylor-Hood basis" << (passedThisTest? " " : " NOT  ") << "successful." << std::endl;
+      passed = passed and passedThisTest;
+    }
+    {
+      auto feBasis = Dune::Functions::subspaceBasis(taylorHoodBasis, _1);
+      using Range = double;
+      auto f = [](const auto& x){
+        return Range{ x[0] };
+      };
+      interpolate(feBasis, x, f);
+      auto passedThisTest = checkCoefficientAccessCache<Range>(feBasis, x);
+      std::cout << "checkCoefficientAccessCache for pressure part of blocked Taylor-Hood basis" << (passedThisTest? " " : " NOT  ") << "successful." << std::endl;
+      passed = passed and passedThisTest;
+    }
+    {
+      // The pressure vector is reallocated while the velocity vector keeps
+      // its storage. The cache must detect this and fall back to the backend.
+      using Range = Dune::TupleVector<FieldVector<double,dim>, double>;
+      auto f = Dune::Functions::makeDiscreteGlobalBasisFunction<Range>(taylorHoodBasis, x);
+      f.cacheCoefficientAccess();
+      x[_1] = PressureVector(x[_1].size(), 2.0);
+      auto localF = localFunction(f);
+      bool passedThisTest = true;
+      for (const auto& element : elements(gridView))
+      {
+        localF.bind(element);
+        auto center = referenceElement(element).position(0,0);
+        if (std::fabs(localF(center)[_1] - 2.0) > 1e-14)
+          passedThisTest = false;
+      }
+      std::cout << "checkCoefficientAccessCache after reallocation for blocked Taylor-Hood basis" << (passedThisTest? " " : " NOT  ") << "successful." << std::endl;
+      passed = passed and passedThisTest;
+    }
+  }
+
   // Raviart-Thomas basis
   {
     auto feBasis = makeBasis(gridView, raviartThomas<0>());
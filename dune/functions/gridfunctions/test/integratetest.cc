@@ -0,0 +1,115 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/exceptions.hh>
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/grid/yaspgrid.hh>
+
+#include <dune/functions/common/differentiablefunctionfromcallables.hh>
+#include <dune/functions/functionspacebases/interpolate.hh>
+#include <dune/functions/functionspacebases/lagrangebasis.hh>
+#include <dune/functions/gridfunctions/analyticgridviewfunction.hh>
+#include <dune/functions/gridfunctions/composedgridfunction.hh>
+#include <dune/functions/gridfunctions/discreteglobalbasisfunction.hh>
+#include <dune/functions/gridfunctions/integrate.hh>
+
+using namespace Dune;
+using namespace Dune::Functions;
+
+int main (int argc, char* argv[]) try
+{
+  Dune::MPIHelper::instance(argc, argv);
+
+  TestSuite suite;
+
+  // Generate grid for testing
+  const int dim = 2;
+  using Grid = Dune::YaspGrid<dim>;
+  FieldVector<double,dim> l(1);
+  std::array<int,dim> elements = {{8, 8}};
+  Grid grid(l, elements);
+  auto gridView = grid.leafGridView();
+
+  using Domain = FieldVector<double,dim>;
+
+  {
+    auto f = makeAnalyticGridViewFunction([](const auto& x) { return x[0]*x[1]; }, gridView);
+    suite.check(std::abs(integrate(f, 2) - 0.25) < 1e-12)
+      << "Integral of scalar AnalyticGridViewFunction is wrong";
+  }
+
+  {
+    auto f = makeAnalyticGridViewFunction([](const auto& x) { return FieldVector<double,2>{x[0], 1}; }, gridView);
+    auto integral = integrate(f, 1);
+    suite.check(std::abs(integral[0] - 0.5) < 1e-12 and std::abs(integral[1] - 1.0) < 1e-12)
+      << "Integral of vector valued AnalyticGridViewFunction is wrong";
+  }
+
+  using namespace Functions::BasisFactory;
+
+  // A quadratic function and its derivative
+  auto f = [](const auto& x) { return x[0]*x[0] + x[1]; };
+  auto df = [](const auto& x) { return Domain{2*x[0], 1}; };
+  auto exactF = makeAnalyticGridViewFunction(makeDifferentiableFunctionFromCallables(SignatureTag<double(Domain)>(), f, df), gridView);
+
+  // Interpolating with second order Lagrange elements is exact
+  auto basis = makeBasis(gridView, lagrange<2>());
+  std::vector<double> c;
+  interpolate(basis, c, f);
+  auto discreteF = makeDiscreteGlobalBasisFunction<double>(basis, c);
+
+  {
+    suite.check(std::abs(integrate(discreteF, 2) - (1.0/3.0 + 0.5)) < 1e-12)
+      << "Integral of DiscreteGlobalBasisFunction is wrong";
+
+    for (auto normType : {NormType::L2, NormType::H1Semi, NormType::H1})
+      suite.check(errorNorm(discreteF, exactF, normType, 4) < 1e-10)
+        << "Error of exact interpolation does not vanish";
+  }
+
+  {
+    // The interpolation with first order elements is not exact
+    auto p1Basis = makeBasis(gridView, lagrange<1>());
+    std::vector<double> p1c;
+    interpolate(p1Basis, p1c, f);
+    auto p1F = makeDiscreteGlobalBasisFunction<double>(p1Basis, p1c);
+
+    auto l2Error = errorNorm(p1F, exactF, NormType::L2, 4);
+    auto h1SemiError = errorNorm(p1F, exactF, NormType::H1Semi, 4);
+    auto h1Error = errorNorm(p1F, exactF, NormType::H1, 4);
+    suite.check(l2Error > 0 and h1SemiError > 0)
+      << "Error of inexact interpolation vanishes";
+    suite.check(std::abs(h1Error*h1Error - l2Error*l2Error - h1SemiError*h1SemiError) < 1e-12)
+      << "H1 error does not match L2 error and H1 seminorm error";
+
+    // Results must not depend on the number of threads
+    suite.check(errorNorm(p1F, exactF, NormType::H1, 4, 3) == h1Error)
+      << "Error norm depends on the number of threads";
+    suite.check(integrate(p1F, 2, 4) == integrate(p1F, 2))
+      << "Integral depends on the number of threads";
+  }
+
+  {
+    auto g = makeComposedGridFunction([](auto y) { return 2*y; }, discreteF);
+    suite.check(std::abs(integrate(g, 2) - 2*(1.0/3.0 + 0.5)) < 1e-12)
+      << "Integral of ComposedGridFunction is wrong";
+    suite.check(errorNorm(g, discreteF, NormType::L2, 4, 2) > 0)
+      << "Error of different ComposedGridFunction vanishes";
+  }
+
+  return suite.exit();
+}
+catch (Exception &e)
+{
+  std::cerr << "Exception: " << e << std::endl;
+  return 1;
+}
@@ -0,0 +1,147 @@
+// -*- tab-width: 4; indent-tabs-mode: nil; c-basic-offset: 2 -*-
+// vi: set et ts=4 sw=2 sts=2:
+#include <config.h>
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <vector>
+
+#include <dune/common/fvector.hh>
+#include <dune/common/parallel/mpihelper.hh>
+#include <dune/common/test/testsuite.hh>
+
+#include <dune/grid/yaspgrid.hh>
+#include <dune/grid/uggrid.hh>
+#include <dune/grid/utility/structuredgridfactory.hh>
+
+#include <dune/functions/functionspacebases/flatvectorview.hh>
+#include <dune/functions/functionspacebases/interpolate.hh>
+#include <dune/functions/functionspacebases/lagrangebasis.hh>
+#include <dune/functions/functionspacebases/powerbasis.hh>
+#include <dune/functions/gridfunctions/discreteglobalbasisfunction.hh>
+#include <dune/functions/gridfunctions/simdlocalfunction.hh>
+
+using namespace Dune;
+using namespace Dune::Functions;
+
+template<std::size_t W, class F>
+TestSuite checkSimdLocalFunction(const F& f)
+{
+  TestSuite suite;
+
+  const auto& gridView = f.basis().gridView();
+  auto localF = localFunction(f);
+  auto localDF = localFunction(derivative(f));
+  auto simdLocalF = simdLocalFunction<W>(f);
+
+  auto x = typename F::EntitySet::LocalCoordinate(0.3);
+
+  // Bind all elements in batches of W elements. The last batch
+  // may contain less than W elements.
+  std::vector<typename F::EntitySet::Element> batch;
+  auto checkBatch = [&]() {
+    simdLocalF.bind(batch);
+    suite.check(simdLocalF.boundLanes() == batch.size(), "Check number of bound lanes");
+    auto laneValues = simdLocalF(x);
+    auto laneDerivatives = simdLocalF.derivative(x);
+    auto laneGlobal = simdLocalF.geometry().global(x);
+    for (std::size_t lane = 0; lane < batch.size(); ++lane)
+    {
+      localF.bind(batch[lane]);
+      auto diff = localF(x);
+      diff -= laneValues[lane];
+      suite.check(diff.infinity_norm() < 1e-12, "Check SimdLocalFunction against LocalFunction");
+
+      localDF.bind(batch[lane]);
+      auto derivative = localDF(x);
+      auto derivative_flat = flatVectorView(derivative);
+      auto laneDerivative_flat = flatVectorView(laneDerivatives[lane]);
+      for (std::size_t k = 0; k < derivative_flat.size(); ++k)
+        suite.check(std::abs(derivative_flat[k] - laneDerivative_flat[k]) < 1e-10, "Check derivative of SimdLocalFunction against derivative of LocalFunction");
+
+      auto global = batch[lane].geometry().global(x);
+      for (std::size_t k = 0; k < global.size(); ++k)
+        suite.check(std::abs(global[k] - Simd::lane(lane, laneGlobal[k])) < 1e-12, "Check SimdGeometry against geometry of the element");
+    }
+    for (std::size_t lane = batch.size(); lane < W; ++lane)
+    {
+      suite.check(laneValues[lane].infinity_norm() == 0, "Check that unbound lanes are zero");
+      auto laneDerivative_flat = flatVectorView(laneDerivatives[lane]);
+      for (std::size_t k = 0; k < laneDerivative_flat.size(); ++k)
+        suite.check(laneDerivative_flat[k] == 0, "Check that derivatives of unbound lanes are zero");
+    }
+    batch.clear();
+  };
+  for (const auto& element : elements(gridView))
+  {
+    batch.push_back(element);
+    if (batch.size() == W)
+      checkBatch();
+  }
+  if (not batch.empty())
+    checkBatch();
+
+  return suite;
+}
+
+int main(int argc, char** argv)
+{
+  MPIHelper::instance(argc, argv);
+
+  TestSuite suite;
+
+  using Grid = YaspGrid<2>;
+  FieldVector<double,2> l(1);
+  std::array<int,2> elementCounts = {{5, 5}};
+  Grid grid(l, elementCounts);
+  auto gridView = grid.leafGridView();
+
+  using namespace Functions::BasisFactory;
+
+  {
+    auto basis = makeBasis(gridView, lagrange<1>());
+    std::vector<double> coefficients;
+    interpolate(basis, coefficients, [](const auto& x) { return x[0]*x[1]; });
+    auto f = makeDiscreteGlobalBasisFunction<FieldVector<double,1>>(basis, coefficients);
+    suite.subTest(checkSimdLocalFunction<4>(f));
+  }
+
+  {
+    using Range = FieldVector<double,2>;
+    auto basis = makeBasis(gridView, power<2>(lagrange<2>()));
+    std::vector<Range> coefficients;
+    interpolate(basis, coefficients, [](const auto& x) { return Range{x[0]*x[1], x[0]-x[1]}; });
+    auto f = makeDiscreteGlobalBasisFunction<Range>(basis, coefficients);
+    suite.subTest(checkSimdLocalFunction<8>(f));
+  }
+
+  {
+    using UGGrid2 = UGGrid<2>;
+    auto factory = GridFactory<UGGrid2>();
+    factory.insertVertex({0,0});
+    factory.insertVertex({0,1});
+    factory.insertVertex({1,0});
+    factory.insertVertex({2,2});
+    factory.insertElement(GeometryTypes::cube(2), {0,1,2,3});
+    auto ugGrid = factory.createGrid();
+    ugGrid->globalRefine(2);
+    auto basis = makeBasis(ugGrid->leafGridView(), lagrange<2>());
+    std::vector<double> coefficients;
+    interpolate(basis, coefficients, [](const auto& x) { return x[0]*x[1] + x[1]*x[1]; });
+    auto f = makeDiscreteGlobalBasisFunction<FieldVector<double,1>>(basis, coefficients);
+    suite.subTest(checkSimdLocalFunction<4>(f));
+  }
+
+  {
+    using UGGrid3 = UGGrid<3>;
+    auto ugGrid = StructuredGridFactory<UGGrid3>::createSimplexGrid({0,0,0}, {1,1,1}, {{2,2,2}});
+    auto basis = makeBasis(ugGrid->leafGridView(), lagrange<2>());
+    std::vector<double> coefficients;
+    interpolate(basis, coefficients, [](const auto& x) { return x[0]*x[2] - x[1]; });
+    auto f = makeDiscreteGlobalBasisFunction<FieldVector<double,1>>(basis, coefficients);
+    suite.subTest(checkSimdLocalFunction<4>(f));
+  }
+
+  return suite.exit();
+}